@@ -26,6 +26,36 @@
 #define BATTERY_PIN 4  // ADC for Battery Voltage
 #define USER_BUTTON_PIN 0 // Boot Button (P0.00)
 
+// --- Flash Layout (raw pages outside InternalFS) ---
+// nRF52840 + S140 v6: The application area ends at 0xED000 where InternalFS starts.
+// The top of the application area is used for raw flash stores.
+// The firmware image must stay below the lowest region address (checked at boot).
+//
+// DFU: The Adafruit bootloader only preserves the 7 pages from 0xED000 (DFU_APP_DATA_RESERVED).
+// It stages a new image in the upper half of the application area (bank 1 from 0x89000),
+// the raw stores below 0xED000 survive only while the image stays short of them:
+// above ~304 KB it erases the flight recorder, above ~368 KB also config, journal and log.
+// DFU_MAX_IMAGE_SIZE is checked after every build (scripts/check_dfu_size.py) and at boot.
+#define APP_FLASH_ADDR 0x26000    // Application start after S140 v6
+#define DFU_BANK1_ADDR 0x89000    // APP_FLASH_ADDR + half of the area up to 0xED000, 8 KB aligned
+#define KV_LOG_FLASH_ADDR 0xE9000 // Key/Value log (LogPersistence)
+#define KV_LOG_PAGES 4            // 4 x 4 KB, one page is always kept erased
+#define PROGRESS_JOURNAL_ADDR 0xE7000 // Odometer/progress journal (ProgressJournal)
+#define PROGRESS_JOURNAL_PAGES 2      // Used alternately
+#define CONFIG_FLASH_ADDR 0xE5000     // Settings record (ConfigStore), read in place
+#define CONFIG_FLASH_PAGES 2          // Ping-pong: the previous record stays valid during a save
+#define FLIGHT_RECORDER_ADDR 0xD5000  // Oiling flight recorder (FlightRecorder)
+#define FLIGHT_RECORDER_PAGES 16      // Ring of 24-byte records, last ~2550 oilings
+#define DFU_MAX_IMAGE_SIZE (FLIGHT_RECORDER_ADDR - DFU_BANK1_ADDR) // Lowest store: 304 KB
+#if FLIGHT_RECORDER_ADDR < DFU_BANK1_ADDR
+#error "Raw flash stores must lie above the DFU staging bank"
+#endif
+
+// --- Progress Saving ---
+// With the journal, a save appends a 16-byte delta; full checkpoints are rare.
+#define PROGRESS_JOURNAL_INTERVAL_MS 15000        // Delta record while riding (replaces SAVE_INTERVAL_MS)
+#define PROGRESS_CHECKPOINT_MS (60UL * 60 * 1000) // Full checkpoint at least every hour
+
 // --- Power Management ---
 #define COOLDOWN_TIME_MS (5 * 60 * 60 * 1000) // 5 Hours Listening Mode
 #define EXTENSION_TIME_MS (1 * 60 * 60 * 1000) // +1 Hour on interaction
@@ -46,6 +76,15 @@
 #define MAX_SPEED_KMH 250.0
 #define MIN_ODOMETER_SPEED_KMH 2.0
 
+// Speed range table (SpeedRanges.h): number of ranges, bounds and default intervals
+#define RANGE_PROFILE_ALPINE 0    // 5 ranges (10/45/75/105/135 km/h)
+#define RANGE_PROFILE_TOURING 1   // 6 ranges, finer steps at motorway speeds
+#define RANGE_PROFILE_ENDURO 2    // 3 ranges (trail, transfer, road)
+#define RANGE_PROFILE_CUSTOM 3    // RANGE_CUSTOM_COUNT/_BOUNDS/_INTERVALS
+#ifndef RANGE_PROFILE
+#define RANGE_PROFILE RANGE_PROFILE_ALPINE
+#endif
+
 // Pump Settings
 #define PUMP_USE_PWM true
 #define PUMP_PWM_FREQ 5000
@@ -61,6 +100,9 @@
 #define BLEEDING_PULSE_MS 60       // Pulse duration for bleeding
 #define BLEEDING_PAUSE_MS 320      // Pause duration for bleeding
 
+// Temperature Sensors (DS18B20 on the temp pin, externally powered)
+#define TEMP_RESOLUTION_BITS 12    // 9-12 bit = 0.5-0.0625°C, conversion 94-750 ms (not blocking)
+
 // LED Settings
 #define NUM_LEDS 1
 #define LED_BRIGHTNESS_DIM 64
@@ -1,9 +1,27 @@
 #include "AuxManager.h"
+#include "ParamRegistry.h"
 
 #define AUX_PWM_CHANNEL 1 // Use channel 1 (Pump uses 0)
 #define AUX_PWM_FREQ 1000 // 1 kHz for grips/relays
 #define AUX_PWM_RES 8     // 8-bit (0-255)
 
+// Aux settings: one line per value (legacy key, default, valid range)
+static constexpr ParamDesc auxParams[] = {
+    PARAM(PARAM_I32, AuxSettings, mode, "mode", AUX_MODE_OFF, AUX_MODE_OFF, AUX_MODE_HEATED_GRIPS),
+    PARAM(PARAM_I32, AuxSettings, baseLevel, "base", 25, 0, 100),
+    PARAM(PARAM_F32, AuxSettings, speedFactor, "speedF", 0.5, 0, PARAM_UNLIMITED),
+    PARAM(PARAM_F32, AuxSettings, tempFactor, "tempF", 2.0, 0, PARAM_UNLIMITED),
+    PARAM(PARAM_F32, AuxSettings, tempOffset, "tempO", 0.0, -PARAM_UNLIMITED, PARAM_UNLIMITED),
+    PARAM(PARAM_F32, AuxSettings, startTemp, "startT", 20.0, -PARAM_UNLIMITED, PARAM_UNLIMITED),
+    PARAM(PARAM_I32, AuxSettings, rainBoost, "rainB", 10, 0, 100),
+    PARAM(PARAM_I32, AuxSettings, startupBoostLevel, "startL", 100, 0, 100),
+    PARAM(PARAM_I32, AuxSettings, startupBoostSec, "startS", 75, 0, PARAM_UNLIMITED),
+    PARAM(PARAM_I32, AuxSettings, startDelaySec, "startD", 15, 0, PARAM_UNLIMITED),
+    PARAM(PARAM_I32, AuxSettings, reactionSpeed, "react", REACTION_SLOW, REACTION_SLOW, REACTION_FAST),
+    PARAM(PARAM_BOOL, AuxSettings, manualOverride, "man_ovr", true, 0, 1) // Persisted Auto state
+};
+static constexpr ParamTable auxParamTable = PARAM_TABLE("aux", auxParams);
+
 AuxManager::AuxManager(IPersistence* store) {
     _store = store;
 }
@@ -22,30 +40,78 @@ void AuxManager::begin(ImuHandler* imu) {
     ledcWrite(AUX_PIN, 0);
 #endif
     
-    // Load Preferences
-    _store->begin("aux", false);
-    _mode = (AuxMode)_store->getInt("mode", AUX_MODE_OFF);
-    
-    _baseLevel = _store->getInt("base", 25);
-    _speedFactor = _store->getFloat("speedF", 0.5);
-    _tempFactor = _store->getFloat("tempF", 2.0);
-    _tempOffset = _store->getFloat("tempO", 0.0);
-    _startTemp = _store->getFloat("startT", 20.0);
-    _rainBoost = _store->getInt("rainB", 10);
-    _startupBoostLevel = _store->getInt("startL", 100);
-    _startupBoostSec = _store->getInt("startS", 75);
-    _startDelaySec = _store->getInt("startD", 15);
-    _reactionSpeed = (ReactionSpeed)_store->getInt("react", REACTION_SLOW);
-    
-    // Load saved state for manual override (persistence)
-    _manualOverride = _store->getBool("man_ovr", true);
+    // Load Settings (config record; per-key settings of older firmware are migrated once)
+    configStore.load(_store);
+    AuxSettings settings = configStore.aux();
+    bool migrate = !configStore.has(CONFIG_SECTION_AUX);
+    if (migrate) {
+        paramDefaults(auxParamTable, &settings);
+        paramLoadLegacy(auxParamTable, _store, &settings);
+    }
+    paramValidate(auxParamTable, &settings);
+    applySettings(settings);
+    if (migrate && saveSettings()) {
+        // Old keys only go once the record holds the settings
+        _store->begin("aux", false);
+        _store->clear();
+        _store->end();
+    }
     
     // If enabled at boot, calculate boost end time
     if (_manualOverride) {
         calcBoostEndTime();
     }
+}
+
+void AuxManager::applySettings(const AuxSettings& s) {
+    _mode = (AuxMode)s.mode;
+    _baseLevel = s.baseLevel;
+    _speedFactor = s.speedFactor;
+    _tempFactor = s.tempFactor;
+    _tempOffset = s.tempOffset;
+    _startTemp = s.startTemp;
+    _rainBoost = s.rainBoost;
+    _startupBoostLevel = s.startupBoostLevel;
+    _startupBoostSec = s.startupBoostSec;
+    _startDelaySec = s.startDelaySec;
+    _reactionSpeed = (ReactionSpeed)s.reactionSpeed;
+    _manualOverride = s.manualOverride;
+}
+
+void AuxManager::exportSettings(AuxSettings& s) const {
+    s.mode = (int32_t)_mode;
+    s.baseLevel = _baseLevel;
+    s.speedFactor = _speedFactor;
+    s.tempFactor = _tempFactor;
+    s.tempOffset = _tempOffset;
+    s.startTemp = _startTemp;
+    s.rainBoost = _rainBoost;
+    s.startupBoostLevel = _startupBoostLevel;
+    s.startupBoostSec = _startupBoostSec;
+    s.startDelaySec = _startDelaySec;
+    s.reactionSpeed = (int32_t)_reactionSpeed;
+    s.manualOverride = _manualOverride;
+}
+
+bool AuxManager::saveSettings() {
+    AuxSettings s = configStore.aux();
+    exportSettings(s);
+    return configStore.save(_store, s);
+}
+
+bool AuxManager::getParam(const char* key, float& value) const {
+    AuxSettings s = configStore.aux();
+    exportSettings(s);
+    return paramGet(auxParamTable, &s, key, value);
+}
 
-    _store->end();
+bool AuxManager::setParam(const char* key, float value) {
+    AuxSettings s = configStore.aux();
+    exportSettings(s);
+    if (!paramSet(auxParamTable, &s, key, value)) return false;
+    applySettings(s);
+    saveSettings();
+    return true;
 }
 
 void AuxManager::loop(float currentSpeedKmh, float currentTempC, bool isRainMode) {
@@ -69,9 +135,7 @@ void AuxManager::toggleManualOverride() {
         calcBoostEndTime();
     }
 
-    _store->begin("aux", false);
-    _store->putBool("man_ovr", _manualOverride);
-    _store->end();
+    saveSettings();
 }
 
 void AuxManager::handleAuxPower() {
@@ -159,9 +223,7 @@ void AuxManager::setPwm(int percent) {
 
 void AuxManager::setMode(AuxMode mode) {
     _mode = mode;
-    _store->begin("aux", false);
-    _store->putInt("mode", (int)_mode);
-    _store->end();
+    saveSettings();
 }
 
 void AuxManager::setGripSettings(int baseLevel, float speedFactor, float tempFactor, float tempOffset, float startTemp, int rainBoost, int startupBoostLevel, int startupBoostSec, int startDelaySec, int reactionSpeed) {
@@ -176,18 +238,7 @@ void AuxManager::setGripSettings(int baseLevel, float speedFactor, float tempFac
     _startDelaySec = startDelaySec;
     _reactionSpeed = (ReactionSpeed)reactionSpeed;
     
-    _store->begin("aux", false);
-    _store->putInt("base", _baseLevel);
-    _store->putFloat("speedF", _speedFactor);
-    _store->putFloat("tempF", _tempFactor);
-    _store->putFloat("tempO", _tempOffset);
-    _store->putFloat("startT", _startTemp);
-    _store->putInt("rainB", _rainBoost);
-    _store->putInt("startL", _startupBoostLevel);
-    _store->putInt("startS", _startupBoostSec);
-    _store->putInt("startD", _startDelaySec);
-    _store->putInt("react", (int)_reactionSpeed);
-    _store->end();
+    saveSettings();
 }
 
 void AuxManager::getGripSettings(int &baseLevel, float &speedFactor, float &tempFactor, float &tempOffset, float &startTemp, int &rainBoost, int &startupBoostLevel, int &startupBoostSec, int &startDelaySec, int &reactionSpeed) {
@@ -5,6 +5,7 @@
 #include "config.h"
 #include "ImuHandler.h"
 #include "Persistence.h"
+#include "ConfigStore.h"
 
 enum AuxMode {
     AUX_MODE_OFF = 0,
@@ -37,6 +38,11 @@ public:
     bool isPowered() const { return _isPowered; }
     bool isBoostActive() const { return _isBoosting; }
     
+    // Settings by key ("base", "speedF", see auxParams in AuxManager.cpp), e.g. for remote
+    // access. setParam() clamps to the valid range, applies and saves.
+    bool getParam(const char* key, float& value) const;
+    bool setParam(const char* key, float value);
+
     // Manual Control
     void toggleManualOverride();
     bool isManualOverrideActive() const { return _manualOverride; }
@@ -72,6 +78,10 @@ private:
     
     unsigned long _startTime = 0;
     
+    void applySettings(const AuxSettings& s);
+    void exportSettings(AuxSettings& s) const;
+    bool saveSettings(); // Writes the Aux section of the config record
+
     void handleAuxPower();
     void handleHeatedGrips(float speed, float temp, bool rain);
     void setPwm(int percent);
@@ -0,0 +1,288 @@
+#include "ConfigStore.h"
+#include "Crc32.h"
+#include "WebConsole.h"
+
+#define CONFIG_MAX_SIZE 256 // Read buffer, also bounds records of older versions
+#define CONFIG_PAGE_MAGIC 0x47464E43 // "CNFG"
+
+ConfigStore configStore;
+
+const ConfigStore::ConfigRecord& ConfigStore::defaults() {
+    static ConfigRecord d = [] {
+        ConfigRecord r;
+        memset(&r, 0, sizeof(r));
+        r.imu.chainOnRight = true;
+        return r;
+    }();
+    return d;
+}
+
+ConfigStore::ConfigRecord* ConfigStore::ram() {
+    if (!_ram) _ram = new ConfigRecord(defaults());
+    return _ram;
+}
+
+void ConfigStore::seal(ConfigRecord& r) {
+    r.version = CONFIG_VERSION;
+    r.size = sizeof(ConfigRecord);
+    const uint8_t* p = (const uint8_t*)&r;
+    r.crc = crc32(p + sizeof(r.crc), sizeof(ConfigRecord) - sizeof(r.crc));
+}
+
+bool ConfigStore::load(IPersistence* store) {
+    static_assert(sizeof(ConfigRecord) <= CONFIG_MAX_SIZE, "ConfigRecord too large");
+    if (_loaded) return record().sections != 0;
+    _loaded = true;
+
+    _flashReady = _flash && _flash->begin() && _flash->pageCount() == 2;
+    if (_flashReady && loadFlash()) {
+        return true;
+    }
+
+    bool ok = loadStore(store);
+    if (ok && _flashReady) {
+        // Move the record of older firmware to the flash pages, then drop the key
+        ConfigRecord next = record();
+        seal(next);
+        if (writeFlash(next)) {
+            store->begin(CONFIG_NAMESPACE, false);
+            store->remove(CONFIG_KEY);
+            store->end();
+            Serial.println("Config: Record moved to flash");
+        }
+    }
+    return ok;
+}
+
+bool ConfigStore::loadFlash() {
+    uint32_t ps = _flash->pageSize();
+    PageHeader hdr[2];
+    for (uint32_t p = 0; p < 2; p++) {
+        _flash->read(p * ps, &hdr[p], sizeof(PageHeader));
+    }
+
+    // Newest valid page first; an invalid record falls back to the other page
+    for (int attempt = 0; attempt < 2; attempt++) {
+        int page = -1;
+        for (uint32_t p = 0; p < 2; p++) {
+            if (hdr[p].magic != CONFIG_PAGE_MAGIC) continue;
+            if (page < 0 || hdr[p].seq > hdr[page].seq) page = p;
+        }
+        if (page < 0) return false;
+
+        uint32_t offset = page * ps + sizeof(PageHeader);
+        uint16_t size = 0;
+        _flash->read(offset + 6, &size, sizeof(size));
+
+        if (size >= 8 && size <= CONFIG_MAX_SIZE && size <= ps - sizeof(PageHeader)) {
+            const uint8_t* raw = _flash->mapped(offset);
+            uint32_t buf[CONFIG_MAX_SIZE / 4];
+            if (!raw) {
+                _flash->read(offset, buf, size);
+                raw = (const uint8_t*)buf;
+            }
+
+            const ConfigRecord* r = parse(raw, size);
+            if (r) {
+                _flashPage = page;
+                _flashSeq = hdr[page].seq;
+                if (r == (const ConfigRecord*)raw && raw != (const uint8_t*)buf) {
+                    _active = r; // Zero copy
+                } else if (r == (const ConfigRecord*)raw) {
+                    memcpy(ram(), raw, sizeof(ConfigRecord));
+                    _active = _ram;
+                } else {
+                    // Migrated into _ram: store it in the current layout
+                    _active = _ram;
+                    ConfigRecord next = *_ram;
+                    write(nullptr, next);
+                }
+                return true;
+            }
+        }
+        hdr[page].magic = 0; // Try the other page
+    }
+    return false;
+}
+
+bool ConfigStore::loadStore(IPersistence* store) {
+    store->begin(CONFIG_NAMESPACE, true);
+    size_t len = store->getBytesLength(CONFIG_KEY);
+    uint32_t raw[CONFIG_MAX_SIZE / 4];
+    bool ok = (len > sizeof(uint32_t) + 2 * sizeof(uint16_t) && len <= sizeof(raw) &&
+               store->getBytes(CONFIG_KEY, raw, len) == len);
+    store->end();
+
+    if (!ok) {
+        if (len > 0) Serial.println("Config: Invalid record size, using defaults");
+        return false;
+    }
+
+    const ConfigRecord* r = parse((const uint8_t*)raw, len);
+    if (!r) return false;
+
+    if (r == (const ConfigRecord*)raw) {
+        memcpy(ram(), raw, sizeof(ConfigRecord));
+        _active = _ram;
+    } else {
+        _active = _ram;
+        if (!_flashReady) {
+            ConfigRecord next = *_ram;
+            write(store, next); // Persist converted record so the migration runs only once
+        }
+    }
+    return true;
+}
+
+const ConfigStore::ConfigRecord* ConfigStore::parse(const uint8_t* raw, size_t len) {
+    uint32_t crc;
+    uint16_t version, size;
+    memcpy(&crc, raw, sizeof(crc));
+    memcpy(&version, raw + 4, sizeof(version));
+    memcpy(&size, raw + 6, sizeof(size));
+
+    if (size != len || crc32(raw + sizeof(crc), len - sizeof(crc)) != crc) {
+        Serial.println("Config: CRC error, using defaults");
+        webConsole.log("Config: CRC error, using defaults");
+        return nullptr;
+    }
+
+    if (version == CONFIG_VERSION && len == sizeof(ConfigRecord)) {
+        return (const ConfigRecord*)raw;
+    }
+    if (version < CONFIG_VERSION && migrate(raw, len, version, *ram())) {
+        Serial.printf("Config: Migrated record v%u -> v%u\n", version, CONFIG_VERSION);
+        webConsole.logf("Config: Migrated v%u -> v%u", version, CONFIG_VERSION);
+        return _ram;
+    }
+    if (version == CONFIG_VERSION && resize(raw, len, *ram())) {
+        Serial.printf("Config: Converted record of another range count (%u -> %u bytes)\n", (unsigned)len, (unsigned)sizeof(ConfigRecord));
+        webConsole.log("Config: Range count changed, record converted");
+        return _ram;
+    }
+    Serial.printf("Config: Unsupported record v%u (%u bytes), using defaults\n", version, (unsigned)len);
+    return nullptr;
+}
+
+bool ConfigStore::migrate(const uint8_t* raw, size_t len, uint16_t version, ConfigRecord& out) {
+    // One case per older layout, converting raw into out. None yet (v1 is the first).
+    (void)raw;
+    (void)len;
+    (void)out;
+    switch (version) {
+        default:
+            return false;
+    }
+}
+
+// Same version, other NUM_RANGES: only the two per-range arrays at the start of
+// OilerSettings differ in size. Keeps all other settings (IMU calibration, Aux, ...);
+// ranges beyond the old count repeat its last one until the Oiler applies its defaults.
+bool ConfigStore::resize(const uint8_t* raw, size_t len, ConfigRecord& out) {
+    static_assert(offsetof(OilerSettings, basePulse25) == NUM_RANGES * 8, "Per-range arrays must lead OilerSettings");
+    const size_t head = offsetof(ConfigRecord, oiler);
+    const size_t tail = sizeof(ConfigRecord) - head - NUM_RANGES * 8; // From basePulse25 on
+    if (len <= head + tail || (len - head - tail) % 8 != 0) return false;
+    size_t oldRanges = (len - head - tail) / 8;
+    if (oldRanges < RANGE_MIN_COUNT || oldRanges > RANGE_MAX_COUNT || oldRanges == (size_t)NUM_RANGES) return false;
+
+    const uint8_t* oiler = raw + head;
+    size_t n = oldRanges < (size_t)NUM_RANGES ? oldRanges : (size_t)NUM_RANGES;
+    memcpy(&out, raw, head);
+    memcpy(out.oiler.intervalKm, oiler, n * sizeof(float));
+    memcpy(out.oiler.pulses, oiler + oldRanges * sizeof(float), n * sizeof(int32_t));
+    for (size_t i = n; i < (size_t)NUM_RANGES; i++) {
+        out.oiler.intervalKm[i] = out.oiler.intervalKm[n - 1];
+        out.oiler.pulses[i] = out.oiler.pulses[n - 1];
+    }
+    memcpy((uint8_t*)&out + head + NUM_RANGES * 8, oiler + oldRanges * 8, tail);
+    return true;
+}
+
+bool ConfigStore::save(IPersistence* store, const OilerSettings& settings) {
+    ConfigRecord next = record();
+    next.oiler = settings;
+    next.sections |= CONFIG_SECTION_OILER;
+    return write(store, next);
+}
+
+bool ConfigStore::save(IPersistence* store, const ImuSettings& settings) {
+    ConfigRecord next = record();
+    next.imu = settings;
+    next.sections |= CONFIG_SECTION_IMU;
+    return write(store, next);
+}
+
+bool ConfigStore::save(IPersistence* store, const AuxSettings& settings) {
+    ConfigRecord next = record();
+    next.aux = settings;
+    next.sections |= CONFIG_SECTION_AUX;
+    return write(store, next);
+}
+
+bool ConfigStore::discard(IPersistence* store, uint8_t sections) {
+    ConfigRecord next = record();
+    next.sections &= ~sections;
+    return write(store, next);
+}
+
+bool ConfigStore::write(IPersistence* store, ConfigRecord& next) {
+    seal(next);
+    if (_active && next.crc == _active->crc) return true; // Unchanged, no flash write
+
+    if (_flashReady && writeFlash(next)) {
+        return true;
+    }
+    if (!store) return false;
+
+    store->begin(CONFIG_NAMESPACE, false);
+    store->putBytes(CONFIG_KEY, &next, sizeof(ConfigRecord));
+    // Puts report no errors: the stored record must carry the new CRC
+    uint32_t crc = 0;
+    bool ok = store->getBytesLength(CONFIG_KEY) == sizeof(ConfigRecord) &&
+              store->getBytes(CONFIG_KEY, &crc, sizeof(crc)) == sizeof(crc) && crc == next.crc;
+    store->end();
+    if (!ok || !ram()) {
+        Serial.println("Config: Store write failed");
+        webConsole.log("Config: Store write failed");
+        return false;
+    }
+    *_ram = next;
+    _active = _ram;
+    return true;
+}
+
+bool ConfigStore::writeFlash(const ConfigRecord& next) {
+    uint32_t page = (_flashPage < 0) ? 0 : 1 - _flashPage;
+    uint32_t base = page * _flash->pageSize();
+    uint32_t buf[(sizeof(ConfigRecord) + 3) / 4]; // Flash writes are word sized
+    memset(buf, 0xFF, sizeof(buf));
+    memcpy(buf, &next, sizeof(ConfigRecord));
+    PageHeader hdr = { _flashSeq + 1, CONFIG_PAGE_MAGIC };
+
+    // Record first, header last: a valid header always belongs to a complete record
+    if (!_flash->erasePage(page) ||
+        !_flash->write(base + sizeof(PageHeader), buf, sizeof(buf)) ||
+        !_flash->write(base, &hdr, sizeof(hdr))) {
+        Serial.println("Config: Flash write failed");
+        webConsole.log("Config: Flash write failed");
+        return false;
+    }
+    return attachFlash(page, hdr.seq);
+}
+
+bool ConfigStore::attachFlash(uint32_t page, uint32_t seq) {
+    uint32_t offset = page * _flash->pageSize() + sizeof(PageHeader);
+    const uint8_t* mapped = _flash->mapped(offset);
+    if (mapped) {
+        _active = (const ConfigRecord*)mapped;
+        delete _ram; // RAM copy no longer needed
+        _ram = nullptr;
+    } else {
+        _flash->read(offset, ram(), sizeof(ConfigRecord));
+        _active = _ram;
+    }
+    _flashPage = page;
+    _flashSeq = seq;
+    return true;
+}
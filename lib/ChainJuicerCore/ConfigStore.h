@@ -0,0 +1,154 @@
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "SpeedRanges.h"
+#include "Persistence.h"
+#include "FlashDevice.h"
+
+#define CONFIG_VERSION 1
+#define CONFIG_NAMESPACE "cfg"
+#define CONFIG_KEY "record"
+
+// Sections (bitmask): a section is valid once its owner has written it
+#define CONFIG_SECTION_OILER 0x01
+#define CONFIG_SECTION_IMU   0x02
+#define CONFIG_SECTION_AUX   0x04
+
+struct OilerSettings {
+    float intervalKm[NUM_RANGES];
+    int32_t pulses[NUM_RANGES];
+    float basePulse25;
+    float basePause25;
+    int32_t oilType;
+    uint8_t ledBrightnessDim;
+    uint8_t ledBrightnessHigh;
+    uint8_t nightBrightness;
+    uint8_t nightBrightnessHigh;
+    bool nightModeEnabled;
+    bool emergencyModeForced;
+    bool tankMonitorEnabled;
+    uint8_t reserved;
+    int32_t nightStartHour;
+    int32_t nightEndHour;
+    int32_t offroadIntervalMin;
+    float startupDelayMeters;
+    int32_t flushConfigEvents;
+    int32_t flushConfigPulses;
+    int32_t flushConfigIntervalSec;
+    float tankCapacityMl;
+    int32_t dropsPerMl;
+    int32_t dropsPerPulse;
+    int32_t tankWarningThresholdPercent;
+};
+
+struct ImuSettings {
+    float offsetRoll;
+    float offsetPitch;
+    bool chainOnRight;
+    uint8_t reserved[3];
+};
+
+struct AuxSettings {
+    int32_t mode;
+    int32_t baseLevel;
+    float speedFactor;
+    float tempFactor;
+    float tempOffset;
+    float startTemp;
+    int32_t rainBoost;
+    int32_t startupBoostLevel;
+    int32_t startupBoostSec;
+    int32_t startDelaySec;
+    int32_t reactionSpeed;
+    bool manualOverride;
+    uint8_t reserved[3];
+};
+
+/**
+ * All user settings (Oiler, IMU calibration, Aux) in one versioned, CRC-checked record.
+ * Loaded with a single read at boot instead of ~50 per-key lookups.
+ *
+ * With setFlash() the record lives on a raw flash page pair (ping-pong): a save erases
+ * the inactive page, programs the record and then the page header, so the previous
+ * record stays valid until the new one is complete. Flash is memory mapped, so the
+ * accessors return references straight into flash: no copy, no file system call.
+ * Without flash (or if it is unavailable) the record is kept in the IPersistence store
+ * and a RAM copy. References stay valid until the next save.
+ *
+ * Each module applies its section if valid; otherwise it reads its legacy per-key
+ * values once, writes its section and removes the old keys (automatic migration).
+ * Runtime state (progress, odometer, stats, rain mode) stays in small per-key values.
+ *
+ * Changing a settings struct requires bumping CONFIG_VERSION and adding a case to
+ * migrate() that converts the previous layout.
+ * Records of a build with another range count (RANGE_PROFILE) are converted by resize().
+ */
+class ConfigStore {
+public:
+    // Optional raw flash page pair for the record. Call before the first load().
+    void setFlash(IFlashDevice* flash) { _flash = flash; }
+
+    // Reads the record once; later calls are no-ops. Returns true if a valid record exists.
+    bool load(IPersistence* store);
+    bool has(uint8_t section) const { return (record().sections & section) != 0; }
+    bool isFlashBacked() const { return _flashPage >= 0; }
+
+    // Read-only (defaults if the section is not valid)
+    const OilerSettings& oiler() const { return section(CONFIG_SECTION_OILER).oiler; }
+    const ImuSettings& imu() const { return section(CONFIG_SECTION_IMU).imu; }
+    const AuxSettings& aux() const { return section(CONFIG_SECTION_AUX).aux; }
+
+    // Replaces a section, marks it valid and writes the record (skipped if nothing changed).
+    // False: neither the flash pages nor the store took the record, the previous one stays active.
+    bool save(IPersistence* store, const OilerSettings& settings);
+    bool save(IPersistence* store, const ImuSettings& settings);
+    bool save(IPersistence* store, const AuxSettings& settings);
+    // Invalidates sections (e.g. factory reset): owners fall back to defaults on next boot
+    bool discard(IPersistence* store, uint8_t sections);
+
+private:
+    struct ConfigRecord {
+        uint32_t crc;      // Over everything after this field
+        uint16_t version;
+        uint16_t size;     // sizeof(ConfigRecord) of the writing firmware
+        uint8_t sections;  // CONFIG_SECTION_* bitmask
+        uint8_t reserved[3];
+        OilerSettings oiler;
+        ImuSettings imu;
+        AuxSettings aux;
+    };
+
+    struct PageHeader {
+        uint32_t seq;   // Increments with every save
+        uint32_t magic; // Written after seq
+    };
+
+    const ConfigRecord* _active = nullptr; // In flash or _ram, nullptr = defaults
+    ConfigRecord* _ram = nullptr;          // Only allocated without mapped flash
+    IFlashDevice* _flash = nullptr;
+    bool _flashReady = false;
+    int _flashPage = -1;                   // Page of the active record, -1 = not in flash
+    uint32_t _flashSeq = 0;
+    bool _loaded = false;
+
+    static const ConfigRecord& defaults();
+    const ConfigRecord& record() const { return _active ? *_active : defaults(); }
+    const ConfigRecord& section(uint8_t s) const { return has(s) ? record() : defaults(); }
+    ConfigRecord* ram();
+
+    bool loadFlash();
+    bool loadStore(IPersistence* store);
+    const ConfigRecord* parse(const uint8_t* raw, size_t len);
+    bool migrate(const uint8_t* raw, size_t len, uint16_t version, ConfigRecord& out);
+    bool resize(const uint8_t* raw, size_t len, ConfigRecord& out);
+    bool write(IPersistence* store, ConfigRecord& next);
+    bool writeFlash(const ConfigRecord& next);
+    bool attachFlash(uint32_t page, uint32_t seq);
+    static void seal(ConfigRecord& r); // Sets version, size and CRC
+};
+
+extern ConfigStore configStore;
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <Arduino.h>
+
+/**
+ * Small bitwise CRC-32 (IEEE 802.3, reflected, poly 0xEDB88320).
+ * No table to keep flash usage low; inputs are only a few hundred bytes.
+ * Pass the previous result as 'crc' to checksum data in several chunks.
+ */
+inline uint32_t crc32Update(uint32_t crc, const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    crc = ~crc;
+    while (len--) {
+        crc ^= *p++;
+        for (int k = 0; k < 8; k++) {
+            crc = (crc >> 1) ^ (0xEDB88320UL & (0UL - (crc & 1UL)));
+        }
+    }
+    return ~crc;
+}
+
+inline uint32_t crc32(const void* data, size_t len) {
+    return crc32Update(0, data, len);
+}
+
+#endif
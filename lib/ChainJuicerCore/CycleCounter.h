@@ -0,0 +1,66 @@
+#ifndef CYCLE_COUNTER_H
+#define CYCLE_COUNTER_H
+
+#include <Arduino.h>
+
+/**
+ * CPU cycle counter for profiling hot paths, e.g. cycles per Oiler::update().
+ * nRF52840: DWT CYCCNT (64 MHz core clock, wraps after 67 s; only differences are used).
+ * Other targets: micros(), i.e. 1 "cycle" per microsecond.
+ */
+#ifdef ARDUINO_ARCH_NRF52
+#define CYCLE_COUNTER_HZ 64000000UL
+
+inline void cycleCounterBegin() {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+inline uint32_t cycleCount() { return DWT->CYCCNT; }
+#else
+#define CYCLE_COUNTER_HZ 1000000UL
+
+inline void cycleCounterBegin() {}
+inline uint32_t cycleCount() { return micros(); }
+#endif
+
+struct CycleStats {
+    uint32_t calls;
+    uint32_t maxCycles;
+    uint64_t totalCycles;
+
+    void add(uint32_t cycles) {
+        calls++;
+        totalCycles += cycles;
+        if (cycles > maxCycles) maxCycles = cycles;
+    }
+
+    void print(Print& out, const char* name) const {
+        uint32_t mean = calls ? (uint32_t)(totalCycles / calls) : 0;
+        out.printf("  %-10s %8lu calls, mean %6lu cycles (%.1f us), max %7lu cycles (%.1f us)\n", name,
+                   (unsigned long)calls, (unsigned long)mean, mean * 1.0e6f / CYCLE_COUNTER_HZ,
+                   (unsigned long)maxCycles, maxCycles * 1.0e6f / CYCLE_COUNTER_HZ);
+    }
+};
+
+// Share of time spent sleeping between loop passes (idle current is a fraction of run current)
+struct SleepStats {
+    uint32_t startMs;
+    uint32_t sleeps;
+    uint64_t sleptMs;
+
+    void add(uint32_t ms) {
+        if (sleeps == 0) startMs = millis() - ms;
+        sleeps++;
+        sleptMs += ms;
+    }
+
+    void print(Print& out, const char* name) const {
+        uint32_t spanMs = millis() - startMs;
+        if (sleeps == 0 || spanMs == 0) return;
+        out.printf("  %-10s %8lu sleeps (%.1f/s), asleep %.1f%% of %lu s\n", name, (unsigned long)sleeps,
+                   sleeps * 1000.0f / spanMs, sleptMs * 100.0f / spanMs, (unsigned long)(spanMs / 1000));
+    }
+};
+
+#endif
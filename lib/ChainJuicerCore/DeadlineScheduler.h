@@ -0,0 +1,40 @@
+#ifndef DEADLINE_SCHEDULER_H
+#define DEADLINE_SCHEDULER_H
+
+#include <Arduino.h>
+
+/**
+ * Deadline table for cooperative tasks: each task registers the millis() time it is due
+ * next, the owner runs only what is due and sleeps until the earliest deadline.
+ * N is small (one slot per subsystem), so a linear scan beats any heap or wheel.
+ * Times wrap with millis(); deadlines must lie less than 24 days ahead.
+ */
+template<uint8_t N>
+class DeadlineScheduler {
+public:
+    DeadlineScheduler() {
+        for (uint8_t i = 0; i < N; i++) _due[i] = 0; // Everything due on the first run
+    }
+
+    void at(uint8_t task, uint32_t dueMs) { _due[task] = dueMs; }
+    void after(uint8_t task, uint32_t now, uint32_t delayMs) { _due[task] = now + delayMs; }
+    void wake(uint8_t task) { _due[task] = millis(); } // Due on the next run (e.g. set from update())
+
+    bool due(uint8_t task, uint32_t now) const { return (int32_t)(now - _due[task]) >= 0; }
+
+    // Milliseconds until the earliest deadline, 0 if one is due, at most maxMs
+    uint32_t msUntilNext(uint32_t now, uint32_t maxMs) const {
+        uint32_t next = maxMs;
+        for (uint8_t i = 0; i < N; i++) {
+            int32_t left = (int32_t)(_due[i] - now);
+            if (left <= 0) return 0;
+            if ((uint32_t)left < next) next = (uint32_t)left;
+        }
+        return next;
+    }
+
+private:
+    uint32_t _due[N];
+};
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef FLASH_DEVICE_H
+#define FLASH_DEVICE_H
+
+#include <Arduino.h>
+
+/**
+ * Abstract raw flash region (NOR semantics).
+ * Offsets are relative to the start of the region.
+ * - write() can only clear bits (1 -> 0); offset and length must be 4-byte aligned.
+ * - erasePage() sets a whole page back to 0xFF.
+ * Used by stores that manage their own page layout instead of going through LittleFS.
+ */
+class IFlashDevice {
+public:
+    virtual ~IFlashDevice() {}
+
+    virtual bool begin() = 0;
+
+    virtual uint32_t pageSize() const = 0;
+    virtual uint32_t pageCount() const = 0;
+    uint32_t size() const { return pageSize() * pageCount(); }
+
+    // Direct pointer into the region if it is memory mapped, nullptr otherwise
+    virtual const uint8_t* mapped(uint32_t offset) const = 0;
+
+    virtual bool read(uint32_t offset, void* buf, size_t len) = 0;
+    virtual bool write(uint32_t offset, const void* data, size_t len) = 0;
+    virtual bool erasePage(uint32_t page) = 0;
+
+    // Helper: true if the whole range still reads as erased (0xFF)
+    bool isErased(uint32_t offset, size_t len) {
+        uint8_t buf[32];
+        while (len > 0) {
+            size_t chunk = (len < sizeof(buf)) ? len : sizeof(buf);
+            if (!read(offset, buf, chunk)) return false;
+            for (size_t i = 0; i < chunk; i++) {
+                if (buf[i] != 0xFF) return false;
+            }
+            offset += chunk;
+            len -= chunk;
+        }
+        return true;
+    }
+};
+
+#endif
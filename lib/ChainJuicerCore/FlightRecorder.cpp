@@ -0,0 +1,262 @@
+#include "FlightRecorder.h"
+#include "Crc32.h"
+
+#define FLIGHT_PAGE_MAGIC 0x52474C46 // "FLGR"
+#define FLIGHT_FREE_SLOT 0xFFFFFFFF
+
+FlightRecorder::FlightRecorder(IFlashDevice* flash) {
+    _flash = flash;
+    static_assert(sizeof(Record) == 24, "Record must stay 24 bytes (6 words)");
+    static_assert(sizeof(PageHeader) == 16, "Page header must stay 16 bytes");
+    static_assert(offsetof(Record, pulseMs) - offsetof(Record, dLat) == 8, "Anchor position needs 8 bytes");
+}
+
+bool FlightRecorder::readPageHeader(uint32_t page, PageHeader& hdr) {
+    _flash->read(page * _flash->pageSize(), &hdr, sizeof(hdr));
+    return hdr.magic == FLIGHT_PAGE_MAGIC;
+}
+
+uint8_t FlightRecorder::recordCrc(const Record& rec) {
+    Record r = rec;
+    r.crc = 0xFF;
+    return (uint8_t)crc32(&r, sizeof(r));
+}
+
+// Follows the position chain of a page; returns the first free slot
+uint32_t FlightRecorder::scanPage(uint32_t page, int32_t& lat, int32_t& lon, uint32_t* oilings) {
+    uint32_t slots = slotsPerPage();
+    for (uint32_t slot = 0; slot < slots; slot++) {
+        Record rec;
+        _flash->read(slotOffset(page, slot), &rec, sizeof(rec));
+        if (rec.time == FLIGHT_FREE_SLOT) return slot;
+        if (recordCrc(rec) != rec.crc) continue; // Torn
+        if (rec.type == REC_ANCHOR) {
+            memcpy(&lat, (const uint8_t*)&rec.dLat, 4);
+            memcpy(&lon, (const uint8_t*)&rec.dLat + 4, 4);
+        } else if (rec.type == REC_OILING) {
+            lat += rec.dLat;
+            lon += rec.dLon;
+            if (oilings) (*oilings)++;
+        }
+    }
+    return slots;
+}
+
+bool FlightRecorder::begin() {
+    if (_ready) return true;
+    if (!_flash->begin() || _flash->pageCount() < 2) {
+        Serial.println("Recorder: Flash region unavailable");
+        return false;
+    }
+
+    // Head = valid page with the highest sequence; count the oilings of all pages
+    bool found = false;
+    _count = 0;
+    for (uint32_t p = 0; p < _flash->pageCount(); p++) {
+        PageHeader hdr;
+        if (!readPageHeader(p, hdr)) continue;
+        int32_t lat = hdr.lat, lon = hdr.lon;
+        uint32_t freeSlot = scanPage(p, lat, lon, &_count);
+        if (!found || hdr.seq > _headSeq) {
+            _headPage = p;
+            _headSeq = hdr.seq;
+            _headSlot = freeSlot;
+            _lat = lat;
+            _lon = lon;
+            found = true;
+        }
+    }
+
+    if (!found) {
+        Serial.println("Recorder: Formatting");
+        _flash->erasePage(0);
+        _erases++;
+        PageHeader hdr = { 1, FLIGHT_PAGE_MAGIC, 0, 0 };
+        _flash->write(0, &hdr, sizeof(hdr));
+        _headPage = 0;
+        _headSeq = 1;
+        _headSlot = 0;
+        _lat = 0;
+        _lon = 0;
+    }
+
+    _cursor.valid = false;
+    _ready = true;
+    return true;
+}
+
+uint32_t FlightRecorder::getCapacity() const {
+    // One page is erased at each rotation
+    return (_flash->pageCount() - 1) * slotsPerPage();
+}
+
+void FlightRecorder::setTime(uint32_t unixSeconds) {
+    _timeBase = unixSeconds;
+    _timeBaseMs = millis();
+}
+
+uint32_t FlightRecorder::now() const {
+    return _timeBase ? _timeBase + (uint32_t)((millis() - _timeBaseMs) / 1000) : 0;
+}
+
+// Unix seconds of a UTC date and time (days from the civil calendar, 1970 to 2105)
+uint32_t FlightRecorder::unixTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second) {
+    uint32_t y = year - (month <= 2 ? 1 : 0);
+    uint32_t era = y / 400;
+    uint32_t yoe = y - era * 400;
+    uint32_t doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    uint32_t days = era * 146097 + doe - 719468;
+    return days * 86400UL + hour * 3600UL + minute * 60UL + second;
+}
+
+bool FlightRecorder::rotate() {
+    uint32_t next = (_headPage + 1) % _flash->pageCount();
+
+    // The oilings of the oldest page drop out of the ring
+    PageHeader old;
+    if (readPageHeader(next, old)) {
+        int32_t lat = old.lat, lon = old.lon;
+        uint32_t dropped = 0;
+        scanPage(next, lat, lon, &dropped);
+        _count -= dropped;
+    }
+
+    if (!_flash->erasePage(next)) return false;
+    _erases++;
+    _cursor.valid = false; // Indexes shift by the dropped oilings
+
+    // The chain of the new page starts where the head page ended
+    PageHeader hdr = { _headSeq + 1, FLIGHT_PAGE_MAGIC, _lat, _lon };
+    if (!_flash->write(next * _flash->pageSize(), &hdr, sizeof(hdr))) return false;
+    _headPage = next;
+    _headSeq++;
+    _headSlot = 0;
+    return true;
+}
+
+bool FlightRecorder::writeRecord(Record& rec) {
+    if (_headSlot >= slotsPerPage() && !rotate()) return false;
+    rec.crc = recordCrc(rec);
+    bool ok = _flash->write(slotOffset(_headPage, _headSlot), &rec, sizeof(rec));
+    _headSlot++; // Also after a failed write: the slot may be partly programmed
+    return ok;
+}
+
+static int32_t clampRound(float v, int32_t lo, int32_t hi) {
+    int32_t i = (int32_t)lroundf(v);
+    return i < lo ? lo : (i > hi ? hi : i);
+}
+
+bool FlightRecorder::append(const Entry& entry) {
+    if (!_ready) return false;
+
+    // No fix: the position chain stays where it is
+    int32_t lat = _lat, lon = _lon;
+    if (!(entry.flags & FLAG_NO_FIX)) {
+        lat = (int32_t)lround(entry.lat / FLIGHT_POS_UNIT);
+        lon = (int32_t)lround(entry.lon / FLIGHT_POS_UNIT);
+    }
+
+    int32_t dLat = lat - _lat, dLon = lon - _lon;
+    if (dLat < INT16_MIN || dLat > INT16_MAX || dLon < INT16_MIN || dLon > INT16_MAX) {
+        Record anchor;
+        memset(&anchor, 0xFF, sizeof(anchor));
+        anchor.time = entry.time;
+        memcpy((uint8_t*)&anchor.dLat, &lat, 4);
+        memcpy((uint8_t*)&anchor.dLat + 4, &lon, 4);
+        anchor.type = REC_ANCHOR;
+        if (!writeRecord(anchor)) return false;
+        _lat = lat;
+        _lon = lon;
+        dLat = 0;
+        dLon = 0;
+    }
+
+    Record rec;
+    memset(&rec, 0xFF, sizeof(rec));
+    rec.time = entry.time;
+    rec.dLat = (int16_t)dLat;
+    rec.dLon = (int16_t)dLon;
+    rec.speed = (uint16_t)clampRound(entry.speedKmh * 10.0f, 0, 65535);
+    rec.lean = (int8_t)clampRound(entry.leanDeg, -127, 127);
+    rec.temp = (int8_t)clampRound(entry.tempC, -127, 127);
+    rec.pulseMs = entry.pulseMs;
+    rec.pauseMs = entry.pauseMs;
+    rec.tank = (uint16_t)clampRound(entry.tankMl * 10.0f, 0, 65535);
+    rec.pulses = entry.pulses;
+    rec.flags = entry.flags;
+    rec.type = REC_OILING;
+    if (!writeRecord(rec)) return false;
+
+    _lat = lat;
+    _lon = lon;
+    _count++;
+    _appends++;
+    return true;
+}
+
+size_t FlightRecorder::read(uint32_t first, Entry* out, size_t max) {
+    if (!_ready || max == 0) return 0;
+    size_t n = 0;
+    uint32_t pages = _flash->pageCount();
+    uint32_t slots = slotsPerPage();
+
+    // Oldest page first: the one after the head, around the ring. A read that continues
+    // the previous one resumes at its cursor instead of decoding from the start.
+    uint32_t k = 1, slot = 0, index = 0;
+    int32_t lat = 0, lon = 0;
+    bool resume = _cursor.valid && first >= _cursor.index;
+    if (resume) {
+        k = _cursor.k;
+        slot = _cursor.slot;
+        index = _cursor.index;
+        lat = _cursor.lat;
+        lon = _cursor.lon;
+    }
+
+    for (; k <= pages; k++, slot = 0) {
+        uint32_t page = (_headPage + k) % pages;
+        if (!resume) {
+            PageHeader hdr;
+            if (!readPageHeader(page, hdr)) continue;
+            lat = hdr.lat;
+            lon = hdr.lon;
+        }
+        resume = false;
+
+        for (; slot < slots; slot++) {
+            Record rec;
+            _flash->read(slotOffset(page, slot), &rec, sizeof(rec));
+            if (rec.time == FLIGHT_FREE_SLOT) break;
+            if (recordCrc(rec) != rec.crc) continue;
+            if (rec.type == REC_ANCHOR) {
+                memcpy(&lat, (const uint8_t*)&rec.dLat, 4);
+                memcpy(&lon, (const uint8_t*)&rec.dLat + 4, 4);
+                continue;
+            }
+            if (rec.type != REC_OILING) continue;
+            lat += rec.dLat;
+            lon += rec.dLon;
+            if (index++ < first) continue;
+
+            Entry& e = out[n];
+            e.time = rec.time;
+            e.lat = lat * FLIGHT_POS_UNIT;
+            e.lon = lon * FLIGHT_POS_UNIT;
+            e.speedKmh = rec.speed * 0.1f;
+            e.leanDeg = rec.lean;
+            e.tempC = rec.temp;
+            e.pulseMs = rec.pulseMs;
+            e.pauseMs = rec.pauseMs;
+            e.pulses = rec.pulses;
+            e.flags = rec.flags;
+            e.tankMl = rec.tank * 0.1f;
+            if (++n == max) {
+                _cursor = { true, k, slot + 1, index, lat, lon };
+                return n;
+            }
+        }
+    }
+    return n;
+}
@@ -0,0 +1,136 @@
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include "FlashDevice.h"
+
+#define FLIGHT_POS_UNIT 1e-5 // Degrees per position step (~1.1 m)
+
+/**
+ * Oiling flight recorder: one fixed 24-byte record per triggerOil() in a ring of raw
+ * flash pages (16 x 4 KB keep the last 2550 oilings, ~11000 km at ~4.5 km per oiling).
+ *
+ * Append-only: an oiling is a single 24-byte write, the oldest page is erased when the
+ * head page is full (one erase per 170 oilings); nothing is rewritten.
+ * Positions are deltas (1e-5 deg) to the previous record of the same page. The page
+ * header holds the position the page starts from, so every page decodes on its own
+ * after the ring wrapped; a jump beyond the int16 range (~36 km, e.g. after a transport
+ * or without fix) writes an anchor record with the absolute position first.
+ * Torn records (power cut during the write) fail their CRC and are skipped.
+ */
+class FlightRecorder {
+public:
+    enum Flags : uint8_t {
+        FLAG_RAIN = 0x01,
+        FLAG_OFFROAD = 0x02,
+        FLAG_EMERGENCY = 0x04,
+        FLAG_FLUSH = 0x08,
+        FLAG_NO_FIX = 0x10     // Position is the last known one
+    };
+
+    // One oiling, as appended and as returned by read() (stored resolution in brackets)
+    struct Entry {
+        uint32_t time;         // Unix seconds (GPS), 0 = unknown
+        double lat;            // Degrees [1e-5]
+        double lon;
+        float speedKmh;        // Smoothed [0.1]
+        float leanDeg;         // IMU roll [1]
+        float tempC;           // [1]
+        uint16_t pulseMs;      // Dynamic (temperature compensated) pulse
+        uint16_t pauseMs;
+        uint8_t pulses;
+        uint8_t flags;
+        float tankMl;          // After this oiling [0.1]
+    };
+
+    FlightRecorder(IFlashDevice* flash);
+
+    bool begin();
+    bool isReady() const { return _ready; }
+
+    // GPS time; later records count on from millis()
+    void setTime(uint32_t unixSeconds);
+    uint32_t now() const;
+    static uint32_t unixTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second);
+
+    bool append(const Entry& entry);
+
+    // Oilings stored, oldest first from index 0 (the ring drops the oldest page when full)
+    uint32_t count() const { return _count; }
+
+    // Bulk read for offline analysis: up to max decoded oilings from index first on,
+    // returns the number read. Reading on from where the last call stopped costs only
+    // the records returned, so a full dump in chunks is one pass over the ring.
+    size_t read(uint32_t first, Entry* out, size_t max);
+
+    // Status
+    uint32_t getAppendCount() const { return _appends; }
+    uint32_t getEraseCount() const { return _erases; }
+    uint32_t getCapacity() const;
+
+private:
+    enum RecordType : uint8_t {
+        REC_OILING = 1,
+        REC_ANCHOR = 2
+    };
+
+    struct PageHeader {
+        uint32_t seq;
+        uint32_t magic;        // Written after seq
+        int32_t lat;           // Start of the position chain [1e-5 deg]
+        int32_t lon;
+    };
+
+    struct Record {
+        uint32_t time;         // First word: 0xFFFFFFFF = free slot
+        int16_t dLat;          // Anchor: absolute lat/lon as int32 in dLat..temp
+        int16_t dLon;
+        uint16_t speed;        // 0.1 km/h
+        int8_t lean;
+        int8_t temp;
+        uint16_t pulseMs;
+        uint16_t pauseMs;
+        uint16_t tank;         // 0.1 ml
+        uint8_t pulses;
+        uint8_t flags;
+        uint8_t type;
+        uint8_t crc;           // Low byte of CRC32 over the record with crc = 0xFF
+        uint16_t reserved;     // Left erased
+    };
+
+    IFlashDevice* _flash;
+    bool _ready = false;
+    uint32_t _headPage = 0;
+    uint32_t _headSeq = 0;
+    uint32_t _headSlot = 0;    // Next free record slot in the head page
+    int32_t _lat = 0;          // End of the position chain of the head page
+    int32_t _lon = 0;
+    uint32_t _count = 0;
+    uint32_t _appends = 0;
+    uint32_t _erases = 0;
+
+    // Where the last read() stopped (page k after the head, next slot, chain position)
+    struct Cursor {
+        bool valid;
+        uint32_t k;
+        uint32_t slot;
+        uint32_t index;
+        int32_t lat;
+        int32_t lon;
+    };
+    Cursor _cursor = { false, 0, 0, 0, 0, 0 };
+
+    uint32_t _timeBase = 0;    // Unix seconds at _timeBaseMs, 0 = no GPS time yet
+    unsigned long _timeBaseMs = 0;
+
+    uint32_t slotsPerPage() const { return (_flash->pageSize() - sizeof(PageHeader)) / sizeof(Record); }
+    uint32_t slotOffset(uint32_t page, uint32_t slot) const {
+        return page * _flash->pageSize() + sizeof(PageHeader) + slot * sizeof(Record);
+    }
+    bool readPageHeader(uint32_t page, PageHeader& hdr);
+    uint32_t scanPage(uint32_t page, int32_t& lat, int32_t& lon, uint32_t* oilings);
+    bool writeRecord(Record& rec);
+    bool rotate();
+    static uint8_t recordCrc(const Record& rec);
+};
+
+#endif
@@ -0,0 +1,34 @@
+#include "GeoDistance.h"
+
+float GeoDistance::metres(double lat1, double lon1, double lat2, double lon2) {
+    float dLat = (float)(lat2 - lat1);
+    float dLon = (float)(lon2 - lon1);
+    float lat = (float)lat1;
+
+    if (fabsf(dLat) > GEO_LOCAL_WINDOW_DEG || fabsf(dLon) > GEO_LOCAL_WINDOW_DEG ||
+        fabsf(lat) > 85.0f || fabsf((float)lat2) > 85.0f) {
+        _fallbacks++;
+        return (float)haversine(lat1, lon1, lat2, lon2);
+    }
+
+    if (fabsf(lat - _refLat) > GEO_LOCAL_WINDOW_DEG) {
+        _refLat = lat;
+        _cosRef = cosf(lat * (float)DEG_TO_RAD);
+        _sinRef = sinf(lat * (float)DEG_TO_RAD);
+        _refreshes++;
+    }
+
+    // cos(mid-latitude) from the cached reference, second-order Taylor
+    float d = (float)DEG_TO_RAD * (lat + 0.5f * dLat - _refLat);
+    float cosMid = _cosRef * (1.0f - 0.5f * d * d) - _sinRef * d;
+
+    float x = dLon * cosMid;
+    return GEO_EARTH_RADIUS_M * (float)DEG_TO_RAD * sqrtf(x * x + dLat * dLat);
+}
+
+double GeoDistance::haversine(double lat1, double lon1, double lat2, double lon2) {
+    double sLat = sin(radians(lat2 - lat1) * 0.5);
+    double sLon = sin(radians(lon2 - lon1) * 0.5);
+    double a = sLat * sLat + cos(radians(lat1)) * cos(radians(lat2)) * sLon * sLon;
+    return 2.0 * (double)GEO_EARTH_RADIUS_M * atan2(sqrt(a), sqrt(1.0 - a));
+}
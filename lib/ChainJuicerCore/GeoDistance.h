@@ -0,0 +1,39 @@
+#ifndef GEO_DISTANCE_H
+#define GEO_DISTANCE_H
+
+#include <Arduino.h>
+
+#define GEO_EARTH_RADIUS_M 6372795.0f   // Same sphere as TinyGPSPlus::distanceBetween()
+#define GEO_LOCAL_WINDOW_DEG 0.1f       // Equirectangular up to ~11 km, also the cos/sin refresh distance
+
+/**
+ * Distance kernel for GPS hops. Short distances use the equirectangular (local planar)
+ * approximation in single precision: cos/sin of a reference latitude are cached and
+ * corrected (second-order Taylor) to the mid-latitude of the hop, so a fix costs a few float
+ * multiplies and one sqrtf instead of the double sin/cos/atan2 of TinyGPSPlus.
+ * The reference moves (one cosf/sinf) when the position is more than 0.1 deg away.
+ * Hops beyond the window, across the date line or above 85 deg use double haversine.
+ *
+ * Error against haversine (ride_replay --distance, up to 85 deg latitude): relative
+ * < 1e-6 (float resolution), i.e. < 1 mm up to 1 km and < 5 mm up to 11 km.
+ * The coordinates are subtracted in double first; float alone resolves only ~0.5 m.
+ */
+class GeoDistance {
+public:
+    float metres(double lat1, double lon1, double lat2, double lon2);
+
+    // Reference implementation, also used for long hops
+    static double haversine(double lat1, double lon1, double lat2, double lon2);
+
+    uint32_t getFallbacks() const { return _fallbacks; }
+    uint32_t getRefreshes() const { return _refreshes; }
+
+private:
+    float _refLat = 1000.0f;  // Invalid: first call sets the reference
+    float _cosRef = 1.0f;
+    float _sinRef = 0.0f;
+    uint32_t _fallbacks = 0;
+    uint32_t _refreshes = 0;
+};
+
+#endif
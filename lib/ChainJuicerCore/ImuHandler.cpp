@@ -1,5 +1,14 @@
 #include "ImuHandler.h"
 #include "WebConsole.h"
+#include "ParamRegistry.h"
+
+// IMU calibration: one line per value (legacy key, default, valid range)
+static constexpr ParamDesc imuParams[] = {
+    PARAM(PARAM_F32, ImuSettings, offsetRoll, "off_r", 0.0, -180, 180),
+    PARAM(PARAM_F32, ImuSettings, offsetPitch, "off_p", 0.0, -180, 180),
+    PARAM(PARAM_BOOL, ImuSettings, chainOnRight, "chain_r", true, 0, 1)
+};
+static constexpr ParamTable imuParamTable = PARAM_TABLE("imu", imuParams);
 
 ImuHandler::ImuHandler(IPersistence* store) {
     _store = store;
@@ -86,7 +95,8 @@ void ImuHandler::update() {
                 _linAccelX = _sensorValue.un.linearAcceleration.x;
                 _linAccelY = _sensorValue.un.linearAcceleration.y;
                 _linAccelZ = _sensorValue.un.linearAcceleration.z;
-                
+                integrateForward(millis());
+
                 // Simple motion check: Magnitude > threshold
                 if ((_linAccelX*_linAccelX + _linAccelY*_linAccelY + _linAccelZ*_linAccelZ) > (0.5 * 0.5)) { 
                     _lastMotionTime = millis();
@@ -100,6 +110,33 @@ void ImuHandler::update() {
     }
 }
 
+void ImuHandler::integrateForward(unsigned long now) {
+    unsigned long dt = now - _lastAccelMs;
+    _lastAccelMs = now;
+    if (dt > 200) return; // First sample or reports stopped: no interval to integrate
+    // Sensor frame -> forward axis of the bike (mounting pitch and direction)
+    float fwd = _linAccelX * _fwdAxisX + _linAccelZ * _fwdAxisZ;
+    _fwdDeltaV += fwd * (dt * 0.001f);
+    _fwdValid = true;
+}
+
+void ImuHandler::updateForwardAxis() {
+    // Level bike forward in sensor coordinates for a sensor pitched by _offsetPitch
+    // (x = cos, z = sin). On the left side the housing is turned around -> x points back.
+    float pitch = _offsetPitch * (float)M_PI / 180.0f;
+    float dir = _chainOnRight ? 1.0f : -1.0f;
+    _fwdAxisX = dir * cosf(pitch);
+    _fwdAxisZ = dir * sinf(pitch);
+}
+
+bool ImuHandler::takeForwardDeltaV(float& deltaVMs) {
+    deltaVMs = _fwdDeltaV;
+    _fwdDeltaV = 0.0f;
+    bool valid = _fwdValid;
+    _fwdValid = false;
+    return valid;
+}
+
 void ImuHandler::loop() {
     update();
 
@@ -136,6 +173,7 @@ void ImuHandler::loop() {
             if (_calSamples > 0) {
                 _offsetRoll = _calSumRoll / _calSamples;
                 _offsetPitch = _calSumPitch / _calSamples;
+                updateForwardAxis();
                 saveCalibration();
                 webConsole.log("IMU: Calibration DONE.");
                 webConsole.logf("IMU: Offsets: R=%.2f P=%.2f", _offsetRoll, _offsetPitch);
@@ -260,6 +298,7 @@ void ImuHandler::calibrateZero() {
     if (samples > 0) {
         _offsetRoll = sumRawRoll / samples;
         _offsetPitch = sumRawPitch / samples;
+        updateForwardAxis();
         
         saveCalibration();
         Serial.printf("IMU: Zero Calibrated. Samples: %d. Offsets: R=%.2f P=%.2f\n", samples, _offsetRoll, _offsetPitch);
@@ -268,25 +307,41 @@ void ImuHandler::calibrateZero() {
     }
 }
 
-void ImuHandler::saveCalibration() {
-    _store->begin("imu", false);
-    _store->putFloat("off_r", _offsetRoll);
-    _store->putFloat("off_p", _offsetPitch);
-    _store->putBool("chain_r", _chainOnRight);
-    _store->end();
+bool ImuHandler::saveCalibration() {
+    ImuSettings s = configStore.imu();
+    s.offsetRoll = _offsetRoll;
+    s.offsetPitch = _offsetPitch;
+    s.chainOnRight = _chainOnRight;
+    return configStore.save(_store, s);
 }
 
 void ImuHandler::loadCalibration() {
-    _store->begin("imu", true);
-    _offsetRoll = _store->getFloat("off_r", 0.0);
-    _offsetPitch = _store->getFloat("off_p", 0.0);
-    _chainOnRight = _store->getBool("chain_r", true);
-    _store->end();
+    configStore.load(_store);
+    ImuSettings s = configStore.imu();
+    bool migrate = !configStore.has(CONFIG_SECTION_IMU);
+    if (migrate) {
+        // Per-key calibration of older firmware into the config record
+        paramDefaults(imuParamTable, &s);
+        paramLoadLegacy(imuParamTable, _store, &s);
+    }
+    paramValidate(imuParamTable, &s);
+    _offsetRoll = s.offsetRoll;
+    _offsetPitch = s.offsetPitch;
+    _chainOnRight = s.chainOnRight;
+    updateForwardAxis();
+
+    if (migrate && saveCalibration()) {
+        // Old keys only go once the record holds the calibration
+        _store->begin("imu", false);
+        _store->clear();
+        _store->end();
+    }
 }
 
 void ImuHandler::setChainSide(bool isRight) {
     if (_chainOnRight != isRight) {
         _chainOnRight = isRight;
+        updateForwardAxis();
         saveCalibration();
     }
 }
@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include <Adafruit_BNO08x.h>
 #include "Persistence.h"
+#include "ConfigStore.h"
 
 class ImuHandler {
 public:
@@ -15,7 +16,7 @@ public:
     // Calibration
     void calibrateZero(); // "Tare" - Set current orientation as flat
     void startCalibration(); // Non-blocking calibration with countdown
-    void saveCalibration();
+    bool saveCalibration();
     void loadCalibration();
 
     // Status
@@ -33,6 +34,10 @@ public:
     bool isCrashed(); // Lean > 70
     bool isMotionDetected(); // Smart Stop helper (Vibration/Accel)
     bool isLeaningTowardsTire(float thresholdDeg); // Returns true if leaning towards the tire (Unsafe to oil)
+
+    // Forward velocity change in m/s integrated from linear acceleration (projected onto
+    // the bike axis: mounting pitch, chain side) since the last call. False if no sample arrived (no IMU): deltaVMs is then 0.
+    bool takeForwardDeltaV(float& deltaVMs);
     
     // Power Management
     void enableMotionInterrupt(); // Configure for Wake-on-Motion (Significant Motion)
@@ -65,6 +70,13 @@ private:
     float _linAccelZ = 0.0;
     unsigned long _lastMotionTime = 0;
 
+    // Speed fusion: integrated forward acceleration (see takeForwardDeltaV)
+    float _fwdDeltaV = 0.0f;
+    unsigned long _lastAccelMs = 0;
+    bool _fwdValid = false;
+    float _fwdAxisX = 1.0f; // Forward axis in sensor coordinates (updateForwardAxis)
+    float _fwdAxisZ = 0.0f;
+
     // Stability Check (Garage Guard)
     static const int HISTORY_SIZE = 100; // 5 seconds at ~20Hz (50ms update)
     float _rollHistory[HISTORY_SIZE];
@@ -76,6 +88,8 @@ private:
     
     void processOrientation();
     void updateHistory(float roll, float pitch);
+    void integrateForward(unsigned long now);
+    void updateForwardAxis();
     float calculateVariance(float* data, int size);
     
     unsigned long _lastUpdate = 0;
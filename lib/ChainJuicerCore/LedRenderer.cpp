@@ -0,0 +1,78 @@
+#include "LedRenderer.h"
+
+// round((sin(2*pi*i/64) + 1) / 2 * 255)
+static const uint8_t sineTable[64] = {
+    128, 140, 152, 165, 176, 188, 198, 208, 218, 226, 234, 240, 245, 250, 253, 254,
+    255, 254, 253, 250, 245, 240, 234, 226, 218, 208, 198, 188, 176, 165, 152, 140,
+    128, 115, 103,  90,  79,  67,  57,  47,  37,  29,  21,  15,  10,   5,   2,   1,
+      0,   1,   2,   5,  10,  15,  21,  29,  37,  47,  57,  67,  79,  90, 103, 115
+};
+
+uint8_t LedRenderer::sine(uint16_t phase) {
+    uint8_t i = phase >> 10;
+    uint8_t frac = (phase >> 2) & 0xFF;
+    int a = sineTable[i];
+    int b = sineTable[(i + 1) & 63];
+    return (uint8_t)(a + (((b - a) * frac) >> 8));
+}
+
+uint32_t LedRenderer::scale(uint32_t color, uint8_t bri) {
+    if (bri == 255) return color;
+    uint16_t k = (uint16_t)bri + 1;
+    uint32_t r = (((color >> 16) & 0xFF) * k) >> 8;
+    uint32_t g = (((color >> 8) & 0xFF) * k) >> 8;
+    uint32_t b = ((color & 0xFF) * k) >> 8;
+    return (r << 16) | (g << 8) | b;
+}
+
+uint32_t LedRenderer::evaluate(const LedPattern& p, uint32_t now, uint8_t dim, uint8_t high) {
+    uint8_t level = p.level == LEVEL_HIGH ? high : dim;
+    uint8_t altLevel = p.altLevel == LEVEL_HIGH ? high : dim;
+    uint32_t phase = p.periodMs ? now % p.periodMs : 0;
+
+    switch (p.wave) {
+        case WAVE_BLINK:
+            if (phase < p.periodMs / 2u) return scale(p.color, level);
+            return scale(p.altColor, altLevel);
+
+        case WAVE_DOUBLE:
+            if (phase < p.widthMs || (phase >= 2u * p.widthMs && phase < 3u * p.widthMs)) return scale(p.color, level);
+            return scale(p.altColor, altLevel);
+
+        case WAVE_PULSE: {
+            uint8_t s = sine((uint16_t)((phase << 16) / p.periodMs));
+            uint16_t w = p.floor + (((255 - p.floor) * s) / 255);
+            uint8_t bri = (uint8_t)((w * level) / 255);
+            if (bri < p.minBri) bri = p.minBri;
+            return scale(p.color, bri);
+        }
+
+        case WAVE_CYCLE:
+            return scale(p.cycleColors[(now / p.periodMs) % p.cycleCount], level);
+
+        case WAVE_STATIC:
+        default:
+            return scale(p.color, level);
+    }
+}
+
+bool LedRenderer::show(Adafruit_NeoPixel& strip, uint8_t count) {
+    if (count > LED_MAX_PIXELS) count = LED_MAX_PIXELS;
+    bool changed = !_valid;
+    for (uint8_t i = 0; i < count; i++) {
+        if (_next[i] != _shown[i]) changed = true;
+    }
+    if (!changed) {
+        _skipped++;
+        return false;
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        strip.setPixelColor(i, _next[i]);
+        _shown[i] = _next[i];
+    }
+    strip.show();
+    _valid = true;
+    _rendered++;
+    return true;
+}
@@ -0,0 +1,68 @@
+#ifndef LED_RENDERER_H
+#define LED_RENDERER_H
+
+#include <Arduino.h>
+#include <Adafruit_NeoPixel.h>
+
+#define LED_RGB(r, g, b) (((uint32_t)(r) << 16) | ((uint32_t)(g) << 8) | (uint32_t)(b)) // Same packing as Adafruit_NeoPixel::Color()
+#define LED_MAX_PIXELS 2 // Status LED + aux LED
+
+enum LedWave : uint8_t {
+    WAVE_STATIC,    // color
+    WAVE_BLINK,     // color for the first half of the period, then altColor
+    WAVE_DOUBLE,    // color during [0, widthMs) and [2*widthMs, 3*widthMs), else altColor
+    WAVE_PULSE,     // color, brightness follows a raised sine (floor: 0..255 of the level)
+    WAVE_CYCLE      // cycleColors[], one per period
+};
+
+enum LedLevel : uint8_t { LEVEL_DIM, LEVEL_HIGH };
+
+struct LedPattern {
+    LedWave wave;
+    uint32_t color;
+    uint32_t altColor;
+    LedLevel level;
+    LedLevel altLevel;
+    uint16_t periodMs;
+    uint16_t widthMs;   // WAVE_DOUBLE blink width
+    uint8_t floor;      // WAVE_PULSE: lowest point of the wave, 1/255 of the level
+    uint8_t minBri;     // WAVE_PULSE: brightness never drops below this
+    const uint32_t* cycleColors;
+    uint8_t cycleCount;
+};
+
+/**
+ * Renders LedPattern table entries into the strip. Waveforms come from a 64-entry sine
+ * table (linear interpolation), brightness is applied per pixel with the Adafruit
+ * setBrightness() formula, so the strip brightness stays at full scale and one pixel no
+ * longer rescales the other. show() only pushes a frame when a pixel actually changed:
+ * static patterns cost no WS2812 transfer at all (~30 us per pixel with interrupts off).
+ */
+class LedRenderer {
+public:
+    // Raised sine, 0..255 over one turn of phase (0..65535)
+    static uint8_t sine(uint16_t phase);
+
+    // Scales color by brightness exactly like Adafruit_NeoPixel::setBrightness()
+    static uint32_t scale(uint32_t color, uint8_t bri);
+
+    // Color of pattern p at time now, with the brightness levels applied
+    static uint32_t evaluate(const LedPattern& p, uint32_t now, uint8_t dim, uint8_t high);
+
+    void set(uint8_t pixel, uint32_t color) { if (pixel < LED_MAX_PIXELS) _next[pixel] = color; }
+
+    // Pushes the frame if any pixel differs from the last one shown. Returns true if it did.
+    bool show(Adafruit_NeoPixel& strip, uint8_t count);
+
+    uint32_t getFramesRendered() const { return _rendered; }
+    uint32_t getFramesSkipped() const { return _skipped; }
+
+private:
+    uint32_t _next[LED_MAX_PIXELS] = {};
+    uint32_t _shown[LED_MAX_PIXELS] = {};
+    bool _valid = false; // Nothing shown yet
+    uint32_t _rendered = 0;
+    uint32_t _skipped = 0;
+};
+
+#endif
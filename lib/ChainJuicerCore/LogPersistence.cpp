@@ -0,0 +1,951 @@
+#include "LogPersistence.h"
+#include "Crc32.h"
+#include "CycleCounter.h"
+
+#define LOG_PAGE_MAGIC 0x474F4C4A // "JLOG"
+#define LOG_COMMIT_WORD 0x00000000
+
+// Record Types
+#define REC_TYPE_PUT 0x01
+#define REC_TYPE_CLEAR 0x02 // Key = "namespace/", drops all keys of the namespace
+#define REC_TYPE_BATCH 0x03 // No key, value = sequence of batch entries (one transaction)
+#define REC_TYPE_ENTRY 0x04 // Entry inside a batch (same header layout, no own CRC/commit)
+#define REC_TYPE_REMOVE 0x05 // Key = "namespace/key", no value
+#define REC_TYPE_ERASED 0xFF
+
+static_assert(LOG_INDEX_CAPACITY < 0xFF, "Lookup cache stores index slots as uint8_t (0xFF = empty)");
+
+// Collects bytes and programs them as full words (flash is word addressed)
+struct WordWriter {
+    IFlashDevice* flash;
+    uint32_t offset;
+    uint8_t word[4];
+    uint8_t fill;
+    bool ok;
+
+    WordWriter(IFlashDevice* f, uint32_t off) : flash(f), offset(off), fill(0), ok(true) {}
+
+    void put(const void* data, size_t len) {
+        const uint8_t* p = (const uint8_t*)data;
+        while (len--) {
+            word[fill++] = *p++;
+            if (fill == 4) {
+                ok = ok && flash->write(offset, word, 4);
+                offset += 4;
+                fill = 0;
+            }
+        }
+    }
+
+    void flush() {
+        if (fill == 0) return;
+        while (fill < 4) word[fill++] = 0xFF;
+        ok = ok && flash->write(offset, word, 4);
+        offset += 4;
+        fill = 0;
+    }
+};
+
+LogPersistence::LogPersistence(IFlashDevice* flash) {
+    _flash = flash;
+    _namespace[0] = '\0';
+    memset(_cache, 0xFF, sizeof(_cache));
+}
+
+// --- Mount / Format ---
+
+bool LogPersistence::mount() {
+    if (_mounted) return true;
+    if (!_flash->begin()) return false;
+
+    uint32_t pages = _flash->pageCount();
+    uint32_t ps = _flash->pageSize();
+    if (pages < 2 || pages > 64 || ps > 4096) {
+        Serial.println("Log: Unsupported flash geometry");
+        return false;
+    }
+    _wear.setEraseBudget(pages); // The ring wears all pages evenly
+
+    // 1. Find valid pages and the head (highest sequence)
+    bool headFound = false;
+    for (uint32_t p = 0; p < pages; p++) {
+        PageHeader ph;
+        _flash->read(p * ps, &ph, sizeof(ph));
+        if (ph.magic == LOG_PAGE_MAGIC) {
+            if (!headFound || ph.seq > _headSeq) {
+                _headSeq = ph.seq;
+                _headPage = p;
+                headFound = true;
+            }
+        } else if (!_flash->isErased(p * ps, ps)) {
+            // Interrupted erase (compaction already finished) -> finish it
+            _flash->erasePage(p);
+        }
+    }
+
+    if (!headFound) {
+        format();
+        _mounted = true;
+        return true;
+    }
+
+    // 2. Replay pages oldest -> newest. Pages are allocated in ring order after the head.
+    _indexCount = 0;
+    for (uint32_t i = 1; i <= pages; i++) {
+        uint32_t p = (_headPage + i) % pages;
+        PageHeader ph;
+        _flash->read(p * ps, &ph, sizeof(ph));
+        if (ph.magic == LOG_PAGE_MAGIC) {
+            replayPage(p);
+        }
+    }
+
+    // Appends need erased flash behind the last record. A header corrupted by a power cut
+    // ends the replay early, but its words are already programmed: close the head page,
+    // the first append then rolls over to a fresh one.
+    if (_headOffset < ps && !_flash->isErased(_headPage * ps + _headOffset, ps - _headOffset)) {
+        Serial.printf("Log: Page %lu not erased after @ %lu, closed\n", (unsigned long)_headPage, (unsigned long)_headOffset);
+        _headOffset = ps;
+    }
+
+    // 3. Invariant: the page after the head is erased.
+    // If not, a compaction was interrupted -> copy whatever is still live and erase it.
+    // If that fails the page is kept (still readable), the next rollover retries.
+    uint32_t next = (_headPage + 1) % pages;
+    if (!_flash->isErased(next * ps, ps)) {
+        Serial.println("Log: Resuming interrupted compaction");
+        if (!reclaimPage(next)) {
+            Serial.printf("Log: Page %lu not reclaimed, log full\n", (unsigned long)next);
+        }
+    }
+
+    _mounted = true;
+    Serial.printf("Log: Mounted. Keys: %d, Head: Page %lu @ %lu\n", _indexCount, (unsigned long)_headPage, (unsigned long)_headOffset);
+    return true;
+}
+
+void LogPersistence::format() {
+    Serial.println("Log: Formatting flash log...");
+    uint32_t ps = _flash->pageSize();
+    for (uint32_t p = 0; p < _flash->pageCount(); p++) {
+        if (!_flash->isErased(p * ps, ps)) {
+            _flash->erasePage(p);
+        }
+    }
+
+    PageHeader ph = { 1, LOG_PAGE_MAGIC };
+    _flash->write(0, &ph, sizeof(ph));
+    _headPage = 0;
+    _headSeq = 1;
+    _headOffset = sizeof(PageHeader);
+    _indexCount = 0;
+    _formatted = true;
+}
+
+void LogPersistence::replayPage(uint32_t page) {
+    uint32_t ps = _flash->pageSize();
+    uint32_t offset = sizeof(PageHeader);
+
+    while (offset + sizeof(RecordHeader) <= ps) {
+        RecordHeader hdr;
+        RecordState state = readRecord(page * ps + offset, hdr);
+        if (state == REC_END) break;
+
+        if (state == REC_VALID) {
+            char key[LOG_MAX_KEY_LEN + 1];
+            _flash->read(page * ps + offset + sizeof(RecordHeader), key, hdr.keyLen);
+            key[hdr.keyLen] = '\0';
+
+            if (hdr.type == REC_TYPE_PUT) {
+                indexUpsert(key, hdr.keyLen, page * ps + offset);
+            } else if (hdr.type == REC_TYPE_CLEAR) {
+                indexDropNamespace(key, hdr.keyLen);
+            } else if (hdr.type == REC_TYPE_REMOVE) {
+                indexRemove(key, hdr.keyLen);
+            } else if (hdr.type == REC_TYPE_BATCH) {
+                indexBatch(page * ps + offset, hdr.valLen);
+            }
+        }
+        // Torn records are skipped, their length is still valid (header word is atomic)
+        offset += recordSize(hdr.keyLen, hdr.valLen);
+    }
+
+    if (page == _headPage) {
+        _headOffset = offset;
+    }
+}
+
+// --- Page Management ---
+
+bool LogPersistence::rollover() {
+    uint32_t pages = _flash->pageCount();
+    uint32_t ps = _flash->pageSize();
+
+    // Next page is always erased (invariant), open it as new head.
+    // After a failed compaction it still holds live records: retry into the current head.
+    uint32_t next = (_headPage + 1) % pages;
+    if (!_flash->isErased(next * ps, ps) && !reclaimPage(next)) return false;
+    PageHeader ph = { _headSeq + 1, LOG_PAGE_MAGIC };
+    if (!_flash->write(next * ps, &ph, sizeof(ph))) return false;
+
+    _headPage = next;
+    _headSeq++;
+    _headOffset = sizeof(PageHeader);
+
+    // Compact the oldest page into the new head, then erase it to restore the invariant
+    uint32_t oldest = (next + 1) % pages;
+    if (!_flash->isErased(oldest * ps, ps) && !reclaimPage(oldest)) {
+        Serial.println("Log: Compaction failed, log full");
+        return false;
+    }
+    return true;
+}
+
+bool LogPersistence::reclaimPage(uint32_t page) {
+    // Erase only if every live record was copied: otherwise the index still points
+    // into the page and reads would return erased or reused flash
+    if (!compactPage(page)) return false;
+    indexDropPage(page);
+    _flash->erasePage(page);
+    _wear.recordErase();
+    _compactions++;
+    return true;
+}
+
+bool LogPersistence::compactPage(uint32_t page) {
+    // Copies are never larger than the originals (batches stay batches), so a fresh
+    // head always has room. A head that already holds records (resumed compaction)
+    // may not: check first and copy nothing if it is short.
+    uint32_t bytes = 0;
+    compactRecords(page, false, bytes);
+    if (_headOffset + bytes > _flash->pageSize()) return false;
+    return compactRecords(page, true, bytes);
+}
+
+bool LogPersistence::compactRecords(uint32_t page, bool copy, uint32_t& bytes) {
+    uint32_t ps = _flash->pageSize();
+    uint32_t offset = sizeof(PageHeader);
+    bool ok = true;
+    char key[LOG_MAX_KEY_LEN + 1];
+
+    while (offset + sizeof(RecordHeader) <= ps) {
+        uint32_t recOffset = page * ps + offset;
+        RecordHeader hdr;
+        RecordState state = readRecord(recOffset, hdr);
+        if (state == REC_END) break;
+
+        if (state == REC_VALID && hdr.type == REC_TYPE_PUT) {
+            _flash->read(recOffset + sizeof(RecordHeader), key, hdr.keyLen);
+            if (isLive(key, hdr.keyLen, recOffset)) {
+                if (copy) ok = copyEntry(recOffset, key, hdr.keyLen) && ok;
+                bytes += recordSize(hdr.keyLen, hdr.valLen);
+            }
+        } else if (state == REC_VALID && hdr.type == REC_TYPE_BATCH) {
+            // Live entries of a batch stay one batch record (one commit word);
+            // a single one becomes a standalone record
+            uint32_t base = recOffset + sizeof(RecordHeader);
+            uint32_t first = 0;
+            uint32_t liveLen = 0;
+            uint32_t live = liveEntries(base, hdr.valLen, &liveLen, &first);
+            if (live == 1) {
+                RecordHeader eh;
+                _flash->read(first, &eh, sizeof(eh));
+                _flash->read(first + sizeof(RecordHeader), key, eh.keyLen);
+                if (copy) ok = copyEntry(first, key, eh.keyLen) && ok;
+                bytes += recordSize(eh.keyLen, eh.valLen);
+            } else if (live > 1) {
+                if (copy) ok = copyBatch(base, hdr.valLen, liveLen) && ok;
+                bytes += recordSize(0, liveLen);
+            }
+        }
+        // Clear/remove markers and dead records are dropped: nothing older than this page exists
+        offset += recordSize(hdr.keyLen, hdr.valLen);
+    }
+    return ok;
+}
+
+uint32_t LogPersistence::liveEntries(uint32_t base, uint16_t payloadLen, uint32_t* liveLen, uint32_t* first) {
+    uint32_t count = 0;
+    uint32_t pos = 0;
+    char key[LOG_MAX_KEY_LEN + 1];
+
+    while (pos + sizeof(RecordHeader) <= payloadLen) {
+        RecordHeader eh;
+        _flash->read(base + pos, &eh, sizeof(eh));
+        if (eh.type != REC_TYPE_ENTRY || eh.keyLen > LOG_MAX_KEY_LEN) break;
+        _flash->read(base + pos + sizeof(RecordHeader), key, eh.keyLen);
+        if (isLive(key, eh.keyLen, base + pos)) {
+            if (count++ == 0) *first = base + pos;
+            *liveLen += entrySize(eh.keyLen, eh.valLen);
+        }
+        pos += entrySize(eh.keyLen, eh.valLen);
+    }
+    return count;
+}
+
+void LogPersistence::streamLiveEntries(uint32_t base, uint16_t payloadLen, uint32_t* crc, WordWriter* w) {
+    uint32_t overhead = recordSize(0, 0); // Batch header and commit word, charged to the first entry
+    uint32_t pos = 0;
+    uint8_t buf[32];
+    char key[LOG_MAX_KEY_LEN + 1];
+
+    while (pos + sizeof(RecordHeader) <= payloadLen) {
+        RecordHeader eh;
+        _flash->read(base + pos, &eh, sizeof(eh));
+        if (eh.type != REC_TYPE_ENTRY || eh.keyLen > LOG_MAX_KEY_LEN) break;
+        uint32_t size = entrySize(eh.keyLen, eh.valLen);
+        _flash->read(base + pos + sizeof(RecordHeader), key, eh.keyLen);
+        if (isLive(key, eh.keyLen, base + pos)) {
+            // Entry as stored: header, key, value, padding
+            for (uint32_t done = 0; done < size; done += sizeof(buf)) {
+                uint32_t chunk = (size - done < sizeof(buf)) ? (size - done) : sizeof(buf);
+                _flash->read(base + pos + done, buf, chunk);
+                if (crc) *crc = crc32Update(*crc, buf, chunk);
+                if (w) w->put(buf, chunk);
+            }
+            if (w) {
+                key[eh.keyLen] = '\0';
+                recordWear(key, 0, 0, size + overhead); // Compaction copy: write amplification
+                overhead = 0;
+            }
+        }
+        pos += size;
+    }
+}
+
+bool LogPersistence::copyBatch(uint32_t base, uint16_t payloadLen, uint32_t liveLen) {
+    uint32_t ps = _flash->pageSize();
+    uint32_t size = recordSize(0, liveLen);
+    if (_headOffset + size > ps) return false;
+
+    // Entries are streamed twice (CRC, then write), like copyEntry()
+    RecordHeader hdr;
+    hdr.type = REC_TYPE_BATCH;
+    hdr.keyLen = 0;
+    hdr.valLen = (uint16_t)liveLen;
+    hdr.crc = crc32Update(0, &hdr, 4);
+    streamLiveEntries(base, payloadLen, &hdr.crc, nullptr);
+
+    uint32_t dst = _headPage * ps + _headOffset;
+    WordWriter w(_flash, dst);
+    w.put(&hdr, sizeof(hdr));
+    streamLiveEntries(base, payloadLen, nullptr, &w);
+    w.flush();
+    uint32_t commit = LOG_COMMIT_WORD;
+    w.put(&commit, sizeof(commit));
+    _headOffset += size;
+
+    if (!w.ok) return false;
+    indexBatch(dst, (uint16_t)liveLen);
+    return true;
+}
+
+bool LogPersistence::isLive(const char* key, size_t keyLen, uint32_t entryOffset) {
+    int idx = findEntry(key, keyLen, hashKey(key, keyLen));
+    return idx >= 0 && locToOffset(_index[idx].loc) == entryOffset;
+}
+
+bool LogPersistence::copyEntry(uint32_t entryOffset, const char* key, size_t keyLen) {
+    uint32_t ps = _flash->pageSize();
+    RecordHeader src;
+    _flash->read(entryOffset, &src, sizeof(src));
+
+    uint32_t size = recordSize(keyLen, src.valLen);
+    if (_headOffset + size > ps) return false;
+
+    // New standalone record with its own CRC. Value is streamed through a small
+    // buffer twice (CRC, then write) so this also works for unmapped flash.
+    RecordHeader hdr;
+    hdr.type = REC_TYPE_PUT;
+    hdr.keyLen = (uint8_t)keyLen;
+    hdr.valLen = src.valLen;
+    hdr.crc = crc32Update(0, &hdr, 4);
+    hdr.crc = crc32Update(hdr.crc, key, keyLen);
+
+    uint8_t buf[32];
+    uint32_t valOffset = entryOffset + sizeof(RecordHeader) + keyLen;
+    for (uint32_t pos = 0; pos < src.valLen; pos += sizeof(buf)) {
+        uint32_t chunk = (src.valLen - pos < sizeof(buf)) ? (src.valLen - pos) : sizeof(buf);
+        _flash->read(valOffset + pos, buf, chunk);
+        hdr.crc = crc32Update(hdr.crc, buf, chunk);
+    }
+
+    uint32_t dst = _headPage * ps + _headOffset;
+    WordWriter w(_flash, dst);
+    w.put(&hdr, sizeof(hdr));
+    w.put(key, keyLen);
+    for (uint32_t pos = 0; pos < src.valLen; pos += sizeof(buf)) {
+        uint32_t chunk = (src.valLen - pos < sizeof(buf)) ? (src.valLen - pos) : sizeof(buf);
+        _flash->read(valOffset + pos, buf, chunk);
+        w.put(buf, chunk);
+    }
+    w.flush();
+    uint32_t commit = LOG_COMMIT_WORD;
+    w.put(&commit, sizeof(commit));
+    _headOffset += size;
+    recordWear(key, 0, 0, size); // Compaction copy: pure write amplification of this key
+
+    if (!w.ok) return false;
+    indexUpsert(key, keyLen, dst);
+    return true;
+}
+
+void LogPersistence::recordWear(const char* key, uint32_t calls, uint32_t payload, uint32_t physical) {
+    // Every filled page costs one erase when it is compacted -> amortized share per byte
+    _wear.recordWrite(key, calls, payload, physical, (float)physical / _flash->pageSize());
+}
+
+// --- Record Helpers ---
+
+size_t LogPersistence::makeKey(const char* key, char* out) {
+    size_t nsLen = strlen(_namespace);
+    size_t keyLen = strlen(key);
+    if (nsLen + 1 + keyLen > LOG_MAX_KEY_LEN) {
+        keyLen = LOG_MAX_KEY_LEN - nsLen - 1;
+    }
+    memcpy(out, _namespace, nsLen);
+    out[nsLen] = '/';
+    memcpy(out + nsLen + 1, key, keyLen);
+    out[nsLen + 1 + keyLen] = '\0';
+    return nsLen + 1 + keyLen;
+}
+
+uint16_t LogPersistence::hashKey(const char* key, size_t len) {
+    // FNV-1a, folded to 16 bit
+    uint32_t h = 2166136261UL;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (uint8_t)key[i];
+        h *= 16777619UL;
+    }
+    return (uint16_t)(h ^ (h >> 16));
+}
+
+uint32_t LogPersistence::entrySize(size_t keyLen, size_t valLen) {
+    return sizeof(RecordHeader) + ((keyLen + valLen + 3) & ~3UL);
+}
+
+uint32_t LogPersistence::recordSize(size_t keyLen, size_t valLen) {
+    return entrySize(keyLen, valLen) + 4; // + commit word
+}
+
+uint32_t LogPersistence::locToOffset(uint16_t loc) const {
+    return (uint32_t)(loc >> 10) * _flash->pageSize() + (uint32_t)(loc & 0x3FF) * 4;
+}
+
+uint16_t LogPersistence::offsetToLoc(uint32_t offset) const {
+    uint32_t ps = _flash->pageSize();
+    return (uint16_t)(((offset / ps) << 10) | ((offset % ps) / 4));
+}
+
+LogPersistence::RecordState LogPersistence::readRecord(uint32_t offset, RecordHeader& hdr) {
+    _flash->read(offset, &hdr, sizeof(hdr));
+    if (hdr.type == REC_TYPE_ERASED) return REC_END;
+
+    uint32_t ps = _flash->pageSize();
+    uint32_t size = recordSize(hdr.keyLen, hdr.valLen);
+    if ((offset % ps) + size > ps || hdr.keyLen > LOG_MAX_KEY_LEN) {
+        // Corrupt header, nothing behind it can be trusted
+        return REC_END;
+    }
+
+    uint32_t commit;
+    _flash->read(offset + size - 4, &commit, 4);
+    if (commit != LOG_COMMIT_WORD) return REC_TORN;
+
+    // Verify CRC over header fields + key + value
+    uint32_t crc = crc32Update(0, &hdr, 4);
+    uint8_t buf[32];
+    uint32_t src = offset + sizeof(RecordHeader);
+    uint32_t remaining = hdr.keyLen + hdr.valLen;
+    while (remaining > 0) {
+        uint32_t chunk = (remaining < sizeof(buf)) ? remaining : sizeof(buf);
+        _flash->read(src, buf, chunk);
+        crc = crc32Update(crc, buf, chunk);
+        src += chunk;
+        remaining -= chunk;
+    }
+    return (crc == hdr.crc) ? REC_VALID : REC_TORN;
+}
+
+bool LogPersistence::recordKeyEquals(uint32_t offset, const char* key, size_t keyLen) {
+    RecordHeader hdr;
+    _flash->read(offset, &hdr, sizeof(hdr));
+    if (hdr.keyLen != keyLen) return false;
+
+    const uint8_t* mapped = _flash->mapped(offset + sizeof(RecordHeader));
+    if (mapped) return memcmp(mapped, key, keyLen) == 0;
+
+    char stored[LOG_MAX_KEY_LEN];
+    _flash->read(offset + sizeof(RecordHeader), stored, keyLen);
+    return memcmp(stored, key, keyLen) == 0;
+}
+
+int LogPersistence::findEntry(const char* key, size_t keyLen, uint16_t hash) {
+    // Cached slot: still valid if it holds the same key (swap-removes move entries)
+    uint8_t& cached = _cache[hash % LOG_CACHE_SLOTS];
+    if (cached < _indexCount && _index[cached].hash == hash &&
+        recordKeyEquals(locToOffset(_index[cached].loc), key, keyLen)) {
+        _cacheHits++;
+        return cached;
+    }
+
+    uint32_t start = cycleCount();
+    int found = -1;
+    for (int i = 0; i < _indexCount; i++) {
+        if (_index[i].hash == hash && recordKeyEquals(locToOffset(_index[i].loc), key, keyLen)) {
+            found = i;
+            break;
+        }
+    }
+    _missCycles += cycleCount() - start;
+    _cacheMisses++;
+    if (found >= 0) cached = (uint8_t)found;
+    return found;
+}
+
+uint32_t LogPersistence::getCacheSavedUs() const {
+    if (_cacheMisses == 0) return 0;
+    double meanCycles = (double)_missCycles / _cacheMisses;
+    return (uint32_t)(_cacheHits * meanCycles * 1.0e6 / CYCLE_COUNTER_HZ);
+}
+
+void LogPersistence::printCacheStats(Print& out) const {
+    uint32_t lookups = _cacheHits + _cacheMisses;
+    out.printf("  Store index: %lu lookups, %lu cache hits (%.1f%%), ~%lu us saved\n", (unsigned long)lookups,
+               (unsigned long)_cacheHits, lookups ? _cacheHits * 100.0f / lookups : 0.0f,
+               (unsigned long)getCacheSavedUs());
+}
+
+bool LogPersistence::lookup(const char* key, uint32_t& valOffset, uint16_t& valLen) {
+    if (!_mounted) return false;
+    char fullKey[LOG_MAX_KEY_LEN + 1];
+    size_t keyLen = makeKey(key, fullKey);
+
+    int idx = findEntry(fullKey, keyLen, hashKey(fullKey, keyLen));
+    if (idx < 0) return false;
+
+    uint32_t offset = locToOffset(_index[idx].loc);
+    RecordHeader hdr;
+    _flash->read(offset, &hdr, sizeof(hdr));
+    valOffset = offset + sizeof(RecordHeader) + hdr.keyLen;
+    valLen = hdr.valLen;
+    return true;
+}
+
+void LogPersistence::indexUpsert(const char* key, size_t keyLen, uint32_t recordOffset) {
+    uint16_t hash = hashKey(key, keyLen);
+    int idx = findEntry(key, keyLen, hash);
+    if (idx >= 0) {
+        _index[idx].loc = offsetToLoc(recordOffset);
+        return;
+    }
+    if (_indexCount >= LOG_INDEX_CAPACITY) {
+        Serial.println("Log: Index full!");
+        return;
+    }
+    _index[_indexCount].hash = hash;
+    _index[_indexCount].loc = offsetToLoc(recordOffset);
+    _indexCount++;
+}
+
+void LogPersistence::indexDropNamespace(const char* prefix, size_t prefixLen) {
+    int i = 0;
+    while (i < _indexCount) {
+        uint32_t offset = locToOffset(_index[i].loc);
+        RecordHeader hdr;
+        _flash->read(offset, &hdr, sizeof(hdr));
+
+        char key[LOG_MAX_KEY_LEN];
+        _flash->read(offset + sizeof(RecordHeader), key, hdr.keyLen);
+
+        if (hdr.keyLen >= prefixLen && memcmp(key, prefix, prefixLen) == 0) {
+            _index[i] = _index[--_indexCount]; // Swap-remove
+        } else {
+            i++;
+        }
+    }
+}
+
+void LogPersistence::indexDropPage(uint32_t page) {
+    int i = 0;
+    while (i < _indexCount) {
+        if ((uint32_t)(_index[i].loc >> 10) == page) {
+            _index[i] = _index[--_indexCount]; // Swap-remove
+        } else {
+            i++;
+        }
+    }
+}
+
+void LogPersistence::indexRemove(const char* key, size_t keyLen) {
+    int idx = findEntry(key, keyLen, hashKey(key, keyLen));
+    if (idx >= 0) {
+        _index[idx] = _index[--_indexCount];
+    }
+}
+
+void LogPersistence::indexBatch(uint32_t recordOffset, uint16_t payloadLen) {
+    uint32_t base = recordOffset + sizeof(RecordHeader);
+    uint32_t pos = 0;
+    char key[LOG_MAX_KEY_LEN + 1];
+
+    while (pos + sizeof(RecordHeader) <= payloadLen) {
+        RecordHeader eh;
+        _flash->read(base + pos, &eh, sizeof(eh));
+        if (eh.type != REC_TYPE_ENTRY || eh.keyLen > LOG_MAX_KEY_LEN) break;
+        _flash->read(base + pos + sizeof(RecordHeader), key, eh.keyLen);
+        indexUpsert(key, eh.keyLen, base + pos);
+        pos += entrySize(eh.keyLen, eh.valLen);
+    }
+}
+
+bool LogPersistence::valueEquals(uint32_t valOffset, const void* value, size_t len) {
+    const uint8_t* mapped = _flash->mapped(valOffset);
+    if (mapped) return memcmp(mapped, value, len) == 0;
+
+    uint8_t buf[32];
+    const uint8_t* p = (const uint8_t*)value;
+    while (len > 0) {
+        size_t chunk = (len < sizeof(buf)) ? len : sizeof(buf);
+        _flash->read(valOffset, buf, chunk);
+        if (memcmp(buf, p, chunk) != 0) return false;
+        valOffset += chunk;
+        p += chunk;
+        len -= chunk;
+    }
+    return true;
+}
+
+bool LogPersistence::writeRecord(uint32_t offset, uint8_t type, const char* key, size_t keyLen, const void* value, size_t valLen) {
+    RecordHeader hdr;
+    hdr.type = type;
+    hdr.keyLen = (uint8_t)keyLen;
+    hdr.valLen = (uint16_t)valLen;
+    hdr.crc = crc32Update(0, &hdr, 4);
+    hdr.crc = crc32Update(hdr.crc, key, keyLen);
+    hdr.crc = crc32Update(hdr.crc, value, valLen);
+
+    WordWriter w(_flash, offset);
+    w.put(&hdr, sizeof(hdr));
+    w.put(key, keyLen);
+    w.put(value, valLen);
+    w.flush();
+
+    // Commit word last: makes the record valid
+    uint32_t commit = LOG_COMMIT_WORD;
+    w.put(&commit, sizeof(commit));
+    return w.ok;
+}
+
+uint32_t LogPersistence::appendRecord(uint8_t type, const char* key, size_t keyLen, const void* value, size_t valLen) {
+    uint32_t ps = _flash->pageSize();
+    uint32_t size = recordSize(keyLen, valLen);
+    if (size > ps - sizeof(PageHeader) || valLen > 0xFFFF) {
+        Serial.printf("Log: Record too large (%lu bytes)\n", (unsigned long)size);
+        return UINT32_MAX;
+    }
+
+    // Roll over at most once per page; if the live data does not fit anywhere, give up
+    for (uint32_t attempt = 0; attempt < _flash->pageCount(); attempt++) {
+        if (_headOffset + size <= ps) {
+            uint32_t offset = _headPage * ps + _headOffset;
+            bool ok = writeRecord(offset, type, key, keyLen, value, valLen);
+            _headOffset += size; // Consumed even on failure (torn record is skipped on mount)
+            return ok ? offset : UINT32_MAX;
+        }
+        if (!rollover()) break;
+    }
+    Serial.println("Log: Flash log full!");
+    return UINT32_MAX;
+}
+
+// --- IPersistence ---
+
+void LogPersistence::begin(const char* namespaceName, bool readOnly) {
+    (void)readOnly; // Namespaces are key prefixes, nothing to open read-only
+    if (!_mounted) mount();
+    strncpy(_namespace, namespaceName, sizeof(_namespace) - 1);
+    _namespace[sizeof(_namespace) - 1] = '\0';
+}
+
+void LogPersistence::end() {
+    // Records are committed on every put, nothing to flush
+}
+
+void LogPersistence::clear() {
+    if (!_mounted) return;
+    char prefix[LOG_MAX_KEY_LEN + 1];
+    size_t len = makeKey("", prefix); // "namespace/"
+    if (_txnActive) unstagePrefix(prefix, len); // Otherwise the commit would restore them
+
+    if (appendRecord(REC_TYPE_CLEAR, prefix, len, nullptr, 0) != UINT32_MAX) {
+        recordWear(prefix, 1, 0, recordSize(len, 0));
+        indexDropNamespace(prefix, len);
+    }
+}
+
+void LogPersistence::remove(const char* key) {
+    if (!_mounted) return;
+    char fullKey[LOG_MAX_KEY_LEN + 1];
+    size_t keyLen = makeKey(key, fullKey);
+    if (_txnActive) unstage(fullKey, keyLen);
+
+    int idx = findEntry(fullKey, keyLen, hashKey(fullKey, keyLen));
+    if (idx < 0) return; // Nothing stored, no marker needed
+
+    if (appendRecord(REC_TYPE_REMOVE, fullKey, keyLen, nullptr, 0) != UINT32_MAX) {
+        recordWear(fullKey, 1, 0, recordSize(keyLen, 0));
+        indexRemove(fullKey, keyLen);
+    }
+}
+
+// --- Transactions ---
+
+void LogPersistence::beginTransaction() {
+    if (_txnActive) return; // Nested calls join the running transaction
+    _txnActive = true;
+    _txnOverflow = false;
+    _txnLen = 0;
+}
+
+bool LogPersistence::commit() {
+    if (!_txnActive) return true;
+    _txnActive = false;
+    if (_txnOverflow) {
+        // Writing part of it would break the all-or-nothing promise -> nothing at all
+        Serial.println("Log: Transaction too large, nothing written");
+        _txnOverflow = false;
+        _txnLen = 0;
+        return false;
+    }
+    if (_txnLen == 0) return true;
+
+    uint16_t len = _txnLen;
+    _txnLen = 0;
+
+    // One record, one CRC, one commit word for the whole batch
+    uint32_t offset = appendRecord(REC_TYPE_BATCH, "", 0, _txnBuf, len);
+    if (offset == UINT32_MAX) return false;
+    indexBatch(offset, len);
+
+    // Wear per entry; the batch header and commit word are charged to the first entry
+    uint32_t overhead = recordSize(0, len) - len;
+    char key[LOG_MAX_KEY_LEN + 1];
+    for (uint32_t pos = 0; pos < len; ) {
+        RecordHeader eh;
+        memcpy(&eh, _txnBuf + pos, sizeof(eh));
+        memcpy(key, _txnBuf + pos + sizeof(RecordHeader), eh.keyLen);
+        key[eh.keyLen] = '\0';
+        uint32_t size = entrySize(eh.keyLen, eh.valLen);
+        recordWear(key, 1, eh.valLen, size + overhead);
+        overhead = 0;
+        pos += size;
+    }
+    return true;
+}
+
+int LogPersistence::findStaged(const char* key, size_t keyLen) {
+    uint32_t pos = 0;
+    while (pos < _txnLen) {
+        RecordHeader eh;
+        memcpy(&eh, _txnBuf + pos, sizeof(eh));
+        if (eh.keyLen == keyLen && memcmp(_txnBuf + pos + sizeof(RecordHeader), key, keyLen) == 0) {
+            return (int)pos;
+        }
+        pos += entrySize(eh.keyLen, eh.valLen);
+    }
+    return -1;
+}
+
+void LogPersistence::unstage(const char* key, size_t keyLen) {
+    int pos = findStaged(key, keyLen);
+    if (pos < 0) return;
+
+    RecordHeader eh;
+    memcpy(&eh, _txnBuf + pos, sizeof(eh));
+    uint32_t size = entrySize(eh.keyLen, eh.valLen);
+    memmove(_txnBuf + pos, _txnBuf + pos + size, _txnLen - pos - size);
+    _txnLen -= size;
+}
+
+void LogPersistence::unstagePrefix(const char* prefix, size_t prefixLen) {
+    uint32_t pos = 0;
+    while (pos < _txnLen) {
+        RecordHeader eh;
+        memcpy(&eh, _txnBuf + pos, sizeof(eh));
+        uint32_t size = entrySize(eh.keyLen, eh.valLen);
+        if (eh.keyLen >= prefixLen && memcmp(_txnBuf + pos + sizeof(RecordHeader), prefix, prefixLen) == 0) {
+            memmove(_txnBuf + pos, _txnBuf + pos + size, _txnLen - pos - size);
+            _txnLen -= size;
+        } else {
+            pos += size;
+        }
+    }
+}
+
+bool LogPersistence::stage(const char* key, size_t keyLen, const void* value, size_t len) {
+    unstage(key, keyLen); // Last put of a key wins
+
+    uint32_t size = entrySize(keyLen, len);
+    if (_txnLen + size > sizeof(_txnBuf)) return false;
+
+    RecordHeader eh;
+    eh.type = REC_TYPE_ENTRY;
+    eh.keyLen = (uint8_t)keyLen;
+    eh.valLen = (uint16_t)len;
+    eh.crc = 0xFFFFFFFF; // Covered by the batch CRC
+
+    uint8_t* p = _txnBuf + _txnLen;
+    memcpy(p, &eh, sizeof(eh));
+    memcpy(p + sizeof(eh), key, keyLen);
+    memcpy(p + sizeof(eh) + keyLen, value, len);
+    memset(p + sizeof(eh) + keyLen + len, 0xFF, size - sizeof(eh) - keyLen - len);
+    _txnLen += size;
+    return true;
+}
+
+const uint8_t* LogPersistence::stagedValue(const char* key, uint16_t& valLen) {
+    if (!_txnActive || _txnLen == 0) return nullptr;
+    char fullKey[LOG_MAX_KEY_LEN + 1];
+    size_t keyLen = makeKey(key, fullKey);
+
+    int pos = findStaged(fullKey, keyLen);
+    if (pos < 0) return nullptr;
+
+    RecordHeader eh;
+    memcpy(&eh, _txnBuf + pos, sizeof(eh));
+    valLen = eh.valLen;
+    return _txnBuf + pos + sizeof(RecordHeader) + keyLen;
+}
+
+void LogPersistence::putBytes(const char* key, const void* value, size_t len) {
+    if (!_mounted) return;
+
+    char fullKey[LOG_MAX_KEY_LEN + 1];
+    size_t keyLen = makeKey(key, fullKey);
+
+    // Skip writes that would not change anything (saves flash wear)
+    uint32_t valOffset;
+    uint16_t valLen;
+    bool unchanged = lookup(key, valOffset, valLen) && valLen == len && valueEquals(valOffset, value, len);
+
+    if (_txnActive) {
+        if (unchanged) {
+            unstage(fullKey, keyLen); // Drop an earlier staged change of this key
+            return;
+        }
+        if (!stage(fullKey, keyLen, value, len)) {
+            Serial.printf("Log: Transaction buffer full at '%s'\n", fullKey);
+            _txnOverflow = true; // commit() fails
+        }
+        return;
+    }
+
+    if (unchanged) return;
+
+    // Refuse new keys if the index is full, otherwise they would vanish on the next mount
+    if (_indexCount >= LOG_INDEX_CAPACITY && findEntry(fullKey, keyLen, hashKey(fullKey, keyLen)) < 0) {
+        Serial.printf("Log: Index full, dropping '%s'\n", fullKey);
+        return;
+    }
+
+    uint32_t offset = appendRecord(REC_TYPE_PUT, fullKey, keyLen, value, len);
+    if (offset != UINT32_MAX) {
+        recordWear(fullKey, 1, len, recordSize(keyLen, len));
+        indexUpsert(fullKey, keyLen, offset);
+    }
+}
+
+size_t LogPersistence::getBytes(const char* key, void* buf, size_t maxLen) {
+    uint32_t valOffset;
+    uint16_t valLen;
+
+    const uint8_t* staged = stagedValue(key, valLen);
+    if (staged) {
+        size_t toCopy = (valLen < maxLen) ? valLen : maxLen;
+        memcpy(buf, staged, toCopy);
+        return toCopy;
+    }
+
+    if (!lookup(key, valOffset, valLen)) return 0;
+
+    size_t toRead = (valLen < maxLen) ? valLen : maxLen;
+    _flash->read(valOffset, buf, toRead);
+    return toRead;
+}
+
+size_t LogPersistence::getBytesLength(const char* key) {
+    uint32_t valOffset;
+    uint16_t valLen;
+    if (stagedValue(key, valLen)) return valLen;
+    if (!lookup(key, valOffset, valLen)) return 0;
+    return valLen;
+}
+
+template <typename T>
+T LogPersistence::readValue(const char* key, T defaultValue) {
+    uint32_t valOffset;
+    uint16_t valLen;
+    T value;
+
+    const uint8_t* staged = stagedValue(key, valLen);
+    if (staged) {
+        if (valLen != sizeof(T)) return defaultValue;
+        memcpy(&value, staged, sizeof(T));
+        return value;
+    }
+
+    if (!lookup(key, valOffset, valLen) || valLen != sizeof(T)) {
+        return defaultValue;
+    }
+    _flash->read(valOffset, &value, sizeof(T));
+    return value;
+}
+
+void LogPersistence::putInt(const char* key, int32_t value) {
+    putBytes(key, &value, sizeof(value));
+}
+
+int32_t LogPersistence::getInt(const char* key, int32_t defaultValue) {
+    return readValue(key, defaultValue);
+}
+
+void LogPersistence::putUInt(const char* key, uint32_t value) {
+    putBytes(key, &value, sizeof(value));
+}
+
+uint32_t LogPersistence::getUInt(const char* key, uint32_t defaultValue) {
+    return readValue(key, defaultValue);
+}
+
+void LogPersistence::putFloat(const char* key, float value) {
+    putBytes(key, &value, sizeof(value));
+}
+
+float LogPersistence::getFloat(const char* key, float defaultValue) {
+    return readValue(key, defaultValue);
+}
+
+void LogPersistence::putDouble(const char* key, double value) {
+    putBytes(key, &value, sizeof(value));
+}
+
+double LogPersistence::getDouble(const char* key, double defaultValue) {
+    return readValue(key, defaultValue);
+}
+
+void LogPersistence::putBool(const char* key, bool value) {
+    putBytes(key, &value, sizeof(value));
+}
+
+bool LogPersistence::getBool(const char* key, bool defaultValue) {
+    return readValue(key, defaultValue);
+}
+
+void LogPersistence::putUChar(const char* key, uint8_t value) {
+    putBytes(key, &value, sizeof(value));
+}
+
+uint8_t LogPersistence::getUChar(const char* key, uint8_t defaultValue) {
+    return readValue(key, defaultValue);
+}
@@ -0,0 +1,180 @@
+#ifndef LOG_PERSISTENCE_H
+#define LOG_PERSISTENCE_H
+
+#include "Persistence.h"
+#include "FlashDevice.h"
+
+#ifndef LOG_INDEX_CAPACITY
+#define LOG_INDEX_CAPACITY 96 // Max. number of live keys (all namespaces)
+#endif
+#ifndef LOG_TXN_BUFFER_SIZE
+#define LOG_TXN_BUFFER_SIZE 1536 // Staging buffer for one transaction
+#endif
+#ifndef LOG_CACHE_SLOTS
+#define LOG_CACHE_SLOTS 16    // Lookup cache: key hash -> index slot (direct mapped)
+#endif
+#define LOG_MAX_KEY_LEN 40    // "namespace/key"
+
+struct WordWriter; // LogPersistence.cpp
+
+/**
+ * Log-structured key/value store on raw flash pages.
+ *
+ * Every put appends one record ("namespace/key" + value) to the current head page.
+ * A compact RAM index (4 bytes per key) points to the newest record of each key.
+ * Pages are used as a ring; one page is always kept erased. When the head moves to
+ * the next page, the oldest page is compacted: its still-live records are copied to
+ * the new head and the page is erased (exactly one erase per filled page). Live entries
+ * of a batch are copied as one batch, so copies never need more room than the originals.
+ * If they still do not fit, the page is kept and the log reports full.
+ *
+ * Records are written header -> data -> commit word. A record without commit word
+ * (power cut) is skipped on the next mount.
+ *
+ * Transactions stage their puts in RAM and write them as a single batch record
+ * with one commit word, so a batch is applied completely or not at all.
+ *
+ * Values are read in place (memory-mapped flash), the cost of a get is the index
+ * search. A small cache remembers the index slot per key hash; a hit is verified
+ * against the slot's key, so moved or removed entries simply miss.
+ */
+class LogPersistence : public IPersistence {
+public:
+    LogPersistence(IFlashDevice* flash);
+
+    // Scan the log and build the index. Called by begin() on first use.
+    bool mount();
+    bool isMounted() const { return _mounted; }
+    bool wasFormatted() const { return _formatted; } // Log was empty/invalid and has been created fresh
+
+    void begin(const char* namespaceName, bool readOnly) override;
+    void end() override;
+    void clear() override;
+    void remove(const char* key) override;
+
+    void beginTransaction() override;
+    bool commit() override;
+    bool inTransaction() const { return _txnActive; }
+
+    void putInt(const char* key, int32_t value) override;
+    int32_t getInt(const char* key, int32_t defaultValue) override;
+
+    void putUInt(const char* key, uint32_t value) override;
+    uint32_t getUInt(const char* key, uint32_t defaultValue) override;
+
+    void putFloat(const char* key, float value) override;
+    float getFloat(const char* key, float defaultValue) override;
+
+    void putDouble(const char* key, double value) override;
+    double getDouble(const char* key, double defaultValue) override;
+
+    void putBool(const char* key, bool value) override;
+    bool getBool(const char* key, bool defaultValue) override;
+
+    void putUChar(const char* key, uint8_t value) override;
+    uint8_t getUChar(const char* key, uint8_t defaultValue) override;
+
+    void putBytes(const char* key, const void* value, size_t len) override;
+    size_t getBytes(const char* key, void* buf, size_t maxLen) override;
+    size_t getBytesLength(const char* key) override;
+
+    // Status
+    size_t getKeyCount() const { return _indexCount; }
+    uint32_t getHeadFreeBytes() const { return _flash->pageSize() - _headOffset; }
+    uint32_t getCompactionCount() const { return _compactions; }
+    uint32_t getCacheHits() const { return _cacheHits; }
+    uint32_t getCacheMisses() const { return _cacheMisses; }
+    uint32_t getCacheSavedUs() const; // Estimate: hits x mean cycles of a full search
+    void printCacheStats(Print& out) const;
+    const WearStats* getWearStats() const override { return &_wear; }
+
+private:
+    struct PageHeader {
+        uint32_t seq;   // Increments with every new head page
+        uint32_t magic; // Written after seq, so a valid magic implies a valid seq
+    };
+
+    struct RecordHeader {
+        uint8_t type;
+        uint8_t keyLen;
+        uint16_t valLen;
+        uint32_t crc; // Over type/keyLen/valLen + key + value
+    };
+
+    struct IndexEntry {
+        uint16_t hash; // Hash of "namespace/key"
+        uint16_t loc;  // Page (upper 6 bits) | word offset in page (lower 10 bits)
+    };
+
+    enum RecordState { REC_END, REC_VALID, REC_TORN };
+
+    IFlashDevice* _flash;
+    bool _mounted = false;
+    bool _formatted = false;
+    char _namespace[16];
+
+    IndexEntry _index[LOG_INDEX_CAPACITY];
+    uint16_t _indexCount = 0;
+    uint8_t _cache[LOG_CACHE_SLOTS]; // Index slot of the last key per hash bucket
+    uint32_t _cacheHits = 0;
+    uint32_t _cacheMisses = 0;
+    uint64_t _missCycles = 0;     // Spent searching the index on misses
+
+    uint32_t _headPage = 0;
+    uint32_t _headOffset = 0; // Byte offset of the next record within the head page
+    uint32_t _headSeq = 0;
+    uint32_t _compactions = 0;
+    WearStats _wear;
+
+    // Transaction staging (entries in on-flash batch entry format)
+    bool _txnActive = false;
+    uint8_t _txnBuf[LOG_TXN_BUFFER_SIZE];
+    uint16_t _txnLen = 0;
+    bool _txnOverflow = false; // A put did not fit -> commit() fails
+
+    void format();
+    void replayPage(uint32_t page);
+    bool rollover();
+    bool reclaimPage(uint32_t page);
+    bool compactPage(uint32_t page);
+    bool compactRecords(uint32_t page, bool copy, uint32_t& bytes);
+    uint32_t liveEntries(uint32_t base, uint16_t payloadLen, uint32_t* liveLen, uint32_t* first);
+    void streamLiveEntries(uint32_t base, uint16_t payloadLen, uint32_t* crc, WordWriter* w);
+    bool copyBatch(uint32_t base, uint16_t payloadLen, uint32_t liveLen);
+
+    size_t makeKey(const char* key, char* out);
+    static uint16_t hashKey(const char* key, size_t len);
+    static uint32_t entrySize(size_t keyLen, size_t valLen);
+    static uint32_t recordSize(size_t keyLen, size_t valLen);
+
+    uint32_t locToOffset(uint16_t loc) const;
+    uint16_t offsetToLoc(uint32_t offset) const;
+
+    RecordState readRecord(uint32_t offset, RecordHeader& hdr);
+    bool recordKeyEquals(uint32_t offset, const char* key, size_t keyLen);
+    int findEntry(const char* key, size_t keyLen, uint16_t hash);
+    bool lookup(const char* key, uint32_t& valOffset, uint16_t& valLen);
+    void indexUpsert(const char* key, size_t keyLen, uint32_t recordOffset);
+    void indexDropNamespace(const char* prefix, size_t prefixLen);
+    void indexRemove(const char* key, size_t keyLen);
+    void indexDropPage(uint32_t page);
+    void indexBatch(uint32_t recordOffset, uint16_t payloadLen);
+    bool isLive(const char* key, size_t keyLen, uint32_t entryOffset);
+    bool copyEntry(uint32_t entryOffset, const char* key, size_t keyLen);
+
+    int findStaged(const char* key, size_t keyLen);
+    void unstage(const char* key, size_t keyLen);
+    void unstagePrefix(const char* prefix, size_t prefixLen);
+    bool stage(const char* key, size_t keyLen, const void* value, size_t len);
+    const uint8_t* stagedValue(const char* key, uint16_t& valLen);
+
+    bool valueEquals(uint32_t valOffset, const void* value, size_t len);
+    uint32_t appendRecord(uint8_t type, const char* key, size_t keyLen, const void* value, size_t valLen);
+    void recordWear(const char* key, uint32_t calls, uint32_t payload, uint32_t physical);
+    bool writeRecord(uint32_t offset, uint8_t type, const char* key, size_t keyLen, const void* value, size_t valLen);
+
+    template <typename T>
+    T readValue(const char* key, T defaultValue);
+};
+
+#endif
@@ -0,0 +1,124 @@
+#ifdef ARDUINO_ARCH_NRF52 // Hardware only, excluded from host builds
+
+#include "NrfFlash.h"
+#include "config.h"
+#include <nrf_sdm.h>
+#include <nrf_soc.h>
+
+// Linker symbols: end of code and initialized data (copied from flash at boot)
+extern "C" uint32_t __etext;
+extern "C" uint32_t __data_start__;
+extern "C" uint32_t __data_end__;
+
+// Max wait for a SoftDevice scheduled flash operation (erase is ~85ms worst case)
+#define SD_FLASH_TIMEOUT_MS 200
+
+NrfFlash::NrfFlash(uint32_t baseAddress, uint32_t pages) {
+    _base = baseAddress;
+    _pages = pages;
+}
+
+bool NrfFlash::begin() {
+    // Safety: Never touch pages that belong to the firmware image
+    uint32_t imageEnd = (uint32_t)&__etext + ((uint32_t)&__data_end__ - (uint32_t)&__data_start__);
+    if (imageEnd > _base) {
+        Serial.printf("Flash: Region 0x%05X overlaps firmware (ends 0x%05X)! Disabled.\n", _base, imageEnd);
+        _ok = false;
+        return false;
+    }
+    // DFU stages the next image from DFU_BANK1_ADDR (config.h): one of this size must end below
+    uint32_t imageSize = imageEnd - APP_FLASH_ADDR;
+    if (DFU_BANK1_ADDR + imageSize > _base) {
+        Serial.printf("Flash: Region 0x%05X is erased by a DFU update of %lu bytes!\n", _base, (unsigned long)imageSize);
+    }
+    if ((_base % PAGE_SIZE) != 0) {
+        Serial.println("Flash: Region not page aligned! Disabled.");
+        _ok = false;
+        return false;
+    }
+    _ok = true;
+    return true;
+}
+
+bool NrfFlash::softDeviceEnabled() {
+    uint8_t enabled = 0;
+    sd_softdevice_is_enabled(&enabled);
+    return enabled != 0;
+}
+
+bool NrfFlash::read(uint32_t offset, void* buf, size_t len) {
+    if (!inRange(offset, len)) return false;
+    memcpy(buf, (const void*)(_base + offset), len);
+    return true;
+}
+
+bool NrfFlash::writeWord(uint32_t addr, uint32_t value) {
+    volatile uint32_t* dst = (volatile uint32_t*)addr;
+    if (value == 0xFFFFFFFF || *dst == value) return true; // Nothing to program
+
+    if (softDeviceEnabled()) {
+        // SoftDevice owns the NVMC. The operation is scheduled between radio events;
+        // we poll the mapped flash instead of waiting for the SoC event.
+        uint32_t err;
+        while ((err = sd_flash_write((uint32_t*)addr, &value, 1)) == NRF_ERROR_BUSY) {
+            delay(1);
+        }
+        if (err != NRF_SUCCESS) return false;
+
+        unsigned long start = millis();
+        while (*dst != value) {
+            if (millis() - start > SD_FLASH_TIMEOUT_MS) return false;
+            delay(1);
+        }
+        return true;
+    }
+
+    NRF_NVMC->CONFIG = NVMC_CONFIG_WEN_Wen;
+    while (NRF_NVMC->READY == NVMC_READY_READY_Busy) {}
+    *dst = value;
+    while (NRF_NVMC->READY == NVMC_READY_READY_Busy) {}
+    NRF_NVMC->CONFIG = NVMC_CONFIG_WEN_Ren;
+    return *dst == value;
+}
+
+bool NrfFlash::write(uint32_t offset, const void* data, size_t len) {
+    if (!inRange(offset, len)) return false;
+    if ((offset & 3) || (len & 3)) return false; // Word aligned only
+
+    const uint8_t* src = (const uint8_t*)data;
+    for (size_t i = 0; i < len; i += 4) {
+        uint32_t word;
+        memcpy(&word, src + i, 4);
+        if (!writeWord(_base + offset + i, word)) return false;
+    }
+    return true;
+}
+
+bool NrfFlash::erasePage(uint32_t page) {
+    if (!_ok || page >= _pages) return false;
+    uint32_t addr = _base + page * PAGE_SIZE;
+
+    if (softDeviceEnabled()) {
+        uint32_t err;
+        while ((err = sd_flash_page_erase(addr / PAGE_SIZE)) == NRF_ERROR_BUSY) {
+            delay(1);
+        }
+        if (err != NRF_SUCCESS) return false;
+
+        unsigned long start = millis();
+        while (!isErased(page * PAGE_SIZE, PAGE_SIZE)) {
+            if (millis() - start > SD_FLASH_TIMEOUT_MS) return false;
+            delay(1);
+        }
+        return true;
+    }
+
+    NRF_NVMC->CONFIG = NVMC_CONFIG_WEN_Een;
+    while (NRF_NVMC->READY == NVMC_READY_READY_Busy) {}
+    NRF_NVMC->ERASEPAGE = addr;
+    while (NRF_NVMC->READY == NVMC_READY_READY_Busy) {}
+    NRF_NVMC->CONFIG = NVMC_CONFIG_WEN_Ren;
+    return true;
+}
+
+#endif // ARDUINO_ARCH_NRF52
@@ -0,0 +1,36 @@
+#ifndef NRF_FLASH_H
+#define NRF_FLASH_H
+
+#include "FlashDevice.h"
+
+/**
+ * Raw internal flash pages of the nRF52840 (memory mapped, 4 KB pages).
+ * The region must lie outside the firmware image and outside InternalFS,
+ * see the Flash Layout section in config.h.
+ */
+class NrfFlash : public IFlashDevice {
+public:
+    NrfFlash(uint32_t baseAddress, uint32_t pages);
+
+    bool begin() override;
+
+    uint32_t pageSize() const override { return PAGE_SIZE; }
+    uint32_t pageCount() const override { return _pages; }
+    const uint8_t* mapped(uint32_t offset) const override { return (const uint8_t*)(_base + offset); }
+
+    bool read(uint32_t offset, void* buf, size_t len) override;
+    bool write(uint32_t offset, const void* data, size_t len) override;
+    bool erasePage(uint32_t page) override;
+
+private:
+    static const uint32_t PAGE_SIZE = 4096;
+    uint32_t _base;
+    uint32_t _pages;
+    bool _ok = false;
+
+    bool inRange(uint32_t offset, size_t len) const { return _ok && (offset + len) <= (_pages * PAGE_SIZE); }
+    bool softDeviceEnabled();
+    bool writeWord(uint32_t addr, uint32_t value);
+};
+
+#endif
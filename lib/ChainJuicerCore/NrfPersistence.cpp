@@ -1,24 +1,51 @@
+#ifdef ARDUINO_ARCH_NRF52 // Hardware only, excluded from host builds
+
 #include "NrfPersistence.h"
+#include "Crc32.h"
 #include <Adafruit_LittleFS.h>
 #include <InternalFileSystem.h>
 
 using namespace Adafruit_LittleFS_Namespace;
 
-// Helper to write simple types
-template <typename T>
-void writeValue(String path, T value) {
-    // FILE_WRITE truncates existing file or creates new one
+// Journal of the last transaction: [magic u32][len u16][entries][crc u32]
+#define TXN_JOURNAL_PATH "/.txn"
+#define TXN_JOURNAL_MAGIC 0x4E584A54 // "TJXN"
+
+static bool journalChecked = false;
+
+String NrfPersistence::getFilePath(const char* key) {
+    return "/" + _namespace + "/" + String(key);
+}
+
+void NrfPersistence::writeFile(const String& path, const void* value, size_t len) {
+    if (_txnActive) {
+        stage(path, value, len); // On overflow the whole transaction fails in commit()
+        return;
+    }
+
+    // FILE_WRITE opens for append on LittleFS -> remove first to replace the content
+    InternalFS.remove(path.c_str());
     File file = InternalFS.open(path.c_str(), FILE_WRITE);
     if (file) {
-        file.write((uint8_t*)&value, sizeof(T));
+        file.write((const uint8_t*)value, len);
         file.close();
+        recordWear(path.c_str(), len);
     }
 }
 
 // Helper to read simple types
 template <typename T>
-T readValue(String path, T defaultValue) {
+T NrfPersistence::readValue(const char* key, T defaultValue) {
     T value = defaultValue;
+    String path = getFilePath(key);
+
+    uint16_t stagedLen;
+    const uint8_t* staged = stagedValue(path, stagedLen);
+    if (staged) {
+        if (stagedLen == sizeof(T)) memcpy(&value, staged, sizeof(T));
+        return value;
+    }
+
     if (!InternalFS.exists(path.c_str())) {
         return defaultValue;
     }
@@ -33,13 +60,21 @@ T readValue(String path, T defaultValue) {
     return value;
 }
 
-String NrfPersistence::getFilePath(const char* key) {
-    return "/" + _namespace + "/" + String(key);
+void NrfPersistence::recordWear(const char* path, size_t len) {
+    _wear.recordWrite(path + 1, 1, len, NRF_FS_PAGES_PER_WRITE * NRF_FS_PAGE_SIZE, NRF_FS_PAGES_PER_WRITE);
 }
 
 void NrfPersistence::begin(const char* namespaceName, bool readOnly) {
+    (void)readOnly; // Directories are created on demand either way
     _namespace = String(namespaceName);
     InternalFS.begin();
+    _wear.setEraseBudget(NRF_FS_PAGES); // LittleFS levels wear across the whole partition
+
+    // Finish a transaction that was interrupted by a power cut (once per boot)
+    if (!journalChecked) {
+        journalChecked = true;
+        recoverJournal();
+    }
     
     String dirPath = "/" + _namespace;
     if (!InternalFS.exists(dirPath.c_str())) {
@@ -72,64 +107,217 @@ void NrfPersistence::clear() {
     dir.close();
 }
 
+void NrfPersistence::remove(const char* key) {
+    InternalFS.remove(getFilePath(key).c_str());
+}
+
+// --- Transactions ---
+// Puts are staged in RAM. commit() first writes all of them into one journal file,
+// then updates the individual files and finally removes the journal.
+// A power cut before the journal is complete leaves the old state (bad CRC),
+// a cut while updating the files is repaired by replaying the journal on boot.
+// A put that does not fit the staging buffer fails the commit: nothing is written.
+
+void NrfPersistence::beginTransaction() {
+    if (_txnActive) return;
+    _txnActive = true;
+    _txnOverflow = false;
+    _txnLen = 0;
+}
+
+bool NrfPersistence::commit() {
+    if (!_txnActive) return true;
+    _txnActive = false;
+    if (_txnOverflow) {
+        Serial.println("Persistence: Transaction too large, nothing written");
+        _txnOverflow = false;
+        _txnLen = 0;
+        return false;
+    }
+    if (_txnLen == 0) return true;
+
+    uint32_t magic = TXN_JOURNAL_MAGIC;
+    uint16_t len = _txnLen;
+    uint32_t crc = crc32(_txnBuf, len);
+
+    InternalFS.remove(TXN_JOURNAL_PATH);
+    File journal = InternalFS.open(TXN_JOURNAL_PATH, FILE_WRITE);
+    if (!journal) {
+        _txnLen = 0;
+        return false;
+    }
+    journal.write((const uint8_t*)&magic, sizeof(magic));
+    journal.write((const uint8_t*)&len, sizeof(len));
+    journal.write(_txnBuf, len);
+    journal.write((const uint8_t*)&crc, sizeof(crc));
+    journal.close();
+
+    applyEntries(_txnBuf, len);
+    InternalFS.remove(TXN_JOURNAL_PATH);
+    _txnLen = 0;
+    return true;
+}
+
+bool NrfPersistence::stage(const String& path, const void* value, size_t len) {
+    // Replace an earlier staged value of the same key
+    uint16_t oldLen;
+    const uint8_t* old = stagedValue(path, oldLen);
+    if (old) {
+        uint8_t* entry = (uint8_t*)old - path.length() - 3;
+        size_t entrySize = 3 + path.length() + oldLen;
+        memmove(entry, entry + entrySize, (_txnBuf + _txnLen) - (entry + entrySize));
+        _txnLen -= entrySize;
+    }
+
+    size_t entrySize = 3 + path.length() + len;
+    if (path.length() > 255 || _txnLen + entrySize > sizeof(_txnBuf)) {
+        Serial.println("Persistence: Transaction buffer full");
+        _txnOverflow = true;
+        return false;
+    }
+
+    uint8_t* p = _txnBuf + _txnLen;
+    uint16_t valLen = len;
+    p[0] = (uint8_t)path.length();
+    memcpy(p + 1, &valLen, 2);
+    memcpy(p + 3, path.c_str(), path.length());
+    memcpy(p + 3 + path.length(), value, len);
+    _txnLen += entrySize;
+    return true;
+}
+
+const uint8_t* NrfPersistence::stagedValue(const String& path, uint16_t& len) {
+    if (!_txnActive) return nullptr;
+
+    size_t pos = 0;
+    while (pos < _txnLen) {
+        uint8_t keyLen = _txnBuf[pos];
+        uint16_t valLen;
+        memcpy(&valLen, _txnBuf + pos + 1, 2);
+        if (keyLen == path.length() && memcmp(_txnBuf + pos + 3, path.c_str(), keyLen) == 0) {
+            len = valLen;
+            return _txnBuf + pos + 3 + keyLen;
+        }
+        pos += 3 + keyLen + valLen;
+    }
+    return nullptr;
+}
+
+void NrfPersistence::applyEntries(const uint8_t* data, size_t len) {
+    size_t pos = 0;
+    char path[64];
+
+    while (pos + 3 <= len) {
+        uint8_t keyLen = data[pos];
+        uint16_t valLen;
+        memcpy(&valLen, data + pos + 1, 2);
+        if (pos + 3 + keyLen + valLen > len || keyLen >= sizeof(path)) break;
+
+        memcpy(path, data + pos + 3, keyLen);
+        path[keyLen] = '\0';
+
+        InternalFS.remove(path);
+        File file = InternalFS.open(path, FILE_WRITE);
+        if (file) {
+            file.write(data + pos + 3 + keyLen, valLen);
+            file.close();
+            recordWear(path, valLen);
+        }
+        pos += 3 + keyLen + valLen;
+    }
+}
+
+void NrfPersistence::recoverJournal() {
+    if (!InternalFS.exists(TXN_JOURNAL_PATH)) return;
+
+    File journal = InternalFS.open(TXN_JOURNAL_PATH, FILE_READ);
+    bool valid = false;
+    uint32_t magic = 0;
+    uint16_t len = 0;
+    uint32_t crc = 0;
+
+    if (journal) {
+        if (journal.read((uint8_t*)&magic, sizeof(magic)) == sizeof(magic) && magic == TXN_JOURNAL_MAGIC &&
+            journal.read((uint8_t*)&len, sizeof(len)) == sizeof(len) && len <= sizeof(_txnBuf) &&
+            journal.read(_txnBuf, len) == len &&
+            journal.read((uint8_t*)&crc, sizeof(crc)) == sizeof(crc)) {
+            valid = (crc32(_txnBuf, len) == crc);
+        }
+        journal.close();
+    }
+
+    if (valid) {
+        Serial.println("Persistence: Replaying interrupted transaction");
+        applyEntries(_txnBuf, len);
+    }
+    InternalFS.remove(TXN_JOURNAL_PATH);
+}
+
+// --- Values ---
+
 void NrfPersistence::putInt(const char* key, int32_t value) {
-    writeValue(getFilePath(key), value);
+    writeFile(getFilePath(key), &value, sizeof(value));
 }
 
 int32_t NrfPersistence::getInt(const char* key, int32_t defaultValue) {
-    return readValue(getFilePath(key), defaultValue);
+    return readValue(key, defaultValue);
 }
 
 void NrfPersistence::putUInt(const char* key, uint32_t value) {
-    writeValue(getFilePath(key), value);
+    writeFile(getFilePath(key), &value, sizeof(value));
 }
 
 uint32_t NrfPersistence::getUInt(const char* key, uint32_t defaultValue) {
-    return readValue(getFilePath(key), defaultValue);
+    return readValue(key, defaultValue);
 }
 
 void NrfPersistence::putFloat(const char* key, float value) {
-    writeValue(getFilePath(key), value);
+    writeFile(getFilePath(key), &value, sizeof(value));
 }
 
 float NrfPersistence::getFloat(const char* key, float defaultValue) {
-    return readValue(getFilePath(key), defaultValue);
+    return readValue(key, defaultValue);
 }
 
 void NrfPersistence::putDouble(const char* key, double value) {
-    writeValue(getFilePath(key), value);
+    writeFile(getFilePath(key), &value, sizeof(value));
 }
 
 double NrfPersistence::getDouble(const char* key, double defaultValue) {
-    return readValue(getFilePath(key), defaultValue);
+    return readValue(key, defaultValue);
 }
 
 void NrfPersistence::putBool(const char* key, bool value) {
-    writeValue(getFilePath(key), value);
+    writeFile(getFilePath(key), &value, sizeof(value));
 }
 
 bool NrfPersistence::getBool(const char* key, bool defaultValue) {
-    return readValue(getFilePath(key), defaultValue);
+    return readValue(key, defaultValue);
 }
 
 void NrfPersistence::putUChar(const char* key, uint8_t value) {
-    writeValue(getFilePath(key), value);
+    writeFile(getFilePath(key), &value, sizeof(value));
 }
 
 uint8_t NrfPersistence::getUChar(const char* key, uint8_t defaultValue) {
-    return readValue(getFilePath(key), defaultValue);
+    return readValue(key, defaultValue);
 }
 
 void NrfPersistence::putBytes(const char* key, const void* value, size_t len) {
-    File file = InternalFS.open(getFilePath(key).c_str(), FILE_WRITE);
-    if (file) {
-        file.write((const uint8_t*)value, len);
-        file.close();
-    }
+    writeFile(getFilePath(key), value, len);
 }
 
 size_t NrfPersistence::getBytes(const char* key, void* buf, size_t maxLen) {
     String path = getFilePath(key);
+
+    uint16_t stagedLen;
+    const uint8_t* staged = stagedValue(path, stagedLen);
+    if (staged) {
+        size_t toCopy = (stagedLen < maxLen) ? stagedLen : maxLen;
+        memcpy(buf, staged, toCopy);
+        return toCopy;
+    }
+
     if (!InternalFS.exists(path.c_str())) {
         return 0;
     }
@@ -147,6 +335,12 @@ size_t NrfPersistence::getBytes(const char* key, void* buf, size_t maxLen) {
 
 size_t NrfPersistence::getBytesLength(const char* key) {
     String path = getFilePath(key);
+
+    uint16_t stagedLen;
+    if (stagedValue(path, stagedLen)) {
+        return stagedLen;
+    }
+
     if (!InternalFS.exists(path.c_str())) {
         return 0;
     }
@@ -159,3 +353,31 @@ size_t NrfPersistence::getBytesLength(const char* key) {
     }
     return len;
 }
+
+size_t NrfPersistence::exportTo(IPersistence* target) {
+    String dirPath = "/" + _namespace;
+    File dir = InternalFS.open(dirPath.c_str());
+    if (!dir || !dir.isDirectory()) {
+        return 0;
+    }
+
+    static uint8_t buf[1024]; // Largest value is the stats history blob
+    size_t count = 0;
+
+    File child = dir.openNextFile();
+    while (child) {
+        String childName = child.name();
+        size_t len = child.size();
+        if (len <= sizeof(buf)) {
+            len = child.read(buf, len);
+            target->putBytes(childName.c_str(), buf, len);
+            count++;
+        }
+        child.close();
+        child = dir.openNextFile();
+    }
+    dir.close();
+    return count;
+}
+
+#endif // ARDUINO_ARCH_NRF52
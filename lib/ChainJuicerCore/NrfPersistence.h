@@ -4,15 +4,47 @@
 #include "Persistence.h"
 #include <Arduino.h>
 
+#ifndef NRF_TXN_BUFFER_SIZE
+#define NRF_TXN_BUFFER_SIZE 1536 // Staging buffer for one transaction
+#endif
+
+// Wear estimate: InternalFS writes through a 4 KB page cache; replacing a small file
+// touches (at least) its data block and the directory block -> 2 page erase/program cycles.
+#define NRF_FS_PAGE_SIZE 4096
+#define NRF_FS_PAGES 7             // InternalFS 0xED000 - 0xF4000
+#define NRF_FS_PAGES_PER_WRITE 2
+
 class NrfPersistence : public IPersistence {
 private:
     String _namespace;
     String getFilePath(const char* key);
 
+    // Transaction staging: [keyLen u8][valLen u16][path][value] ...
+    bool _txnActive = false;
+    uint8_t _txnBuf[NRF_TXN_BUFFER_SIZE];
+    uint16_t _txnLen = 0;
+    bool _txnOverflow = false; // A put did not fit -> commit() fails
+
+    void writeFile(const String& path, const void* value, size_t len);
+    const uint8_t* stagedValue(const String& path, uint16_t& len);
+    bool stage(const String& path, const void* value, size_t len);
+    void applyEntries(const uint8_t* data, size_t len);
+    void recoverJournal();
+
+    template <typename T>
+    T readValue(const char* key, T defaultValue);
+
+    WearStats _wear;
+    void recordWear(const char* path, size_t len);
+
 public:
     void begin(const char* namespaceName, bool readOnly) override;
     void end() override;
     void clear() override;
+    void remove(const char* key) override;
+
+    void beginTransaction() override;
+    bool commit() override;
     
     void putInt(const char* key, int32_t value) override;
     int32_t getInt(const char* key, int32_t defaultValue) override;
@@ -35,6 +67,11 @@ public:
     void putBytes(const char* key, const void* value, size_t len) override;
     size_t getBytes(const char* key, void* buf, size_t maxLen) override;
     size_t getBytesLength(const char* key) override;
+
+    // Copy all keys of the active namespace into another store (migration helper)
+    size_t exportTo(IPersistence* target);
+
+    const WearStats* getWearStats() const override { return &_wear; }
 };
 
 #endif
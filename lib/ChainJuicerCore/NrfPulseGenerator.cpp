@@ -0,0 +1,138 @@
+#ifdef ARDUINO_ARCH_NRF52 // Hardware only, excluded from host builds
+
+#include "NrfPulseGenerator.h"
+#include <nrf_sdm.h>
+#include <nrf_soc.h>
+#include <nrf_gpio.h>
+
+#define PULSE_PPI_ALL ((1UL << PULSE_PPI_OFF) | (1UL << PULSE_PPI_COUNT) | (1UL << PULSE_PPI_ON) | (1UL << PULSE_PPI_STOP))
+
+bool NrfPulseGenerator::softDeviceEnabled() {
+    uint8_t enabled = 0;
+    sd_softdevice_is_enabled(&enabled);
+    return enabled != 0;
+}
+
+void NrfPulseGenerator::ppiAssign(uint8_t ch, volatile uint32_t* event, volatile uint32_t* task) {
+    if (softDeviceEnabled()) {
+        sd_ppi_channel_assign(ch, event, task);
+    } else {
+        NRF_PPI->CH[ch].EEP = (uint32_t)event;
+        NRF_PPI->CH[ch].TEP = (uint32_t)task;
+    }
+}
+
+void NrfPulseGenerator::ppiEnable(uint32_t mask) {
+    if (softDeviceEnabled()) sd_ppi_channel_enable_set(mask);
+    else NRF_PPI->CHENSET = mask;
+}
+
+void NrfPulseGenerator::ppiDisable(uint32_t mask) {
+    if (softDeviceEnabled()) sd_ppi_channel_enable_clr(mask);
+    else NRF_PPI->CHENCLR = mask;
+}
+
+bool NrfPulseGenerator::begin(uint8_t pin) {
+    _pin = g_ADigitalPinMap[pin];
+
+    // Output low, input buffer connected so busy() can read back the level after cancel()
+    nrf_gpio_pin_clear(_pin);
+    nrf_gpio_cfg(_pin, NRF_GPIO_PIN_DIR_OUTPUT, NRF_GPIO_PIN_INPUT_CONNECT, NRF_GPIO_PIN_NOPULL,
+                 NRF_GPIO_PIN_S0S1, NRF_GPIO_PIN_NOSENSE);
+
+    NRF_GPIOTE->CONFIG[PULSE_GPIOTE_CH] = (GPIOTE_CONFIG_MODE_Task << GPIOTE_CONFIG_MODE_Pos) |
+                                          ((_pin & 31) << GPIOTE_CONFIG_PSEL_Pos) |
+                                          ((_pin >> 5) << GPIOTE_CONFIG_PORT_Pos) |
+                                          (GPIOTE_CONFIG_POLARITY_Toggle << GPIOTE_CONFIG_POLARITY_Pos) |
+                                          (GPIOTE_CONFIG_OUTINIT_Low << GPIOTE_CONFIG_OUTINIT_Pos);
+
+    PULSE_TIMER->TASKS_STOP = 1;
+    PULSE_TIMER->MODE = TIMER_MODE_MODE_Timer;
+    PULSE_TIMER->BITMODE = TIMER_BITMODE_BITMODE_32Bit;
+    PULSE_TIMER->PRESCALER = 4; // 16 MHz / 2^4 = 1 MHz
+    PULSE_TIMER->INTENCLR = 0xFFFFFFFF;
+
+    PULSE_COUNTER->TASKS_STOP = 1;
+    PULSE_COUNTER->MODE = TIMER_MODE_MODE_LowPowerCounter;
+    PULSE_COUNTER->BITMODE = TIMER_BITMODE_BITMODE_16Bit;
+    PULSE_COUNTER->SHORTS = 0;
+    PULSE_COUNTER->INTENCLR = 0xFFFFFFFF;
+
+    ppiDisable(PULSE_PPI_ALL);
+    ppiAssign(PULSE_PPI_OFF, &PULSE_TIMER->EVENTS_COMPARE[0], &NRF_GPIOTE->TASKS_CLR[PULSE_GPIOTE_CH]);
+    ppiAssign(PULSE_PPI_COUNT, &PULSE_TIMER->EVENTS_COMPARE[0], &PULSE_COUNTER->TASKS_COUNT);
+    ppiAssign(PULSE_PPI_ON, &PULSE_TIMER->EVENTS_COMPARE[1], &NRF_GPIOTE->TASKS_SET[PULSE_GPIOTE_CH]);
+    ppiAssign(PULSE_PPI_STOP, &PULSE_COUNTER->EVENTS_COMPARE[0], &PULSE_TIMER->TASKS_STOP);
+
+    _ok = true;
+    _running = false;
+    return true;
+}
+
+bool NrfPulseGenerator::start(uint16_t count, uint32_t pulseUs, uint32_t pauseUs) {
+    if (!_ok || count == 0 || pulseUs == 0 || busy()) return false;
+
+    PULSE_TIMER->TASKS_STOP = 1;
+    PULSE_TIMER->TASKS_CLEAR = 1;
+    PULSE_TIMER->SHORTS = TIMER_SHORTS_COMPARE1_CLEAR_Msk;
+    PULSE_TIMER->CC[0] = pulseUs;
+    PULSE_TIMER->CC[1] = pulseUs + pauseUs;
+    PULSE_TIMER->EVENTS_COMPARE[0] = 0;
+    PULSE_TIMER->EVENTS_COMPARE[1] = 0;
+
+    PULSE_COUNTER->TASKS_CLEAR = 1;
+    PULSE_COUNTER->CC[0] = count;
+    PULSE_COUNTER->EVENTS_COMPARE[0] = 0;
+    PULSE_COUNTER->TASKS_START = 1;
+
+    ppiEnable(PULSE_PPI_ALL);
+    _cancelled = false;
+    _running = true;
+
+    // First edge by the CPU, everything after it by the timer
+    NRF_GPIOTE->TASKS_SET[PULSE_GPIOTE_CH] = 1;
+    PULSE_TIMER->TASKS_START = 1;
+    return true;
+}
+
+void NrfPulseGenerator::cancel() {
+    if (!_running) return;
+
+    // No new pulse, and the timer stops at the end of the running one instead of wrapping
+    ppiDisable(1UL << PULSE_PPI_ON);
+    PULSE_TIMER->SHORTS = TIMER_SHORTS_COMPARE0_STOP_Msk;
+    _cancelled = true;
+
+    // Pin low: in the pause (or a period restarted just before the channel was disabled,
+    // which has no pulse). Stop before its COMPARE[0] could count a pulse that never ran.
+    if (!nrf_gpio_pin_read(_pin)) PULSE_TIMER->TASKS_STOP = 1;
+}
+
+void NrfPulseGenerator::stop() {
+    ppiDisable(PULSE_PPI_ALL);
+    PULSE_TIMER->TASKS_STOP = 1;
+    NRF_GPIOTE->TASKS_CLR[PULSE_GPIOTE_CH] = 1;
+    PULSE_COUNTER->TASKS_STOP = 1;
+    _running = false;
+}
+
+uint16_t NrfPulseGenerator::completed() {
+    PULSE_COUNTER->TASKS_CAPTURE[1] = 1;
+    return (uint16_t)PULSE_COUNTER->CC[1];
+}
+
+bool NrfPulseGenerator::busy() {
+    if (!_running) return false;
+
+    bool done = PULSE_COUNTER->EVENTS_COMPARE[0] != 0;
+    if (_cancelled && !nrf_gpio_pin_read(_pin)) done = true; // Last pulse has ended
+    if (!done) return true;
+
+    ppiDisable(PULSE_PPI_ALL);
+    PULSE_TIMER->TASKS_STOP = 1;
+    PULSE_COUNTER->TASKS_STOP = 1;
+    _running = false;
+    return false;
+}
+
+#endif // ARDUINO_ARCH_NRF52
@@ -0,0 +1,46 @@
+#ifndef NRF_PULSE_GENERATOR_H
+#define NRF_PULSE_GENERATOR_H
+
+#include "PulseGenerator.h"
+
+// Peripherals owned by the pump (not used by the core, SoftDevice or other libraries here)
+#define PULSE_TIMER NRF_TIMER3       // 1 MHz, CC[0] = pulse end, CC[1] = period (clears)
+#define PULSE_COUNTER NRF_TIMER4     // Counts finished pulses, CC[0] = train length
+#define PULSE_GPIOTE_CH 7            // attachInterrupt() allocates GPIOTE channels from 0
+#define PULSE_PPI_OFF 8              // TIMER CC[0] -> pin low
+#define PULSE_PPI_COUNT 9            // TIMER CC[0] -> COUNTER count
+#define PULSE_PPI_ON 10              // TIMER CC[1] -> pin high
+#define PULSE_PPI_STOP 11            // COUNTER CC[0] -> TIMER stop
+
+/**
+ * Pump pulse train in hardware (nRF52840): TIMER3 compare events drive the pin through
+ * PPI and a GPIOTE task channel, TIMER4 counts the finished pulses and stops TIMER3
+ * after the last one. Edges are placed with 1 us resolution (HFCLK accuracy) regardless
+ * of interrupts, SoftDevice activity, flash writes or blocking radio calls.
+ * Completion is the COUNTER COMPARE[0] event, polled by busy(); no interrupt is used.
+ * PPI is a restricted peripheral while the SoftDevice runs, so channels go through sd_ppi_*.
+ */
+class NrfPulseGenerator : public IPulseGenerator {
+public:
+    bool begin(uint8_t pin) override;
+    bool start(uint16_t count, uint32_t pulseUs, uint32_t pauseUs) override;
+    void cancel() override;
+    void stop() override;
+    uint16_t completed() override;
+    bool busy() override;
+
+    // PPI access with or without SoftDevice (also used by NrfPwmPulseGenerator)
+    static void ppiAssign(uint8_t ch, volatile uint32_t* event, volatile uint32_t* task);
+    static void ppiEnable(uint32_t mask);
+    static void ppiDisable(uint32_t mask);
+
+private:
+    uint8_t _pin = 0;
+    bool _ok = false;
+    bool _running = false;
+    bool _cancelled = false;
+
+    static bool softDeviceEnabled();
+};
+
+#endif
@@ -0,0 +1,155 @@
+#ifdef ARDUINO_ARCH_NRF52 // Hardware only, excluded from host builds
+
+#include "NrfPwmPulseGenerator.h"
+#include "config.h"
+#include <nrf_gpio.h>
+
+#define PWM_PERIODS_PER_MS (PUMP_PWM_FREQ / 1000)
+#define PWM_PULSE_PPI_ALL ((1UL << PWM_PULSE_PPI_COUNT) | (1UL << PWM_PULSE_PPI_CLEAR) | (1UL << PWM_PULSE_PPI_CANCEL))
+
+static_assert(PUMP_PWM_FREQ % 1000 == 0 && PUMP_PWM_FREQ >= 1000, "PWM sequence steps are whole PWM periods per ms");
+static_assert(16000000 / PUMP_PWM_FREQ <= 32767, "COUNTERTOP is 15 bits");
+
+bool NrfPwmPulseGenerator::begin(uint8_t pin) {
+    _pin = g_ADigitalPinMap[pin];
+    nrf_gpio_pin_clear(_pin);
+    nrf_gpio_cfg_output(_pin); // Level while the PWM is disabled
+
+    _top = 16000000 / PUMP_PWM_FREQ;
+    PUMP_PWM->ENABLE = 0;
+    PUMP_PWM->PSEL.OUT[0] = _pin;
+    PUMP_PWM->PSEL.OUT[1] = 0xFFFFFFFF;
+    PUMP_PWM->PSEL.OUT[2] = 0xFFFFFFFF;
+    PUMP_PWM->PSEL.OUT[3] = 0xFFFFFFFF;
+    PUMP_PWM->MODE = PWM_MODE_UPDOWN_Up;
+    PUMP_PWM->PRESCALER = PWM_PRESCALER_PRESCALER_DIV_1;
+    PUMP_PWM->COUNTERTOP = _top;
+    PUMP_PWM->DECODER = (PWM_DECODER_LOAD_Common << PWM_DECODER_LOAD_Pos) |
+                        (PWM_DECODER_MODE_RefreshCount << PWM_DECODER_MODE_Pos);
+    PUMP_PWM->INTENCLR = 0xFFFFFFFF;
+    PUMP_PWM->SHORTS = PWM_SHORTS_LOOPSDONE_STOP_Msk;
+
+    PULSE_TIMER->TASKS_STOP = 1;
+    PULSE_TIMER->MODE = TIMER_MODE_MODE_Timer;
+    PULSE_TIMER->BITMODE = TIMER_BITMODE_BITMODE_32Bit;
+    PULSE_TIMER->PRESCALER = 4; // 1 MHz
+    PULSE_TIMER->SHORTS = 0;
+    PULSE_TIMER->INTENCLR = 0xFFFFFFFF;
+
+    PULSE_COUNTER->TASKS_STOP = 1;
+    PULSE_COUNTER->MODE = TIMER_MODE_MODE_LowPowerCounter;
+    PULSE_COUNTER->BITMODE = TIMER_BITMODE_BITMODE_16Bit;
+    PULSE_COUNTER->SHORTS = 0;
+    PULSE_COUNTER->INTENCLR = 0xFFFFFFFF;
+
+    NrfPulseGenerator::ppiDisable(PWM_PULSE_PPI_ALL);
+    NrfPulseGenerator::ppiAssign(PWM_PULSE_PPI_COUNT, &PUMP_PWM->EVENTS_SEQEND[0], &PULSE_COUNTER->TASKS_COUNT);
+    NrfPulseGenerator::ppiAssign(PWM_PULSE_PPI_CLEAR, &PUMP_PWM->EVENTS_SEQSTARTED[0], &PULSE_TIMER->TASKS_CLEAR);
+    NrfPulseGenerator::ppiAssign(PWM_PULSE_PPI_CANCEL, &PUMP_PWM->EVENTS_SEQEND[0], &PUMP_PWM->TASKS_STOP);
+
+    _ok = true;
+    _running = false;
+    return true;
+}
+
+bool NrfPwmPulseGenerator::start(uint16_t count, uint32_t pulseUs, uint32_t pauseUs) {
+    if (!_ok || count == 0 || pulseUs == 0 || busy()) return false;
+
+    // Sequence 0: one duty value per step, the last one switches off
+    uint32_t widthMs = (pulseUs + 500) / 1000;
+    if (widthMs == 0) widthMs = 1;
+    uint32_t stepMs = (widthMs + PWM_SEQ_MAX - 1) / PWM_SEQ_MAX;
+    uint32_t steps = widthMs / stepMs;
+    uint32_t upMs = _rampUpUs / 1000;
+    uint32_t downMs = _rampDownUs / 1000;
+
+    for (uint32_t i = 0; i < steps; i++) {
+        uint32_t t = i * stepMs;               // Since the pulse start
+        uint32_t left = widthMs - t;           // Until the pulse end
+        uint32_t duty = 255;
+        if (t < upMs) duty = PWM_RAMP_START_DUTY + (255 - PWM_RAMP_START_DUTY) * t / upMs;
+        if (left <= downMs) {
+            uint32_t down = PWM_RAMP_START_DUTY + (255 - PWM_RAMP_START_DUTY) * (left - stepMs) / downMs;
+            if (down < duty) duty = down;
+        }
+        _seq[i] = dutyValue(duty);
+    }
+    _seq[steps] = dutyValue(0);
+    _pulseUs = steps * stepMs * 1000;
+
+    // Pulse + pause in PWM periods: sequence 0 (steps + off value), its end delay, sequence 1
+    uint32_t stepPeriods = stepMs * PWM_PERIODS_PER_MS;
+    uint32_t periods = (_pulseUs + pauseUs) / 1000 * PWM_PERIODS_PER_MS;
+    uint32_t played = (steps + 1) * stepPeriods + 1;
+    uint32_t endDelay = periods > played ? periods - played : 0;
+
+    PUMP_PWM->ENABLE = 1;
+    PUMP_PWM->SEQ[0].PTR = (uint32_t)_seq;
+    PUMP_PWM->SEQ[0].CNT = steps + 1;
+    PUMP_PWM->SEQ[0].REFRESH = stepPeriods - 1;
+    PUMP_PWM->SEQ[0].ENDDELAY = endDelay;
+    PUMP_PWM->SEQ[1].PTR = (uint32_t)&_off;
+    PUMP_PWM->SEQ[1].CNT = 1;
+    PUMP_PWM->SEQ[1].REFRESH = 0;
+    PUMP_PWM->SEQ[1].ENDDELAY = 0;
+    PUMP_PWM->LOOP = count;
+    PUMP_PWM->EVENTS_STOPPED = 0;
+    PUMP_PWM->EVENTS_LOOPSDONE = 0;
+
+    PULSE_COUNTER->TASKS_CLEAR = 1;
+    PULSE_COUNTER->TASKS_START = 1;
+    PULSE_TIMER->TASKS_CLEAR = 1;
+    PULSE_TIMER->TASKS_START = 1;
+
+    NrfPulseGenerator::ppiEnable((1UL << PWM_PULSE_PPI_COUNT) | (1UL << PWM_PULSE_PPI_CLEAR));
+    _running = true;
+    PUMP_PWM->TASKS_SEQSTART[0] = 1;
+    return true;
+}
+
+uint32_t NrfPwmPulseGenerator::timeIntoPulseUs() {
+    PULSE_TIMER->TASKS_CAPTURE[0] = 1;
+    return PULSE_TIMER->CC[0];
+}
+
+void NrfPwmPulseGenerator::cancel() {
+    if (!_running) return;
+
+    // SEQSTARTED/SEQEND come within a PWM period of the edges: keep two periods away
+    const uint32_t marginUs = 2 * 1000000 / PUMP_PWM_FREQ;
+    uint32_t t = timeIntoPulseUs();
+    if (t + marginUs < _pulseUs) {
+        // Playing a pulse: stop as its off value is loaded
+        NrfPulseGenerator::ppiEnable(1UL << PWM_PULSE_PPI_CANCEL);
+        return;
+    }
+    while (t < _pulseUs + marginUs) t = timeIntoPulseUs(); // At most ~2 x margin
+    PUMP_PWM->TASKS_STOP = 1; // In the pause, output is off
+}
+
+void NrfPwmPulseGenerator::stop() {
+    NrfPulseGenerator::ppiDisable(PWM_PULSE_PPI_ALL);
+    PUMP_PWM->TASKS_STOP = 1;
+    PUMP_PWM->ENABLE = 0; // Pin back to GPIO (low) at once, not at the end of the PWM period
+    PULSE_TIMER->TASKS_STOP = 1;
+    PULSE_COUNTER->TASKS_STOP = 1;
+    _running = false;
+}
+
+uint16_t NrfPwmPulseGenerator::completed() {
+    PULSE_COUNTER->TASKS_CAPTURE[1] = 1;
+    return (uint16_t)PULSE_COUNTER->CC[1];
+}
+
+bool NrfPwmPulseGenerator::busy() {
+    if (!_running) return false;
+    if (!PUMP_PWM->EVENTS_STOPPED) return true;
+
+    NrfPulseGenerator::ppiDisable(PWM_PULSE_PPI_ALL);
+    PULSE_TIMER->TASKS_STOP = 1;
+    PULSE_COUNTER->TASKS_STOP = 1;
+    _running = false;
+    return false;
+}
+
+#endif // ARDUINO_ARCH_NRF52
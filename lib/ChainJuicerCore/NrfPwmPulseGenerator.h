@@ -0,0 +1,47 @@
+#ifndef NRF_PWM_PULSE_GENERATOR_H
+#define NRF_PWM_PULSE_GENERATOR_H
+
+#include "NrfPulseGenerator.h"
+
+#define PUMP_PWM NRF_PWM3            // NeoPixel and analogWrite() take PWM0-2 / whatever is not enabled
+#define PWM_SEQ_MAX 256              // Duty values per pulse (1 ms each, coarser for pulses > 255 ms)
+#define PWM_RAMP_START_DUTY 130      // Ramps start and stop at ~50% to prevent whining
+#define PWM_PULSE_PPI_COUNT 12       // SEQEND[0] -> PULSE_COUNTER count
+#define PWM_PULSE_PPI_CLEAR 13       // SEQSTARTED[0] -> PULSE_TIMER clear (time into the pulse)
+#define PWM_PULSE_PPI_CANCEL 14      // SEQEND[0] -> PWM stop, only after cancel()
+
+/**
+ * Pump pulse train on the nRF52840 PWM peripheral (PUMP_USE_PWM). Each pulse is one
+ * precomputed duty sequence in RAM: ramp up, hold at full duty, ramp down, off. EasyDMA
+ * plays it (sequence 0, the pause is its end delay), sequence 1 is one off period, and
+ * LOOP repeats both for the whole train. The CPU touches nothing until the train is done.
+ * Finished pulses are counted by PULSE_COUNTER through PPI, like NrfPulseGenerator (only
+ * one of the two is used). PULSE_TIMER runs free and is cleared at every pulse start, so
+ * cancel() knows whether a pulse is playing.
+ */
+class NrfPwmPulseGenerator : public IPulseGenerator {
+public:
+    bool begin(uint8_t pin) override;
+    void setRamp(uint32_t upUs, uint32_t downUs) override { _rampUpUs = upUs; _rampDownUs = downUs; }
+    bool start(uint16_t count, uint32_t pulseUs, uint32_t pauseUs) override;
+    void cancel() override;
+    void stop() override;
+    uint16_t completed() override;
+    bool busy() override;
+
+private:
+    uint16_t _seq[PWM_SEQ_MAX + 1]; // + the off value
+    uint16_t _off = 0x8000;         // Sequence 1: duty 0
+    uint16_t _top = 0;
+    uint32_t _rampUpUs = 0;
+    uint32_t _rampDownUs = 0;
+    uint32_t _pulseUs = 0;          // Width as played
+    uint8_t _pin = 0;
+    bool _ok = false;
+    bool _running = false;
+
+    uint16_t dutyValue(uint32_t duty255) const { return (uint16_t)((duty255 * _top) / 255) | 0x8000; } // High until compare
+    uint32_t timeIntoPulseUs();
+};
+
+#endif
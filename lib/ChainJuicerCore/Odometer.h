@@ -0,0 +1,41 @@
+#ifndef ODOMETER_H
+#define ODOMETER_H
+
+#include <Arduino.h>
+
+/**
+ * Distance counter in whole millimetres (uint64_t) plus a float remainder below 1 mm.
+ * add() is single precision and integer only, so the per-fix path does no soft-float
+ * double math on the Cortex-M4F. The remainder carries the sub-millimetre part of
+ * every hop, so truncation does not add up with the number of fixes; what remains is
+ * the float rounding of each hop (a few cm over 200,000 km of 1 Hz fixes,
+ * see ride_replay --odometer).
+ */
+class Odometer {
+public:
+    void add(float km) {
+        if (!(km > 0.0f)) return; // Also rejects NaN
+        float mm = km * 1.0e6f + _fracMm;
+        if (mm < 4.0e9f) {
+            uint32_t whole = (uint32_t)mm;
+            _fracMm = mm - (float)whole;
+            _mm += whole;
+        } else {
+            _mm += (uint64_t)mm; // Jump > 4000 km, sub-mm part is irrelevant
+            _fracMm = 0.0f;
+        }
+    }
+
+    uint64_t mm() const { return _mm; }
+    void setMm(uint64_t mm) { _mm = mm; _fracMm = 0.0f; }
+
+    // Display and storage only (double math)
+    double km() const { return _mm * 1.0e-6; }
+    void setKm(double km) { setMm(km > 0.0 ? (uint64_t)(km * 1.0e6 + 0.5) : 0); }
+
+private:
+    uint64_t _mm = 0;
+    float _fracMm = 0.0f;
+};
+
+#endif
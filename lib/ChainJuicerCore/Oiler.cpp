@@ -1,37 +1,139 @@
 #include "Oiler.h"
 #include "WebConsole.h"
-#include <OneWire.h>
-#include <DallasTemperature.h>
+#include "Crc32.h"
+#include "ConfigStore.h"
+#include "ParamRegistry.h"
+#include "ViscosityTable.h"
+
+// History layout of firmware <= v0.2.1 (seconds as double), converted on load.
+// Those builds had the 5 ranges of RANGE_PROFILE_ALPINE.
+#define LEGACY_NUM_RANGES 5
+struct LegacyStatsHistory {
+    uint8_t head;
+    uint8_t count;
+    int8_t oilingRange[20];
+    double timeInRanges[20][LEGACY_NUM_RANGES];
+};
+
+// Range table the stored per-range stats belong to; none stored = 5-range firmware
+static constexpr uint32_t rangeLayout = rangeLayoutId<RangeTable>();
+static constexpr uint32_t legacyRangeLayout = rangeLayoutId<RangeProfile<RANGE_PROFILE_ALPINE> >();
+static_assert(rangeLayout != 0 && legacyRangeLayout != 0, "0 marks a store without range layout id");
+
+// config.h limits as float: comparing a float with a double constant promotes the
+// comparison to soft-float double on the Cortex-M4F (single-precision FPU only)
+#define MIN_SPEED_F ((float)MIN_SPEED_KMH)
+#define MIN_ODOMETER_SPEED_F ((float)MIN_ODOMETER_SPEED_KMH)
+#define MAX_PLAUSIBLE_SPEED_F ((float)MAX_SPEED_KMH + 50.0f)
+
+static uint16_t saturateSeconds(double seconds) {
+    if (seconds <= 0.0) return 0;
+    if (seconds >= 65535.0) return 65535;
+    return (uint16_t)(seconds + 0.5);
+}
+
+// Range bounds are fixed per build (RANGE_PROFILE, only intervals and pulses are configurable)
+static constexpr const float* rangeBounds = RangeTable::bounds;
+
+// Oiler settings: one line per value (legacy key, default, valid range).
+static constexpr const float* rangeIntervalDefaults = RangeTable::intervalKm;
+static constexpr ParamDesc oilerParams[] = {
+    PARAM_ARRAY_DEFS(PARAM_F32, OilerSettings, intervalKm, "r%u_km", rangeIntervalDefaults, 0.1, PARAM_UNLIMITED),
+    PARAM_ARRAY(PARAM_I32, OilerSettings, pulses, "r%u_p", 2, 1, PARAM_UNLIMITED),
+    PARAM(PARAM_F32, OilerSettings, basePulse25, "tc_pulse", PULSE_DURATION_MS, 0, PARAM_UNLIMITED),
+    PARAM(PARAM_F32, OilerSettings, basePause25, "tc_pause", PAUSE_DURATION_MS, 0, PARAM_UNLIMITED),
+    PARAM(PARAM_I32, OilerSettings, oilType, "tc_oil", Oiler::OIL_NORMAL, Oiler::OIL_THIN, Oiler::OIL_THICK),
+    PARAM(PARAM_U8, OilerSettings, ledBrightnessDim, "led_dim", LED_BRIGHTNESS_DIM, 2, 202),
+    PARAM(PARAM_U8, OilerSettings, ledBrightnessHigh, "led_high", LED_BRIGHTNESS_HIGH, 2, 202),
+    PARAM(PARAM_BOOL, OilerSettings, nightModeEnabled, "night_en", true, 0, 1),
+    PARAM(PARAM_I32, OilerSettings, nightStartHour, "night_start", 20, 0, 23),
+    PARAM(PARAM_I32, OilerSettings, nightEndHour, "night_end", 6, 0, 23),
+    PARAM(PARAM_U8, OilerSettings, nightBrightness, "night_bri", 13, 2, 202),
+    PARAM(PARAM_U8, OilerSettings, nightBrightnessHigh, "night_bri_h", 64, 2, 202),
+    PARAM(PARAM_BOOL, OilerSettings, emergencyModeForced, "emerg_force", false, 0, 1),
+    PARAM(PARAM_I32, OilerSettings, offroadIntervalMin, "off_int", OFFROAD_INTERVAL_MIN_DEFAULT, 0, PARAM_UNLIMITED),
+    PARAM(PARAM_F32, OilerSettings, startupDelayMeters, "start_dly_m", STARTUP_DELAY_METERS_DEFAULT, 0, PARAM_UNLIMITED),
+    PARAM(PARAM_I32, OilerSettings, flushConfigEvents, "tb_evt", FLUSH_DEFAULT_EVENTS, 0, PARAM_UNLIMITED),
+    PARAM(PARAM_I32, OilerSettings, flushConfigPulses, "tb_pls", FLUSH_DEFAULT_PULSES, 0, PARAM_UNLIMITED),
+    PARAM(PARAM_I32, OilerSettings, flushConfigIntervalSec, "tb_int", FLUSH_DEFAULT_INTERVAL_SEC, 0, PARAM_UNLIMITED),
+    PARAM(PARAM_BOOL, OilerSettings, tankMonitorEnabled, "tank_en", true, 0, 1),
+    PARAM(PARAM_F32, OilerSettings, tankCapacityMl, "tank_cap", 100.0, 1, PARAM_UNLIMITED),
+    PARAM(PARAM_I32, OilerSettings, dropsPerMl, "drop_ml", 50, 1, PARAM_UNLIMITED),
+    PARAM(PARAM_I32, OilerSettings, dropsPerPulse, "drop_pls", 1, 0, PARAM_UNLIMITED),
+    PARAM(PARAM_I32, OilerSettings, tankWarningThresholdPercent, "tank_warn", 10, 0, 100)
+};
+static constexpr ParamTable oilerParamTable = PARAM_TABLE("oiler", oilerParams);
+
+// paramDiff() bit of the intervals: setParam()/saveConfig() rebuild the LUT when it is set
+static constexpr int OILER_PARAM_INTERVAL_KM = 0;
+static constexpr uint32_t OILER_PARAM_INTERVAL_KM_MASK = 1UL << OILER_PARAM_INTERVAL_KM;
+static_assert(oilerParams[OILER_PARAM_INTERVAL_KM].offset == offsetof(OilerSettings, intervalKm),
+              "OILER_PARAM_INTERVAL_KM must index the intervalKm entry of oilerParams");
+
+// Speed lookup table. Single-expression constexpr functions (C++11), so the compiler
+// generates the table of the default profile into flash; rebuildLUT() runs the same
+// functions on configured intervals.
+static constexpr float lutAnchorSpeed(int i) {
+    // Center of each range. The last one is open-ended: start + 10 km/h to avoid stretching
+    return i == NUM_RANGES - 1 ? rangeBounds[i] + 10.0f : (rangeBounds[i] + rangeBounds[i + 1]) * 0.5f;
+}
+
+// Linear between the anchors, flat below the first and above the last one
+static constexpr float lutInterval(const float* intervals, float speed, int j = 0) {
+    return speed <= lutAnchorSpeed(0) ? intervals[0]
+         : speed >= lutAnchorSpeed(NUM_RANGES - 1) ? intervals[NUM_RANGES - 1]
+         : speed < lutAnchorSpeed(j + 1)
+             ? intervals[j] + (intervals[j + 1] - intervals[j]) * (speed - lutAnchorSpeed(j)) /
+                                  (lutAnchorSpeed(j + 1) - lutAnchorSpeed(j))
+             : lutInterval(intervals, speed, j + 1);
+}
+
+static constexpr int8_t lutRange(float speed, int j = 0) {
+    return j >= NUM_RANGES ? LUT_NO_RANGE
+         : (speed >= rangeBounds[j] && speed < rangeBounds[j + 1]) ? (int8_t)j
+         : lutRange(speed, j + 1);
+}
+
+static constexpr RangeLutEntry lutEntry(const float* intervals, int i) {
+    return { lutInterval(intervals, (float)(i * LUT_STEP)),
+             (lutInterval(intervals, (float)((i + 1) * LUT_STEP)) - lutInterval(intervals, (float)(i * LUT_STEP))) / LUT_STEP,
+             lutRange((float)(i * LUT_STEP)) };
+}
 
-// Setup OneWire and DallasTemperature
-OneWire* oneWire;
-DallasTemperature* sensors;
+static constexpr bool lutBoundsOnGrid(int j = 0) {
+    return j > NUM_RANGES || ((int)rangeBounds[j] % LUT_STEP == 0 && lutBoundsOnGrid(j + 1));
+}
+static_assert(lutBoundsOnGrid(), "Range bounds must be multiples of LUT_STEP (one range per bucket)");
+
+template<int... I> struct LutIndices {};
+template<int N, int... I> struct MakeLutIndices : MakeLutIndices<N - 1, N - 1, I...> {};
+template<int... I> struct MakeLutIndices<0, I...> { typedef LutIndices<I...> type; };
+
+struct RangeLut { RangeLutEntry e[LUT_SIZE]; };
+
+template<int... I> static constexpr RangeLut makeDefaultLUT(LutIndices<I...>) {
+    return {{ lutEntry(rangeIntervalDefaults, I)... }};
+}
 
-Oiler::Oiler(IPersistence* store, int pumpPin, int ledPin, int tempPin) 
-    : strip(NUM_LEDS, ledPin, NEO_GRB + NEO_KHZ800) {
+static constexpr RangeLut defaultRangeLUT = makeDefaultLUT(MakeLutIndices<LUT_SIZE>::type());
+
+// Bucket of a speed. Negative speeds land in the first and speeds above MAX_SPEED_KMH in
+// the last bucket; both are flat (slope 0) and belong to no range.
+static inline int lutBucket(float speedKmh) {
+    int i = (int)(speedKmh * (1.0f / LUT_STEP));
+    return i < 0 ? 0 : (i >= LUT_SIZE ? LUT_SIZE - 1 : i);
+}
+
+Oiler::Oiler(IPersistence* store, int pumpPin, int ledPin, int tempPin, IPulseGenerator* pulseGen) 
+    : strip(NUM_LEDS, ledPin, NEO_GRB + NEO_KHZ800), pumpTrain(pulseGen), tempSensors(tempPin) {
     _store = store;
     _pumpPin = pumpPin;
     _tempPin = tempPin;
     
-    // Initialize OneWire and DallasTemperature dynamically
-    oneWire = new OneWire(_tempPin);
-    sensors = new DallasTemperature(oneWire);
-    
-    // Initialize default configuration - Swiss Alpine Profile
-    // Range 0: City / Hairpins (10-45 km/h) -> 6.0 km (Low centrifugal force)
-    ranges[0] = {10, 45, 6.0, 2};
-    
-    // Range 1: Mountain Passes / Main Zone (45-75 km/h) -> 5.0 km (Base)
-    ranges[1] = {45, 75, 5.0, 2};
-    
-    // Range 2: Country Roads (75-105 km/h) -> 4.4 km (-12.5% from Base)
-    ranges[2] = {75, 105, 4.4, 2}; 
-    
-    // Range 3: Highway (105-135 km/h) -> 3.8 km (-25% from Base)
-    ranges[3] = {105, 135, 3.8, 2}; 
-    
-    // Range 4: High Speed (135+ km/h) -> 3.0 km (-40% from Base)
-    ranges[4] = {135, MAX_SPEED_KMH, 3.0, 2};
+    // Initialize default configuration from the range table of the build (SpeedRanges.h)
+    for(int i=0; i<NUM_RANGES; i++) {
+        ranges[i] = {rangeBounds[i], rangeBounds[i + 1], rangeIntervalDefaults[i], 2};
+    }
     
     // Initialize Temperature Configuration (Defaults)
     // Updated based on Calibration: 55ms Pulse for reliability
@@ -42,6 +144,7 @@ Oiler::Oiler(IPersistence* store, int pumpPin, int ledPin, int tempPin)
     lastTempUpdate = 0; // Init temp update timer
 
     currentProgress = 0.0;
+    rangeLUT = defaultRangeLUT.e; // Until loadConfig() selects the configured profile
     lastLat = 0.0;
     lastLon = 0.0;
     hasFix = false;
@@ -49,14 +152,13 @@ Oiler::Oiler(IPersistence* store, int pumpPin, int ledPin, int tempPin)
     progressChanged = false;
 
     // Stats & Smoothing Init
-    totalDistance = 0.0;
+    odometer.setMm(0);
     pumpCycles = 0;
-    for(int i=0; i<SPEED_BUFFER_SIZE; i++) speedBuffer[i] = 0.0;
-    speedBufferIndex = 0;
+    speedEstimator.reset(0.0f);
     
     // Time Stats Init
     for(int i=0; i<NUM_RANGES; i++) {
-        currentIntervalTime[i] = 0.0;
+        currentIntervalTime[i] = 0;
         sessionTimeInRanges[i] = 0; // Reset session stats on boot
     }
     // Init History
@@ -65,7 +167,7 @@ Oiler::Oiler(IPersistence* store, int pumpPin, int ledPin, int tempPin)
     for(int i=0; i<20; i++) {
         history.oilingRange[i] = -1;
         for(int j=0; j<NUM_RANGES; j++) {
-            history.timeInRanges[i][j] = 0.0;
+            history.timeInRanges[i][j] = 0;
         }
     }
     lastTimeUpdate = 0;
@@ -138,6 +240,15 @@ Oiler::Oiler(IPersistence* store, int pumpPin, int ledPin, int tempPin)
     
     lastEmergUpdate = 0;
     lastStandstillSaveTime = 0;
+    persistedValid = false;
+    pendingSaves = 0;
+    maxSaveStallUs = 0;
+    checkpointId = 0;
+    checkpointOdometerMm = 0;
+    checkpointPumpCycles = 0;
+    lastCheckpointTime = 0;
+    journalRecords = 0;
+    oilingPending = false;
     
     // Init LUT
     rebuildLUT();
@@ -167,9 +278,16 @@ void Oiler::begin(int imuSda, int imuScl) {
         ledcAttach(_pumpPin, PUMP_PWM_FREQ, PUMP_PWM_RESOLUTION);
 #endif
     }
+    if (pumpTrain.available() && !pumpTrain.begin(_pumpPin)) {
+        Serial.println("Pump: Pulse generator failed, pulses timed by loop()");
+        pumpTrain = PulseTrain(nullptr);
+    }
 
-    // Initialize Temp Sensor
-    sensors->begin();
+    // Initialize Temp Sensors (readings follow from loop(), the first one within a second)
+    uint8_t tempCount = tempSensors.begin(TEMP_RESOLUTION_BITS);
+    if (tempCount > 0) {
+        Serial.printf("Temp: %u DS18B20, %u bit\n", tempCount, tempSensors.getResolution());
+    }
 
     // Initialize IMU
     imu.begin(imuSda, imuScl);
@@ -183,8 +301,7 @@ void Oiler::begin(int imuSda, int imuScl) {
     // Hardware Init
     pinMode(BUTTON_PIN, INPUT_PULLUP);
     pinMode(BOOT_BUTTON_PIN, INPUT_PULLUP); // Init onboard button
-    strip.begin();
-    strip.setBrightness(ledBrightnessDim);
+    strip.begin(); // Brightness stays at full scale, ledRenderer scales per pixel
     strip.show(); // All pixels off
 }
 
@@ -195,10 +312,17 @@ void Oiler::performFactoryReset() {
     // Ensure any previous session is closed
     _store->end();
 
+    // Clear Oiler and Aux settings (IMU calibration is kept)
+    configStore.discard(_store, CONFIG_SECTION_OILER | CONFIG_SECTION_AUX);
+
     // Clear Oiler Preferences
     _store->begin("oiler", false);
     _store->clear(); // Nuke everything
     _store->end();
+    persistedValid = false; // Shadow no longer matches flash
+
+    // "ckpt" is gone with the namespace: old journal records would replay as checkpoint 0
+    if (journal) journal->clear();
     
     delay(100);
 
@@ -213,66 +337,142 @@ void Oiler::performFactoryReset() {
 }
 
 void Oiler::loop() {
-    imu.loop(); // Update IMU data
-    
-    // Check for Crash (Latch)
-    if (imu.isCrashed()) {
-        crashTripped = true;
+    unsigned long now = millis();
+
+    // Inputs: IMU reports and button debounce
+    if (scheduler.due(TASK_INPUT, now)) {
+        imu.loop(); // Update IMU data
+
+        // Check for Crash (Latch)
+        if (imu.isCrashed()) {
+            crashTripped = true;
+        }
+
+        handleButton();
+        scheduler.after(TASK_INPUT, now, INPUT_POLL_MS);
+    }
+
+    // Pump: every ms while busy (every 10 ms with hardware trains); triggerOil() and startBleeding() wake it
+    if (scheduler.due(TASK_PUMP, now)) {
+        processPump(); // Unified pump logic
+        unsigned long busyStep = pumpTrain.available() ? PULSE_TRAIN_POLL_MS : 1;
+        scheduler.after(TASK_PUMP, now, isPumpBusy() ? busyStep : TASK_RECHECK_MS);
     }
 
-    handleButton();
-    processPump(); // Unified pump logic
-    
     // Offroad Mode Logic (Time Based)
-    if (offroadMode) {
-        unsigned long now = millis();
-        unsigned long intervalMs = (unsigned long)offroadIntervalMin * 60 * 1000;
-        
-        if (now - lastOffroadOilTime > intervalMs) {
-            // SAFETY: Only oil if moving! 
-            // User requested minimum speed of 7 km/h for offroad mode to prevent oiling at standstill/idling.
-            if (currentSpeed >= 7.0) {
-                triggerOil(ranges[0].pulses); // Use pulses from first range
-                lastOffroadOilTime = now;
+    if (scheduler.due(TASK_OFFROAD, now)) {
+        unsigned long next = TASK_RECHECK_MS;
+        if (offroadMode) {
+            unsigned long intervalMs = (unsigned long)offroadIntervalMin * 60 * 1000;
+
+            if (now - lastOffroadOilTime > intervalMs) {
+                // SAFETY: Only oil if moving!
+                // User requested minimum speed of 7 km/h for offroad mode to prevent oiling at standstill/idling.
+                // Too slow: look again after the next fix (next = recheck)
+                if (currentSpeed >= 7.0f) {
+                    triggerOil(ranges[0].pulses); // Use pulses from first range
+                    lastOffroadOilTime = now;
+                    next = intervalMs + 1;
+                }
+            } else {
+                next = intervalMs + 1 - (now - lastOffroadOilTime);
             }
         }
+        scheduler.after(TASK_OFFROAD, now, next);
     }
 
     // Chain Flush Mode Logic (Time Based)
-    if (flushMode) {
-        unsigned long now = millis();
-        unsigned long intervalMs = (unsigned long)flushConfigIntervalSec * 1000;
-
-        if (now - lastFlushOilTime > intervalMs) {
-            // SAFETY: Only oil if moving!
-            // Similar to Cross-Country, we require movement to avoid puddles.
-            if (currentSpeed >= 2.0) {
-                triggerOil(flushConfigPulses);
-                lastFlushOilTime = now;
-                flushEventsRemaining--;
-
-                if (flushEventsRemaining <= 0) {
-                    setFlushMode(false); // Done
+    if (scheduler.due(TASK_FLUSH, now)) {
+        unsigned long next = TASK_RECHECK_MS;
+        if (flushMode) {
+            unsigned long intervalMs = (unsigned long)flushConfigIntervalSec * 1000;
+
+            if (now - lastFlushOilTime > intervalMs) {
+                // SAFETY: Only oil if moving!
+                // Similar to Cross-Country, we require movement to avoid puddles.
+                if (currentSpeed >= 2.0f) {
+                    triggerOil(flushConfigPulses);
+                    lastFlushOilTime = now;
+                    flushEventsRemaining--;
+                    next = intervalMs + 1;
+
+                    if (flushEventsRemaining <= 0) {
+                        setFlushMode(false); // Done
+                    }
                 }
+            } else {
+                next = intervalMs + 1 - (now - lastFlushOilTime);
             }
         }
+        scheduler.after(TASK_FLUSH, now, next);
     }
-    
-    // Temperature Update (Periodic)
-    if (millis() - lastTempUpdate > TEMP_UPDATE_INTERVAL_MS) {
-        updateTemperature();
-        lastTempUpdate = millis();
+
+    // Temperature Update (Periodic): one 1-Wire operation per pass, the conversion runs meanwhile
+    if (scheduler.due(TASK_TEMP, now)) {
+        bool cycleDone;
+        unsigned long next = tempSensors.step(now, TEMP_UPDATE_INTERVAL_MS, cycleDone);
+        if (cycleDone) {
+            updateTemperature();
+            lastTempUpdate = now;
+        }
+        scheduler.after(TASK_TEMP, now, next);
     }
 
     // Rain Mode Auto-Off
-    if (rainMode && (millis() - rainModeStartTime > RAIN_MODE_AUTO_OFF_MS)) {
-        rainMode = false;
-        webConsole.log("Rain Mode Auto-Off");
-        Serial.println("Rain Mode Auto-Off");
-        saveConfig();
+    if (scheduler.due(TASK_RAIN, now)) {
+        unsigned long next = TASK_RECHECK_MS;
+        if (rainMode) {
+            unsigned long elapsed = now - rainModeStartTime;
+            if (elapsed > RAIN_MODE_AUTO_OFF_MS) {
+                rainMode = false;
+                webConsole.log("Rain Mode Auto-Off");
+                Serial.println("Rain Mode Auto-Off");
+                requestSave(PENDING_CONFIG);
+            } else {
+                next = RAIN_MODE_AUTO_OFF_MS + 1 - elapsed;
+            }
+        }
+        scheduler.after(TASK_RAIN, now, next);
     }
 
-    updateLED();
+    if (scheduler.due(TASK_LED, now)) {
+        updateLED();
+        scheduler.after(TASK_LED, now, LED_FRAME_MS);
+    }
+
+    // Flash writes last, and only while no pulse can be stretched by them
+    flushPendingSaves();
+}
+
+uint32_t Oiler::msUntilNextDue() {
+    // The input poll is always armed, so this never exceeds INPUT_POLL_MS
+    return scheduler.msUntilNext(millis(), INPUT_POLL_MS);
+}
+
+void Oiler::flushPendingSaves(bool force) {
+    if (pendingSaves == 0) return;
+    // Hardware trains keep their timing during a flash write (CPU stalls, TIMER/PPI run on)
+    if (!force && !pumpTrain.available() && (pumpState != PUMP_IDLE || isOiling || bleedingMode)) return;
+
+    uint8_t what = pendingSaves;
+    pendingSaves = 0;
+
+    unsigned long start = micros();
+    if (what & PENDING_CONFIG) {
+        saveConfig(); // Also checkpoints progress and stats
+        progressChanged = false;
+    } else {
+        saveProgress();
+    }
+    uint32_t stallUs = micros() - start;
+
+    if (stallUs > maxSaveStallUs) {
+        maxSaveStallUs = stallUs;
+        if (stallUs >= 10000) {
+            Serial.printf("Save: New max. stall %lu ms\n", (unsigned long)(stallUs / 1000));
+            webConsole.logf("Save: New max. stall %lu ms", (unsigned long)(stallUs / 1000));
+        }
+    }
 }
 
 bool Oiler::checkWifiToggleRequest() {
@@ -370,9 +570,78 @@ void Oiler::setCurrentHour(int hour) {
     currentHour = hour;
 }
 
+static const uint32_t auxBoostColors[] = {
+    LED_RGB(0, 0, 255), LED_RGB(255, 255, 0), LED_RGB(255, 140, 0), LED_RGB(255, 0, 0) // "Heating up"
+};
+
+// Indexed by LedState
+static const LedPattern ledPatterns[LED_STATE_COUNT] = {
+    // wave         color                    altColor                 level       altLevel    periodMs                widthMs floor minBri cycle
+    { WAVE_BLINK,  LED_RGB(0, 255, 255),    0,                       LEVEL_HIGH, LEVEL_HIGH, 2 * LED_BLINK_FAST,     0,   0,   0,  nullptr, 0 },        // UPDATE: cyan fast blink
+    { WAVE_BLINK,  LED_RGB(255, 0, 0),      LED_RGB(255, 255, 255),  LEVEL_HIGH, LEVEL_HIGH, 200,                    0,   0,   0,  nullptr, 0 },        // CRASH: red/white
+    { WAVE_BLINK,  LED_RGB(255, 0, 0),      0,                       LEVEL_HIGH, LEVEL_HIGH, 2 * LED_BLINK_FAST,     0,   0,   0,  nullptr, 0 },        // BLEEDING: red fast blink
+    { WAVE_BLINK,  LED_RGB(0, 255, 255),    0,                       LEVEL_HIGH, LEVEL_HIGH, 2 * LED_PERIOD_FLUSH,   0,   0,   0,  nullptr, 0 },        // FLUSH: cyan blink
+    { WAVE_BLINK,  LED_RGB(255, 0, 255),    0,                       LEVEL_HIGH, LEVEL_HIGH, 2000,                   0,   0,   0,  nullptr, 0 },        // OFFROAD: magenta 1 s on/off
+    { WAVE_PULSE,  LED_RGB(255, 255, 255),  0,                       LEVEL_HIGH, LEVEL_HIGH, LED_PERIOD_WIFI,        0,  51,   5,  nullptr, 0 },        // WIFI: white pulse, 20% floor
+    { WAVE_PULSE,  LED_RGB(255, 200, 0),    0,                       LEVEL_HIGH, LEVEL_HIGH, LED_PERIOD_OILING,      0,   0,   5,  nullptr, 0 },        // OILING: yellow breathing
+    { WAVE_PULSE,  LED_RGB(255, 0, 0),      0,                       LEVEL_HIGH, LEVEL_HIGH, 2000,                   0,   0,  10,  nullptr, 0 },        // STOP_TANK_EMPTY: red pulse
+    { WAVE_DOUBLE, LED_RGB(255, 69, 0),     0,                       LEVEL_HIGH, LEVEL_HIGH, LED_BLINK_TANK,       200,   0,   0,  nullptr, 0 },        // STOP_TANK_LOW: orange 2x blink
+    { WAVE_PULSE,  LED_RGB(0, 0, 255),      0,                       LEVEL_DIM,  LEVEL_DIM,  2000,                   0,   0,   5,  nullptr, 0 },        // STOP_RAIN: blue pulse
+    { WAVE_PULSE,  LED_RGB(0, 255, 0),      0,                       LEVEL_DIM,  LEVEL_DIM,  2000,                   0,   0,   5,  nullptr, 0 },        // STOP_OK: green pulse
+    { WAVE_DOUBLE, LED_RGB(255, 69, 0),     0,                       LEVEL_HIGH, LEVEL_HIGH, LED_BLINK_TANK,       200,   0,   0,  nullptr, 0 },        // TANK_LOW: orange 2x blink
+    { WAVE_STATIC, LED_RGB(0, 255, 255),    0,                       LEVEL_DIM,  LEVEL_DIM,  0,                      0,   0,   0,  nullptr, 0 },        // NO_FIX_EMERGENCY: cyan
+    { WAVE_STATIC, 0,                       0,                       LEVEL_DIM,  LEVEL_DIM,  0,                      0,   0,   0,  nullptr, 0 },        // NO_FIX: off
+    { WAVE_DOUBLE, LED_RGB(255, 140, 0),    LED_RGB(0, 255, 0),      LEVEL_HIGH, LEVEL_DIM,  LED_PERIOD_EMERGENCY, 100,   0,   0,  nullptr, 0 },        // EMERGENCY: orange 2x pulse over green
+    { WAVE_STATIC, LED_RGB(0, 0, 255),      0,                       LEVEL_DIM,  LEVEL_DIM,  0,                      0,   0,   0,  nullptr, 0 },        // RAIN: blue
+    { WAVE_STATIC, LED_RGB(0, 255, 0),      0,                       LEVEL_DIM,  LEVEL_DIM,  0,                      0,   0,   0,  nullptr, 0 },        // READY: green
+    { WAVE_STATIC, 0,                       0,                       LEVEL_DIM,  LEVEL_DIM,  0,                      0,   0,   0,  nullptr, 0 },        // AUX_OFF
+    { WAVE_STATIC, LED_RGB(0, 255, 0),      0,                       LEVEL_DIM,  LEVEL_DIM,  0,                      0,   0,   0,  nullptr, 0 },        // AUX_POWER: green
+    { WAVE_CYCLE,  0,                       0,                       LEVEL_HIGH, LEVEL_HIGH, 500,                    0,   0,   0,  auxBoostColors, 4 }, // AUX_BOOST: blue-yellow-orange-red
+    { WAVE_STATIC, LED_RGB(0, 0, 255),      0,                       LEVEL_DIM,  LEVEL_DIM,  0,                      0,   0,   0,  nullptr, 0 },        // AUX_LOW: blue
+    { WAVE_STATIC, LED_RGB(255, 255, 0),    0,                       LEVEL_DIM,  LEVEL_DIM,  0,                      0,   0,   0,  nullptr, 0 },        // AUX_MED_LOW: yellow
+    { WAVE_STATIC, LED_RGB(255, 140, 0),    0,                       LEVEL_DIM,  LEVEL_DIM,  0,                      0,   0,   0,  nullptr, 0 },        // AUX_MED_HIGH: orange
+    { WAVE_STATIC, LED_RGB(255, 0, 0),      0,                       LEVEL_DIM,  LEVEL_DIM,  0,                      0,   0,   0,  nullptr, 0 },        // AUX_HIGH: red
+};
+
+LedState Oiler::selectLedState(unsigned long now) {
+    if (updateMode) return LED_STATE_UPDATE;
+    if (crashTripped) return LED_STATE_CRASH; // Latched until reset
+    if (bleedingMode) return LED_STATE_BLEEDING;
+    if (flushMode) return LED_STATE_FLUSH;
+    if (offroadMode) return LED_STATE_OFFROAD;
+    if (wifiActive && (now - wifiActivationTime < LED_WIFI_SHOW_DURATION)) return LED_STATE_WIFI;
+    if (isOiling || now < ledOilingEndTimestamp) return LED_STATE_OILING;
+
+    bool tankLow = tankMonitorEnabled && (currentTankLevelMl / tankCapacityMl * 100.0f) < tankWarningThresholdPercent;
+
+    // Smart Stop: detailed status when standing still (e.g. at traffic lights)
+    if (currentSpeed < 3.0f) {
+        if (tankMonitorEnabled && currentTankLevelMl <= 1.0f) return LED_STATE_STOP_TANK_EMPTY;
+        if (tankLow) return LED_STATE_STOP_TANK_LOW;
+        if (rainMode) return LED_STATE_STOP_RAIN;
+        return LED_STATE_STOP_OK;
+    }
+    if (tankLow) return LED_STATE_TANK_LOW;
+    if (!hasFix) return (emergencyModeForced || emergencyMode) ? LED_STATE_NO_FIX_EMERGENCY : LED_STATE_NO_FIX;
+    if (emergencyModeForced || emergencyMode) return LED_STATE_EMERGENCY;
+    if (rainMode) return LED_STATE_RAIN;
+    return LED_STATE_READY;
+}
+
+LedState Oiler::selectAuxLedState() {
+    if (auxMode == 0 || auxPwm == 0) return LED_STATE_AUX_OFF;
+    if (auxMode == 1) return LED_STATE_AUX_POWER;
+    if (auxMode != 2) return LED_STATE_AUX_OFF;
+
+    // Heated Grips: gradient blue to red
+    if (auxBoost) return LED_STATE_AUX_BOOST;
+    if (auxPwm < 30) return LED_STATE_AUX_LOW;
+    if (auxPwm < 60) return LED_STATE_AUX_MED_LOW;
+    if (auxPwm < 80) return LED_STATE_AUX_MED_HIGH;
+    return LED_STATE_AUX_HIGH;
+}
+
 void Oiler::updateLED() {
-    // LED Update
-    uint32_t color = 0;
     unsigned long now = millis();
 
     // Determine Brightness
@@ -395,277 +664,117 @@ void Oiler::updateLED() {
         }
     }
 
-    // Helper for sine wave pulse (0.0 to 1.0)
-    auto getPulse = [&](int periodMs) -> float {
-        float angle = (now % periodMs) * 2.0 * PI / periodMs;
-        return (sin(angle) + 1.0) / 2.0;
-    };
+    // LED 0: Main Status LED
+    ledRenderer.set(0, LedRenderer::evaluate(ledPatterns[selectLedState(now)], now, currentDimBrightness, currentHighBrightness));
 
-    // 0. Update Mode (Critical) -> CYAN Fast Blink
-    if (updateMode) {
-        strip.setBrightness(currentHighBrightness);
-        if ((now / LED_BLINK_FAST) % 2 == 0) {
-            color = strip.Color(0, 255, 255); // Cyan
-        } else {
-            color = 0; // Off
-        }
-    }
-    // 0.1 Crash Detected (Latch) -> RED/WHITE Fast Alternating
-    else if (crashTripped) {
-        strip.setBrightness(currentHighBrightness);
-        if ((now / 100) % 2 == 0) {
-            color = strip.Color(255, 0, 0); // Red
-        } else {
-            color = strip.Color(255, 255, 255); // White
-        }
-    }
-    // 1. Bleeding Mode (Highest Priority) -> RED Blinking fast
-    else if (bleedingMode) {
-        strip.setBrightness(currentHighBrightness);
-        if ((now / LED_BLINK_FAST) % 2 == 0) {
-            color = strip.Color(255, 0, 0);
-        } else {
-            color = 0; // Off
-        }
-    } 
-    // 1.5 Chain Flush Mode (High Priority) -> CYAN Blinking
-    else if (flushMode) {
-        strip.setBrightness(currentHighBrightness);
-        if ((now / LED_PERIOD_FLUSH) % 2 == 0) {
-            color = strip.Color(0, 255, 255); // Cyan
-        } else {
-            color = 0; // Off
-        }
-    }
-    // 1.6 Offroad Mode -> MAGENTA Blinking
-    else if (offroadMode) {
-        strip.setBrightness(currentHighBrightness);
-        if ((now / 1000) % 2 == 0) { // Slow blink (1s on, 1s off)
-            color = strip.Color(255, 0, 255); // Magenta
-        } else {
-            color = 0; // Off
-        }
-    }
-    // 2. WiFi Active (High Priority Indication) -> WHITE Pulsing
-    else if (wifiActive && (now - wifiActivationTime < LED_WIFI_SHOW_DURATION)) {
-        float pulse = getPulse(LED_PERIOD_WIFI) * 0.8 + 0.2;
-        uint8_t bri = (uint8_t)(pulse * currentHighBrightness);
-        if (bri < 5) bri = 5;
-        strip.setBrightness(bri);
-        color = strip.Color(255, 255, 255);
-    }
-    // 3. Oiling Event -> YELLOW Breathing
-    else if (isOiling || millis() < ledOilingEndTimestamp) {
-        float breath = getPulse(LED_PERIOD_OILING); 
-        uint8_t bri = (uint8_t)(breath * currentHighBrightness);
-        if (bri < 5) bri = 5;
-        strip.setBrightness(bri);
-        color = strip.Color(255, 200, 0);
-    } 
-    // 3.5 Smart Stop (Stationary) -> Status Indication
-    // Show detailed status when standing still (e.g. at traffic lights)
-    else if (currentSpeed < 3.0) {
-        float pulse = getPulse(2000); // Slow pulse 2s
-        
-        // Tank Empty? (Critical) -> RED Pulsing
-        if (tankMonitorEnabled && currentTankLevelMl <= 1.0) {
-             uint8_t bri = (uint8_t)(pulse * currentHighBrightness);
-             if (bri < 10) bri = 10;
-             strip.setBrightness(bri);
-             color = strip.Color(255, 0, 0); 
-        }
-        // Tank Warning? -> ORANGE 2x Blink
-        else if (tankMonitorEnabled && (currentTankLevelMl / tankCapacityMl * 100.0) < tankWarningThresholdPercent) {
-             strip.setBrightness(currentHighBrightness);
-             int phase = now % LED_BLINK_TANK; 
-             if ((phase >= 0 && phase < 200) || (phase >= 400 && phase < 600)) {
-                color = strip.Color(255, 69, 0); 
-             } else {
-                color = 0; 
-             }
-        }
-        // Rain Mode? -> BLUE Pulsing
-        else if (rainMode) {
-             uint8_t bri = (uint8_t)(pulse * currentDimBrightness);
-             if (bri < 5) bri = 5;
-             strip.setBrightness(bri);
-             color = strip.Color(0, 0, 255);
-        }
-        // Normal OK -> GREEN Pulsing
-        else {
-             uint8_t bri = (uint8_t)(pulse * currentDimBrightness);
-             if (bri < 5) bri = 5;
-             strip.setBrightness(bri);
-             color = strip.Color(0, 255, 0);
-        }
-    }
-    // 4. Tank Warning (Moving) -> ORANGE Blinking (2x fast)
-    else if (tankMonitorEnabled && (currentTankLevelMl / tankCapacityMl * 100.0) < tankWarningThresholdPercent) {
-        strip.setBrightness(currentHighBrightness);
-        int phase = now % LED_BLINK_TANK; // 2s cycle
-        // Blink 1: 0-200, Blink 2: 400-600
-        if ((phase >= 0 && phase < 200) || (phase >= 400 && phase < 600)) {
-            color = strip.Color(255, 69, 0); // OrangeRed
-        } else {
-            color = 0; // Off
-        }
-    }
-    else if (!hasFix) {
-        // No GPS
-        unsigned long timeSinceLoss = (lastEmergUpdate > 0) ? (now - lastEmergUpdate) : 0;
-        
-        if (emergencyModeForced) {
-             // Forced Emergency: Cyan
-             strip.setBrightness(currentDimBrightness);
-             color = strip.Color(0, 255, 255); 
-        } else if (emergencyMode) {
-             // Auto Emergency Active: Cyan Dim
-             strip.setBrightness(currentDimBrightness);
-             color = strip.Color(0, 255, 255);
-        } else {
-            color = 0; // Off
-        }
+    // LED 1: Aux Status LED (Heated Grips / Aux Power)
+    if (NUM_LEDS > 1) {
+        ledRenderer.set(1, LedRenderer::evaluate(ledPatterns[selectAuxLedState()], now, currentDimBrightness, currentHighBrightness));
     }
-    // 5. Emergency Mode (Forced or Auto) -> ORANGE Double Pulse over GREEN
-    else if (emergencyModeForced || emergencyMode || (!hasFix && (lastEmergUpdate > 0 && (now - lastEmergUpdate) > EMERGENCY_TIMEOUT_MS))) {
-         int phase = now % LED_PERIOD_EMERGENCY; // 1.5s Cycle
-         // Pulse 1: 0-100, Pulse 2: 200-300
-         if ((phase >= 0 && phase < 100) || (phase >= 200 && phase < 300)) {
-             strip.setBrightness(currentHighBrightness);
-             color = strip.Color(255, 140, 0); // Orange
-         } else {
-             strip.setBrightness(currentDimBrightness);
-             color = strip.Color(0, 255, 0); // Green
-         }
-    }
-    // 6. Rain Mode -> BLUE Static
-    else if (rainMode) {
-        strip.setBrightness(currentDimBrightness);
-        color = strip.Color(0, 0, 255);
-    }
-    // 7. No GPS (Searching) -> MAGENTA Pulsing
-    else if (!hasFix) {
-        float pulse = getPulse(LED_PERIOD_GPS);
-        uint8_t bri = (uint8_t)(pulse * currentDimBrightness);
-        if (bri < 5) bri = 5;
-        strip.setBrightness(bri);
-        color = strip.Color(255, 0, 255);
-    }
-    // 8. Idle / Ready -> GREEN Static
-    else {
-        strip.setBrightness(currentDimBrightness);
-        color = strip.Color(0, 255, 0);
-    }
-
-    for(int i=0; i<NUM_LEDS; i++) {
-        // LED 0: Main Status LED (Logic above)
-        if (i == 0) {
-            strip.setPixelColor(i, color);
-        } 
-        // LED 1: Aux Status LED (Heated Grips / Aux Power)
-        else if (i == 1) {
-            uint32_t auxColor = 0;
-            
-            if (auxMode == 0 || auxPwm == 0) {
-                auxColor = 0; // OFF
-            } else if (auxMode == 1) {
-                // Aux Power Active -> Green Static
-                strip.setBrightness(currentDimBrightness);
-                auxColor = strip.Color(0, 255, 0);
-            } else if (auxMode == 2) {
-                // Heated Grips -> Gradient Blue to Red
-                strip.setBrightness(currentDimBrightness); // Use dim brightness for constant light
-                
-                if (auxBoost) {
-                    // Startup Boost -> Color Cycle (Blue -> Yellow -> Orange -> Red)
-                    // Simulates "Heating Up"
-                    strip.setBrightness(currentHighBrightness);
-                    int phase = (now / 500) % 4; 
-                    switch(phase) {
-                        case 0: auxColor = strip.Color(0, 0, 255); break;   // Blue
-                        case 1: auxColor = strip.Color(255, 255, 0); break; // Yellow
-                        case 2: auxColor = strip.Color(255, 140, 0); break; // Orange
-                        case 3: auxColor = strip.Color(255, 0, 0); break;   // Red
-                    }
-                } else if (auxPwm < 30) {
-                    auxColor = strip.Color(0, 0, 255); // Blue (Low)
-                } else if (auxPwm < 60) {
-                    auxColor = strip.Color(255, 255, 0); // Yellow (Med-Low)
-                } else if (auxPwm < 80) {
-                    auxColor = strip.Color(255, 140, 0); // Orange (Med-High)
-                } else {
-                    auxColor = strip.Color(255, 0, 0); // Red (High)
-                }
-            }
-            strip.setPixelColor(i, auxColor);
-        }
-    }
-    strip.show();
+
+    ledRenderer.show(strip, NUM_LEDS); // Only when a pixel changed
 }
 
 void Oiler::loadConfig() {
-    // Load configuration from Flash (NVS)
-    // If nothing is saved yet, default values remain
-    for(int i=0; i<NUM_RANGES; i++) {
-        String keyBase = "r" + String(i);
-        ranges[i].intervalKm = _store->getFloat((keyBase + "_km").c_str(), ranges[i].intervalKm);
-        ranges[i].pulses = _store->getInt((keyBase + "_p").c_str(), ranges[i].pulses);
-    }
-
-    // Load Temperature Compensation Settings (New Simplified Model)
-    tempConfig.basePulse25 = _store->getFloat("tc_pulse", (float)PULSE_DURATION_MS);
-    tempConfig.basePause25 = _store->getFloat("tc_pause", (float)PAUSE_DURATION_MS);
-    tempConfig.oilType = (OilType)_store->getInt("tc_oil", (int)OIL_NORMAL);
-
+    // Settings: one record for all modules (single read), see ConfigStore
+    configStore.load(_store);
+    bool migrate = !configStore.has(CONFIG_SECTION_OILER);
+    OilerSettings settings = configStore.oiler();
+    if (migrate) {
+        // First boot after update (or fresh device): defaults, then the old per-key
+        // settings where they exist
+        paramDefaults(oilerParamTable, &settings);
+        paramLoadLegacy(oilerParamTable, _store, &settings);
+    }
+    int corrected = paramValidate(oilerParamTable, &settings);
+    if (corrected > 0) {
+        Serial.printf("Oiler: %d settings out of range, corrected\n", corrected);
+    }
+    applySettings(settings);
+    _store->begin("oiler", false); // load() switches the namespace
+
+    // Runtime state (changes while riding, stays in small separate values)
     currentProgress = _store->getFloat("progress", 0.0);
-    ledBrightnessDim = _store->getUChar("led_dim", LED_BRIGHTNESS_DIM);
-    ledBrightnessHigh = _store->getUChar("led_high", LED_BRIGHTNESS_HIGH);
-    
-    nightModeEnabled = _store->getBool("night_en", true);
-    nightStartHour = _store->getInt("night_start", 20);
-    nightEndHour = _store->getInt("night_end", 6);
-    nightBrightness = _store->getUChar("night_bri", 13);
-    nightBrightnessHigh = _store->getUChar("night_bri_h", 64);
     
     // Restore Rain Mode
     rainMode = _store->getBool("rain_mode", false); 
     
     emergencyMode = _store->getBool("emerg_mode", false);
 
-    // Load Offroad & Startup
-    offroadIntervalMin = _store->getInt("off_int", OFFROAD_INTERVAL_MIN_DEFAULT);
-    startupDelayMeters = _store->getFloat("start_dly_m", STARTUP_DELAY_METERS_DEFAULT);
-
-    // Load Chain Flush Mode
-    flushConfigEvents = _store->getInt("tb_evt", FLUSH_DEFAULT_EVENTS);
-    flushConfigPulses = _store->getInt("tb_pls", FLUSH_DEFAULT_PULSES);
-    flushConfigIntervalSec = _store->getInt("tb_int", FLUSH_DEFAULT_INTERVAL_SEC);
-
     // Load Stats
-    totalDistance = _store->getDouble("totalDist", 0.0);
+    odometer.setKm(_store->getDouble("totalDist", 0.0));
     pumpCycles = _store->getUInt("pumpCount", 0);
     
-    // Load Time Stats History
+    // Time stats and intervals of another range table (firmware built with a different
+    // RANGE_PROFILE) don't map onto these ranges: start empty, same for journaled oilings.
+    // Firmware before range tables wrote no id, range data it left is of the 5-range layout
+    uint32_t storedLayout = _store->getUInt("rng_id", 0);
+    if (storedLayout == 0) {
+        storedLayout = hasLegacyRangeData() ? legacyRangeLayout : rangeLayout;
+        if (storedLayout == rangeLayout) {
+            _store->putUInt("rng_id", rangeLayout); // Fresh device or same table
+        }
+    }
+    rangeTableChanged = storedLayout != rangeLayout;
+
+    // Load Time Stats History (older firmware stored seconds as double)
     size_t len = _store->getBytesLength("statsHist");
-    if (len == sizeof(StatsHistory)) {
+    if (rangeTableChanged) {
+        // Stays empty
+    } else if (len == sizeof(StatsHistory)) {
         _store->getBytes("statsHist", &history, sizeof(StatsHistory));
+    } else if (len == sizeof(LegacyStatsHistory)) {
+        // One-time conversion, keep the 824 bytes off the stack
+        LegacyStatsHistory* legacy = new LegacyStatsHistory;
+        if (legacy) {
+            _store->getBytes("statsHist", legacy, sizeof(LegacyStatsHistory));
+            history.head = legacy->head % 20;
+            history.count = (legacy->count > 20) ? 20 : legacy->count;
+            for(int i=0; i<20; i++) {
+                history.oilingRange[i] = legacy->oilingRange[i];
+                for(int j=0; j<NUM_RANGES && j<LEGACY_NUM_RANGES; j++) {
+                    history.timeInRanges[i][j] = saturateSeconds(legacy->timeInRanges[i][j]);
+                }
+            }
+            delete legacy;
+            _store->putBytes("statsHist", &history, sizeof(StatsHistory));
+            Serial.println("Stats history converted to compact format");
+        }
     }
-    // Load current interval time
-    for(int i=0; i<NUM_RANGES; i++) {
-        currentIntervalTime[i] = _store->getDouble(("cit" + String(i)).c_str(), 0.0);
+    // Load current interval time (deciseconds; older firmware stored doubles, first one key per range)
+    len = _store->getBytesLength("cit");
+    if (rangeTableChanged) {
+        // Stays 0
+    } else if (len == sizeof(currentIntervalTime)) {
+        _store->getBytes("cit", currentIntervalTime, sizeof(currentIntervalTime));
+    } else {
+        double legacy[NUM_RANGES];
+        if (len == sizeof(legacy)) {
+            _store->getBytes("cit", legacy, sizeof(legacy));
+        } else {
+            for(int i=0; i<NUM_RANGES; i++) {
+                legacy[i] = _store->getDouble(("cit" + String(i)).c_str(), 0.0);
+            }
+        }
+        for(int i=0; i<NUM_RANGES; i++) {
+            currentIntervalTime[i] = 0;
+            addIntervalTime(i, (float)legacy[i]);
+        }
+        _store->putBytes("cit", currentIntervalTime, sizeof(currentIntervalTime));
+        if (len != sizeof(legacy)) {
+            for(int i=0; i<NUM_RANGES; i++) {
+                _store->remove(("cit" + String(i)).c_str());
+            }
+        }
     }
 
-    // Load Tank Monitor
-    tankMonitorEnabled = _store->getBool("tank_en", true);
-    tankCapacityMl = _store->getFloat("tank_cap", 100.0);
+    // Load Tank Level
     currentTankLevelMl = _store->getFloat("tank_lvl", 100.0);
-    dropsPerMl = _store->getInt("drop_ml", 50);
-    dropsPerPulse = _store->getInt("drop_pls", 1);
-    tankWarningThresholdPercent = _store->getInt("tank_warn", 10);
 
-    // Load Emergency Mode forced setting
-    // SAFETY: Previously we forced this OFF. Now we allow persistence for long trips with broken GPS.
-    emergencyModeForced = _store->getBool("emerg_force", false); 
+    // Checkpoint the journal deltas refer to
+    checkpointId = _store->getUInt("ckpt", 0);
+    checkpointOdometerMm = odometer.mm();
+    checkpointPumpCycles = pumpCycles;
 
     // If forced, activate immediately
     if (emergencyModeForced) {
@@ -673,112 +782,249 @@ void Oiler::loadConfig() {
         emergencyModeStartTime = millis();
     }
 
-    validateConfig();
+    // Remember what is stored
+    snapshotPersisted();
+
+    // Apply what was journaled after the checkpoint
+    replayJournal();
+
+    if (rangeTableChanged) {
+        // Intervals were tuned for other bounds: defaults of this table, write everything once
+        for(int i=0; i<NUM_RANGES; i++) {
+            ranges[i].intervalKm = rangeIntervalDefaults[i];
+            ranges[i].pulses = 2;
+        }
+        for(int i=0; i<LEGACY_NUM_RANGES; i++) {
+            // Keys of firmware before range tables the conversions above skipped
+            _store->remove(("cit" + String(i)).c_str());
+            if (i >= NUM_RANGES) {
+                _store->remove(("r" + String(i) + "_km").c_str());
+                _store->remove(("r" + String(i) + "_p").c_str());
+            }
+        }
+        Serial.printf("Oiler: Range table changed (%d ranges), intervals and time stats reset\n", NUM_RANGES);
+        webConsole.log("Oiler: Range table changed, intervals reset");
+        persistedValid = false;
+        saveConfig();
+        _store->putUInt("rng_id", rangeLayout);
+        rangeTableChanged = false;
+    }
+
     rebuildLUT(); // Re-calculate LUT after loading config
+
+    if (migrate) {
+        migrateLegacySettings();
+    }
 }
 
-void Oiler::validateConfig() {
-    // Ensure no 0 or negative values exist
-    for(int i=0; i<NUM_RANGES; i++) {
-        if(ranges[i].intervalKm < 0.1) ranges[i].intervalKm = 0.1; // Minimum 0.1km
-        if(ranges[i].pulses < 1) ranges[i].pulses = 1;             // Minimum 1 pulse
+bool Oiler::hasLegacyRangeData() {
+    // Per-range keys and blobs of firmware before range tables ("oiler" namespace)
+    return _store->getBytesLength("r0_km") > 0 || _store->getBytesLength("cit0") > 0 ||
+           _store->getBytesLength("cit") > 0 || _store->getBytesLength("statsHist") > 0;
+}
+
+void Oiler::migrateLegacySettings() {
+    // Write the settings record first, then drop the old keys (a power cut in between
+    // only leaves unused keys behind)
+    OilerSettings settings = configStore.oiler();
+    exportSettings(settings);
+    if (!configStore.save(_store, settings)) {
+        Serial.println("Oiler: Config record not written, old settings kept");
+        return;
     }
-    
-    // Brightness limits (2-202)
-    if(ledBrightnessDim < 2) ledBrightnessDim = 2;
-    if(ledBrightnessDim > 202) ledBrightnessDim = 202;
-    
-    if(ledBrightnessHigh < 2) ledBrightnessHigh = 2;
-    if(ledBrightnessHigh > 202) ledBrightnessHigh = 202;
-    
-    if(nightBrightness < 2) nightBrightness = 2;
-    if(nightBrightness > 202) nightBrightness = 202;
-    
-    if(nightBrightnessHigh < 2) nightBrightnessHigh = 2;
-    if(nightBrightnessHigh > 202) nightBrightnessHigh = 202;
+
+    paramRemoveLegacy(oilerParamTable, _store);
+
+    Serial.println("Oiler: Settings migrated to config record");
+    webConsole.log("Oiler: Settings migrated to config record");
 }
 
-void Oiler::saveConfig() {
-    _store->begin("oiler", false); // Fix: Ensure correct namespace is active
+void Oiler::applySettings(const OilerSettings& s) {
+    for(int i=0; i<NUM_RANGES; i++) {
+        ranges[i].intervalKm = s.intervalKm[i];
+        ranges[i].pulses = s.pulses[i];
+    }
+    tempConfig.basePulse25 = s.basePulse25;
+    tempConfig.basePause25 = s.basePause25;
+    tempConfig.oilType = (OilType)s.oilType;
+    ledBrightnessDim = s.ledBrightnessDim;
+    ledBrightnessHigh = s.ledBrightnessHigh;
+    nightModeEnabled = s.nightModeEnabled;
+    nightStartHour = s.nightStartHour;
+    nightEndHour = s.nightEndHour;
+    nightBrightness = s.nightBrightness;
+    nightBrightnessHigh = s.nightBrightnessHigh;
+    emergencyModeForced = s.emergencyModeForced;
+    offroadIntervalMin = s.offroadIntervalMin;
+    startupDelayMeters = s.startupDelayMeters;
+    flushConfigEvents = s.flushConfigEvents;
+    flushConfigPulses = s.flushConfigPulses;
+    flushConfigIntervalSec = s.flushConfigIntervalSec;
+    tankMonitorEnabled = s.tankMonitorEnabled;
+    tankCapacityMl = s.tankCapacityMl;
+    dropsPerMl = s.dropsPerMl;
+    dropsPerPulse = s.dropsPerPulse;
+    tankWarningThresholdPercent = s.tankWarningThresholdPercent;
+}
 
+void Oiler::exportSettings(OilerSettings& s) {
     for(int i=0; i<NUM_RANGES; i++) {
-        String keyBase = "r" + String(i);
-        _store->putFloat((keyBase + "_km").c_str(), ranges[i].intervalKm);
-        _store->putInt((keyBase + "_p").c_str(), ranges[i].pulses);
+        s.intervalKm[i] = ranges[i].intervalKm;
+        s.pulses[i] = ranges[i].pulses;
+    }
+    s.basePulse25 = tempConfig.basePulse25;
+    s.basePause25 = tempConfig.basePause25;
+    s.oilType = (int32_t)tempConfig.oilType;
+    s.ledBrightnessDim = ledBrightnessDim;
+    s.ledBrightnessHigh = ledBrightnessHigh;
+    s.nightModeEnabled = nightModeEnabled;
+    s.nightStartHour = nightStartHour;
+    s.nightEndHour = nightEndHour;
+    s.nightBrightness = nightBrightness;
+    s.nightBrightnessHigh = nightBrightnessHigh;
+    s.emergencyModeForced = emergencyModeForced;
+    s.offroadIntervalMin = offroadIntervalMin;
+    s.startupDelayMeters = startupDelayMeters;
+    s.flushConfigEvents = flushConfigEvents;
+    s.flushConfigPulses = flushConfigPulses;
+    s.flushConfigIntervalSec = flushConfigIntervalSec;
+    s.tankMonitorEnabled = tankMonitorEnabled;
+    s.tankCapacityMl = tankCapacityMl;
+    s.dropsPerMl = dropsPerMl;
+    s.dropsPerPulse = dropsPerPulse;
+    s.tankWarningThresholdPercent = tankWarningThresholdPercent;
+}
+
+bool Oiler::getParam(const char* key, float& value) {
+    OilerSettings s = configStore.oiler();
+    exportSettings(s);
+    return paramGet(oilerParamTable, &s, key, value);
+}
+
+bool Oiler::setParam(const char* key, float value) {
+    OilerSettings s = configStore.oiler();
+    exportSettings(s);
+    OilerSettings before = s;
+    if (!paramSet(oilerParamTable, &s, key, value)) return false;
+    applySettings(s);
+    if (paramDiff(oilerParamTable, &before, &s) & OILER_PARAM_INTERVAL_KM_MASK) {
+        rebuildLUT();
     }
+    return true;
+}
 
-    // Save Temperature Compensation Settings
-    _store->putFloat("tc_pulse", tempConfig.basePulse25);
-    _store->putFloat("tc_pause", tempConfig.basePause25);
-    _store->putInt("tc_oil", (int)tempConfig.oilType);
+void Oiler::snapshotPersisted() {
+    for(int i=0; i<NUM_RANGES; i++) {
+        persisted.currentIntervalTime[i] = currentIntervalTime[i];
+    }
+    persisted.rainMode = rainMode;
+    persisted.emergencyMode = emergencyMode;
+    persisted.currentTankLevelMl = currentTankLevelMl;
+    persisted.currentProgress = currentProgress;
+    persisted.odometerMm = odometer.mm();
+    persisted.pumpCycles = pumpCycles;
+    persisted.historyCrc = crc32(&history, sizeof(StatsHistory));
+    persistedValid = true;
+}
+
+void Oiler::saveConfig() {
+    // Settings record (one put, skipped by ConfigStore if nothing changed)
+    // The saved record is read-only (flash): compare against it, write a copy
+    const OilerSettings& saved = configStore.oiler();
+    OilerSettings settings = saved;
+    exportSettings(settings);
+    bool rangesChanged = !configStore.has(CONFIG_SECTION_OILER) ||
+                         (paramDiff(oilerParamTable, &saved, &settings) & OILER_PARAM_INTERVAL_KM_MASK);
+    configStore.save(_store, settings);
+
+    // Runtime state: only changed values
+    _store->begin("oiler", false); // Fix: Ensure correct namespace is active
+    _store->beginTransaction(); // All changed values in one atomic flash write
+    PersistedState shadow = persisted; // Becomes the shadow once committed
 
-    _store->putUChar("led_dim", ledBrightnessDim);
-    _store->putUChar("led_high", ledBrightnessHigh);
-    
-    _store->putBool("night_en", nightModeEnabled);
-    _store->putInt("night_start", nightStartHour);
-    _store->putInt("night_end", nightEndHour);
-    _store->putUChar("night_bri", nightBrightness);
-    _store->putUChar("night_bri_h", nightBrightnessHigh);
-    
     // Save Rain Mode
-    _store->putBool("rain_mode", rainMode);
-    _store->putBool("emerg_mode", emergencyMode);
-    _store->putBool("emerg_force", emergencyModeForced);
-
-    // Save Offroad & Startup
-    _store->putInt("off_int", offroadIntervalMin);
-    _store->putFloat("start_dly_m", startupDelayMeters);
-
-    // Save Chain Flush Mode
-    _store->putInt("tb_evt", flushConfigEvents);
-    _store->putInt("tb_pls", flushConfigPulses);
-    _store->putInt("tb_int", flushConfigIntervalSec);
-
-    // Save Tank Monitor
-    _store->putBool("tank_en", tankMonitorEnabled);
-    _store->putFloat("tank_cap", tankCapacityMl);
-    _store->putFloat("tank_lvl", currentTankLevelMl);
-    _store->putInt("drop_ml", dropsPerMl);
-    _store->putInt("drop_pls", dropsPerPulse);
-    _store->putInt("tank_warn", tankWarningThresholdPercent);
+    if (changed(shadow.rainMode, rainMode)) _store->putBool("rain_mode", rainMode);
+    if (changed(shadow.emergencyMode, emergencyMode)) _store->putBool("emerg_mode", emergencyMode);
 
     // Save Stats
-    _store->putDouble("totalDist", totalDistance);
-    _store->putUInt("pumpCount", pumpCycles);
+    uint32_t ckpt = saveStats(shadow);
     
-    // Save Time Stats History
-    _store->putBytes("statsHist", &history, sizeof(StatsHistory));
+    finishCheckpoint(ckpt, shadow, _store->commit());
+    _store->end();
+
+    if (rangesChanged) {
+        rebuildLUT(); // Ensure LUT is up to date when saving (in case ranges changed)
+    }
+}
+
+uint32_t Oiler::saveStats(PersistedState& shadow) {
+    // New checkpoint: journal records written so far are included in the values below.
+    // RAM only moves on to it once the transaction is committed (finishCheckpoint)
+    uint32_t ckpt = checkpointId;
+    if (journalRecords > 0) {
+        ckpt++;
+        _store->putUInt("ckpt", ckpt);
+    }
+
+    if (changed(shadow.currentProgress, currentProgress)) _store->putFloat("progress", currentProgress);
+    if (changed(shadow.currentTankLevelMl, currentTankLevelMl)) _store->putFloat("tank_lvl", currentTankLevelMl);
+    if (changed(shadow.odometerMm, odometer.mm())) _store->putDouble("totalDist", odometer.km());
+    if (changed(shadow.pumpCycles, pumpCycles)) _store->putUInt("pumpCount", pumpCycles);
+
+    // Save Time Stats History (only after an oiling event changed it)
+    if (changed(shadow.historyCrc, crc32(&history, sizeof(StatsHistory)))) {
+        _store->putBytes("statsHist", &history, sizeof(StatsHistory));
+    }
     // Save current interval time
+    bool citChanged = false;
     for(int i=0; i<NUM_RANGES; i++) {
-        _store->putDouble(("cit" + String(i)).c_str(), currentIntervalTime[i]);
+        if (changed(shadow.currentIntervalTime[i], currentIntervalTime[i])) citChanged = true;
     }
-    
-    _store->end();
-    rebuildLUT(); // Ensure LUT is up to date when saving (in case ranges changed)
+    if (citChanged) {
+        _store->putBytes("cit", currentIntervalTime, sizeof(currentIntervalTime));
+    }
+    return ckpt;
+}
+
+void Oiler::finishCheckpoint(uint32_t ckpt, const PersistedState& shadow, bool committed) {
+    if (!committed) {
+        // Flash still holds the previous checkpoint and values: keep journaling against
+        // it, the shadow stays as it was and the next save writes all values again
+        persistedValid = false;
+        Serial.println("Oiler: Checkpoint not committed, kept the previous one");
+        return;
+    }
+    if (ckpt != checkpointId) {
+        checkpointId = ckpt;
+        journalRecords = 0;
+    }
+    checkpointOdometerMm = odometer.mm();
+    checkpointPumpCycles = pumpCycles;
+    lastCheckpointTime = millis();
+    oilingPending = false; // History is part of the checkpoint
+    persisted = shadow;
+    persistedValid = true;
 }
 
 void Oiler::saveProgress() {
     if (progressChanged) {
-        _store->begin("oiler", false); // Fix: Ensure correct namespace is active
-
-        _store->putFloat("progress", currentProgress);
-        // Save Stats
-        _store->putDouble("totalDist", totalDistance);
-        _store->putUInt("pumpCount", pumpCycles);
-        
-        // Save Time Stats History
-        _store->putBytes("statsHist", &history, sizeof(StatsHistory));
-        for(int i=0; i<NUM_RANGES; i++) {
-            _store->putDouble(("cit" + String(i)).c_str(), currentIntervalTime[i]);
+        // Cheap path: append a delta record, full checkpoint only occasionally
+        bool checkpointDue = (millis() - lastCheckpointTime > PROGRESS_CHECKPOINT_MS);
+        if (journal && !checkpointDue && appendJournal()) {
+            progressChanged = false;
+            return;
         }
-        
-        // Save Tank Level
-        _store->putFloat("tank_lvl", currentTankLevelMl);
 
+        _store->begin("oiler", false); // Fix: Ensure correct namespace is active
+        // Atomic: Odometer, progress and stats must never be torn by a power cut
+        _store->beginTransaction();
+        PersistedState shadow = persisted;
+        uint32_t ckpt = saveStats(shadow);
+        bool committed = _store->commit();
+        finishCheckpoint(ckpt, shadow, committed);
         _store->end();
 
-        progressChanged = false;
+        progressChanged = !committed; // Retried with the next save
 #ifdef GPS_DEBUG
         webConsole.log("Stats Saved");
         Serial.println("Progress & Stats saved.");
@@ -786,8 +1032,79 @@ void Oiler::saveProgress() {
     }
 }
 
+bool Oiler::appendJournal() {
+    uint64_t odoMm = odometer.mm();
+    unsigned long pumps = pumpCycles - checkpointPumpCycles;
+    if (odoMm < checkpointOdometerMm || odoMm - checkpointOdometerMm > 4000000000000ULL || pumps > 0xFFFF) {
+        return false; // Out of range -> checkpoint
+    }
+    uint32_t distM = (uint32_t)((odoMm - checkpointOdometerMm + 500) / 1000);
+
+    uint16_t ckpt = (uint16_t)checkpointId;
+    if (oilingPending) {
+        // Newest history entry (written by processDistance just before)
+        int idx = (history.head + 19) % 20;
+        ProgressJournal::Oiling o = {};
+        o.range = history.oilingRange[idx];
+        for(int i=0; i<NUM_RANGES; i++) o.timeInRanges[i] = history.timeInRanges[idx][i];
+        if (!journal->appendOiling(ckpt, o)) return false;
+        journalRecords++;
+        oilingPending = false;
+    }
+
+    ProgressJournal::Delta d;
+    d.distanceM = distM;
+    d.progress = currentProgress;
+    d.pumpCycles = (uint16_t)pumps;
+    float tank = currentTankLevelMl * 10.0f;
+    d.tankDeciMl = (tank < 0.0f) ? 0 : (tank > 65535.0f) ? 65535 : (uint16_t)(tank + 0.5f);
+    if (!journal->appendDelta(ckpt, d)) return false;
+    journalRecords++;
+
+#ifdef GPS_DEBUG
+    Serial.printf("Journal: +%lu m, %u pumps (ckpt %lu)\n", (unsigned long)d.distanceM, d.pumpCycles, (unsigned long)checkpointId);
+#endif
+    return true;
+}
+
+void Oiler::replayJournal() {
+    if (!journal) return;
+    size_t count = journal->replay((uint16_t)checkpointId, onJournalRecord, this);
+    if (count > 0) {
+        // Keep appending to this checkpoint; the next checkpoint includes the replayed values
+        journalRecords = count;
+        progressChanged = true;
+        Serial.printf("Journal: Replayed %u records (Odo %.2f km)\n", (unsigned)count, odometer.km());
+        webConsole.logf("Journal: Replayed %u records", (unsigned)count);
+    }
+}
+
+void Oiler::onJournalRecord(void* context, uint8_t type, const void* payload) {
+    Oiler* self = (Oiler*)context;
+    if (type == ProgressJournal::REC_DELTA) {
+        ProgressJournal::Delta d;
+        memcpy(&d, payload, sizeof(d));
+        // Values are relative to the checkpoint, so only the newest delta matters
+        self->odometer.setMm(self->checkpointOdometerMm + (uint64_t)d.distanceM * 1000);
+        self->pumpCycles = self->checkpointPumpCycles + d.pumpCycles;
+        self->currentProgress = d.progress;
+        self->currentTankLevelMl = d.tankDeciMl / 10.0f;
+    } else if (type == ProgressJournal::REC_OILING && !self->rangeTableChanged) {
+        ProgressJournal::Oiling o;
+        memcpy(&o, payload, sizeof(o));
+        StatsHistory& h = self->history;
+        h.oilingRange[h.head] = o.range;
+        for(int i=0; i<NUM_RANGES; i++) {
+            h.timeInRanges[h.head][i] = o.timeInRanges[i];
+            self->currentIntervalTime[i] = 0; // Interval restarted with this oiling
+        }
+        h.head = (h.head + 1) % 20;
+        if (h.count < 20) h.count++;
+    }
+}
+
 void Oiler::resetStats() {
-    totalDistance = 0.0;
+    odometer.setMm(0);
     pumpCycles = 0;
     resetTimeStats(); // Also reset time stats
     saveConfig();
@@ -795,19 +1112,51 @@ void Oiler::resetStats() {
 
 void Oiler::resetTimeStats() {
     for(int i=0; i<NUM_RANGES; i++) {
-        currentIntervalTime[i] = 0.0;
+        currentIntervalTime[i] = 0;
     }
     history.head = 0;
     history.count = 0;
     for(int i=0; i<20; i++) {
         history.oilingRange[i] = -1;
         for(int j=0; j<NUM_RANGES; j++) {
-            history.timeInRanges[i][j] = 0.0;
+            history.timeInRanges[i][j] = 0;
         }
     }
     saveConfig();
 }
 
+void Oiler::addIntervalTime(int rangeIndex, float seconds) {
+    if (seconds <= 0.0f) return;
+    uint32_t ds = (uint32_t)(seconds * 10.0f + 0.5f);
+    uint32_t& t = currentIntervalTime[rangeIndex];
+    t = (ds > UINT32_MAX - t) ? UINT32_MAX : t + ds; // Saturate
+}
+
+double Oiler::getRecentTimeSeconds(int rangeIndex) {
+    if (rangeIndex < 0 || rangeIndex >= NUM_RANGES) return 0.0;
+    uint32_t sum = 0;
+    for(int i=0; i<history.count; i++) {
+        sum += history.timeInRanges[i][rangeIndex];
+    }
+    return sum + getIntervalTimeSeconds(rangeIndex);
+}
+
+int Oiler::getRecentOilingCount(int rangeIndex) {
+    int n = 0;
+    for(int i=0; i<history.count; i++) {
+        if (history.oilingRange[i] == rangeIndex) n++;
+    }
+    return n;
+}
+
+double Oiler::getRecentTotalTime() {
+    double total = 0.0;
+    for(int i=0; i<NUM_RANGES; i++) {
+        total += getRecentTimeSeconds(i);
+    }
+    return total;
+}
+
 String Oiler::generateAiPrompt() {
     String s = "Analyze the following chain oiler statistics and suggest optimized intervals.\n";
     s += "Current Config:\n";
@@ -824,7 +1173,7 @@ String Oiler::generateAiPrompt() {
         
         s += "Event -" + String(i+1) + ": Triggered by Range " + String(history.oilingRange[idx]) + ". Time spent: ";
         for(int j=0; j<NUM_RANGES; j++) {
-            s += "R" + String(j) + "=" + String(history.timeInRanges[idx][j], 0) + "s ";
+            s += "R" + String(j) + "=" + String((unsigned)getHistoryTimeSeconds(idx, j)) + "s ";
         }
         s += "\n";
     }
@@ -879,54 +1228,43 @@ void Oiler::update(float rawSpeedKmh, double lat, double lon, bool gpsValid) {
         gpsValid = false;
     }
 
-    // GPS Smoothing (Moving Average)
-    speedBuffer[speedBufferIndex] = rawSpeedKmh;
-    speedBufferIndex = (speedBufferIndex + 1) % SPEED_BUFFER_SIZE;
-
-    float smoothedSpeed = 0.0;
-    for(int i=0; i<SPEED_BUFFER_SIZE; i++) {
-        smoothedSpeed += speedBuffer[i];
-    }
-    smoothedSpeed /= SPEED_BUFFER_SIZE;
+    // Time since the previous fix (filter step and time stats)
+    if (lastTimeUpdate == 0) lastTimeUpdate = now;
+    unsigned long dt = now - lastTimeUpdate;
+    lastTimeUpdate = now;
 
-    // Use smoothedSpeed for logic
-    float speedKmh = smoothedSpeed;
+    // GPS Smoothing: GPS speed fused with the IMU velocity change since the last fix
+    float imuDeltaV;
+    bool imuValid = imu.takeForwardDeltaV(imuDeltaV);
+    float speedKmh = speedEstimator.update(rawSpeedKmh, dt * 0.001f, imuDeltaV, imuValid);
     currentSpeed = speedKmh; // Update member variable for handleButton logic
 
     // Update Time Stats
-    if (lastTimeUpdate == 0) lastTimeUpdate = now;
-    unsigned long dt = now - lastTimeUpdate;
-    lastTimeUpdate = now;
 
     // Only count if moving fast enough to be in a range (or at least > MIN_SPEED)
     // And avoid huge jumps (e.g. after sleep)
-    if (speedKmh >= MIN_SPEED_KMH && dt < 2000) {
-        double dtSeconds = (double)dt / 1000.0;
+    if (speedKmh >= MIN_SPEED_F && dt < 2000) {
+        float dtSeconds = dt * 0.001f;
 
         // Find matching range
-        int activeRangeIndex = -1;
-        for(int i=0; i<NUM_RANGES; i++) {
-            if (speedKmh >= ranges[i].minSpeed && speedKmh < ranges[i].maxSpeed) {
-                activeRangeIndex = i;
-                break;
-            }
-        }
+        int activeRangeIndex = rangeLUT[lutBucket(speedKmh)].range;
 
-        if (activeRangeIndex != -1) {
-            currentIntervalTime[activeRangeIndex] += dtSeconds;
+        if (activeRangeIndex != LUT_NO_RANGE) {
+            addIntervalTime(activeRangeIndex, dtSeconds);
             sessionTimeInRanges[activeRangeIndex] += (uint32_t)dtSeconds; // Add to session stats
             progressChanged = true; // Mark for saving
         }
     }
 
-    // Regular saving
-    if (now - lastSaveTime > SAVE_INTERVAL_MS) {
-        saveProgress();
+    // Regular saving (journal deltas are cheap, so they are written more often)
+    unsigned long saveInterval = journal ? PROGRESS_JOURNAL_INTERVAL_MS : SAVE_INTERVAL_MS;
+    if (now - lastSaveTime > saveInterval) {
+        requestSave(PENDING_PROGRESS);
         lastSaveTime = now;
     }
     // Save immediately at standstill (if we were moving before), but limit frequency
-    if (speedKmh < MIN_SPEED_KMH && progressChanged && (now - lastStandstillSaveTime > STANDSTILL_SAVE_MS)) {
-        saveProgress();
+    if (speedKmh < MIN_SPEED_F && progressChanged && (now - lastStandstillSaveTime > STANDSTILL_SAVE_MS)) {
+        requestSave(PENDING_PROGRESS);
         lastStandstillSaveTime = now;
     }
 
@@ -961,7 +1299,7 @@ void Oiler::update(float rawSpeedKmh, double lat, double lon, bool gpsValid) {
                 // Auto-Disable Rain Mode
                 if (rainMode) {
                     setRainMode(false);
-                    saveConfig();
+                    requestSave(PENDING_CONFIG);
                 }
 #ifdef GPS_DEBUG
                 Serial.println("Emergency Mode ACTIVATED (50km/h Sim)");
@@ -979,17 +1317,13 @@ void Oiler::update(float rawSpeedKmh, double lat, double lon, bool gpsValid) {
             lastSimStep = now;
             if (dt > 1000) dt = 1000;
 
-            float simSpeed = 50.0;
-            double distKm = (double)simSpeed * ((double)dt / 3600000.0);
+            float simSpeed = 50.0f;
+            float distKm = simSpeed * (dt / 3600000.0f);
             
             // Update Usage Stats for 50km/h
-            double dtSeconds = (double)dt / 1000.0;
-            for(int i=0; i<NUM_RANGES; i++) {
-                if (simSpeed >= ranges[i].minSpeed && simSpeed < ranges[i].maxSpeed) {
-                    currentIntervalTime[i] += dtSeconds;
-                    break;
-                }
-            }
+            float dtSeconds = dt * 0.001f;
+            int simRange = rangeLUT[lutBucket(simSpeed)].range;
+            if (simRange != LUT_NO_RANGE) addIntervalTime(simRange, dtSeconds);
 
             processDistance(distKm, simSpeed);
 
@@ -1016,17 +1350,17 @@ void Oiler::update(float rawSpeedKmh, double lat, double lon, bool gpsValid) {
     lastEmergUpdate = 0;
     emergencyMode = false; // Disable Emergency Mode automatically
 
-    // Calculate distance (Haversine or TinyGPS function)
-    double distKm = TinyGPSPlus::distanceBetween(lastLat, lastLon, lat, lon) / 1000.0;
+    // Calculate distance (local planar for short hops, haversine for jumps)
+    float distKm = hopDistance.metres(lastLat, lastLon, lat, lon) * 0.001f;
 
     // Only if moving and GPS not jumping (small filter)
     // Plausibility check: < MAX_SPEED_KMH + Buffer
-    if (distKm > 0.005 && speedKmh > MIN_ODOMETER_SPEED_KMH && speedKmh < (MAX_SPEED_KMH + 50.0)) {
+    if (distKm > 0.005f && speedKmh > MIN_ODOMETER_SPEED_F && speedKmh < MAX_PLAUSIBLE_SPEED_F) {
         lastLat = lat;
         lastLon = lon;
 
         // Process Distance (Odometer + Oiling Logic)
-        if (speedKmh >= MIN_SPEED_KMH) {
+        if (speedKmh >= MIN_SPEED_F) {
             processDistance(distKm, speedKmh);
         } else {
             // Just add to odometer if moving slowly but valid? 
@@ -1040,20 +1374,20 @@ void Oiler::update(float rawSpeedKmh, double lat, double lon, bool gpsValid) {
     }
 }
 
-void Oiler::processDistance(double distKm, float speedKmh) {
+void Oiler::processDistance(float distKm, float speedKmh) {
     // IMU Safety Checks
     if (crashTripped) return; // Crash detected (Latched)!
     
     // Garage Guard: Only relevant if speed is low (e.g. < 10 km/h) to prevent GPS drift oiling.
     // If we are riding fast, we don't want "isStationary" (which triggers at low variance) to stop oiling.
-    if (speedKmh < 10.0 && imu.isStationary()) return;
+    if (speedKmh < 10.0f && imu.isStationary()) return;
 
     // 1. Add to Total Odometer
-    totalDistance += distKm;
+    odometer.add(distKm);
 
     // 1.1 Startup Delay Check
     // Convert currentStartupDistance (km) to meters for comparison
-    if ((currentStartupDistance * 1000.0) < startupDelayMeters) {
+    if ((currentStartupDistance * 1000.0f) < startupDelayMeters) {
         currentStartupDistance += distKm;
         return; // Skip oiling logic until delay is reached
     }
@@ -1066,18 +1400,14 @@ void Oiler::processDistance(double distKm, float speedKmh) {
     }
     progressChanged = true; // So Odometer gets saved
 
-    // Find matching range
-    int activeRangeIndex = 0;
-    for(int i=0; i<NUM_RANGES; i++) {
-        if (speedKmh >= ranges[i].minSpeed && speedKmh < ranges[i].maxSpeed) {
-            activeRangeIndex = i;
-            break;
-        }
-    }
+    // Find matching range (outside all ranges: range 0)
+    int bucket = lutBucket(speedKmh);
+    const RangeLutEntry& lut = rangeLUT[bucket];
+    int activeRangeIndex = lut.range == LUT_NO_RANGE ? 0 : lut.range;
     
     // Update Time Stats (Seconds)
-    if (speedKmh > 0.1) {
-        currentIntervalTime[activeRangeIndex] += (distKm / speedKmh) * 3600.0;
+    if (speedKmh > 0.1f) {
+        addIntervalTime(activeRangeIndex, distKm / speedKmh * 3600.0f);
     }
 
     float targetInterval;
@@ -1086,25 +1416,22 @@ void Oiler::processDistance(double distKm, float speedKmh) {
     if (flushMode) {
         return; // Handled in loop()
     } else {
-        // 1. Get Target Interval from LUT (Linear Interpolation)
-        int lutIndex = (int)(speedKmh / LUT_STEP);
-        if (lutIndex < 0) lutIndex = 0;
-        if (lutIndex >= LUT_SIZE) lutIndex = LUT_SIZE - 1;
-        targetInterval = intervalLUT[lutIndex];
+        // 1. Get Target Interval from LUT (interpolated within the bucket)
+        targetInterval = lut.intervalKm + lut.slope * (speedKmh - (float)(bucket * LUT_STEP));
     }
 
     // 2. Low-Pass Filter (Additional Smoothing)
-    if (smoothedInterval == 0.0) smoothedInterval = targetInterval; // Init
-    smoothedInterval = (smoothedInterval * 0.95) + (targetInterval * 0.05);
+    if (smoothedInterval == 0.0f) smoothedInterval = targetInterval; // Init
+    smoothedInterval = (smoothedInterval * 0.95f) + (targetInterval * 0.05f);
 
     float interval = smoothedInterval;
 
-    if (interval > 0) {
+    if (interval > 0.0f) {
         float progressDelta = distKm / interval;
 
         // Rain Mode: Double wear -> Double progression
         if (rainMode) {
-            progressDelta *= 2.0;
+            progressDelta *= 2.0f;
         }
 
         currentProgress += progressDelta;
@@ -1113,7 +1440,7 @@ void Oiler::processDistance(double distKm, float speedKmh) {
         // Oiling Trigger
         // Changed to 100% (1.0) to ensure accurate intervals
         // We subtract 1.0 instead of resetting to 0.0 to carry over any remainder
-        if (currentProgress >= 1.0) {
+        if (currentProgress >= 1.0f) {
             
             // Turn Safety Logic (Delayed Oiling)
             // If we are leaning significantly towards the tire (unsafe side), we delay the oiling.
@@ -1124,7 +1451,7 @@ void Oiler::processDistance(double distKm, float speedKmh) {
             if (oilingDelayed) {
                 // We are already delayed. Wait until we are strictly upright or leaning safe.
                 // Threshold 5.0 deg allows for slight wobble but ensures we are out of the turn.
-                if (imu.isLeaningTowardsTire(5.0)) {
+                if (imu.isLeaningTowardsTire(5.0f)) {
                     unsafeToOil = true; // Still unsafe
                 } else {
                     unsafeToOil = false; // Safe now!
@@ -1133,7 +1460,7 @@ void Oiler::processDistance(double distKm, float speedKmh) {
             } else {
                 // New trigger. Check if we are currently in a turn.
                 // Threshold 20.0 deg is for significant turns.
-                if (imu.isLeaningTowardsTire(20.0)) {
+                if (imu.isLeaningTowardsTire(20.0f)) {
                     unsafeToOil = true;
                     oilingDelayed = true;
                 }
@@ -1149,16 +1476,18 @@ void Oiler::processDistance(double distKm, float speedKmh) {
             int head = history.head;
             history.oilingRange[head] = activeRangeIndex;
             for(int i=0; i<NUM_RANGES; i++) {
-                history.timeInRanges[head][i] = currentIntervalTime[i];
-                currentIntervalTime[i] = 0.0; // Reset for next interval
+                uint32_t seconds = currentIntervalTime[i] / 10;
+                history.timeInRanges[head][i] = (seconds > 65535) ? 65535 : (uint16_t)seconds;
+                currentIntervalTime[i] = 0; // Reset for next interval
             }
             history.head = (head + 1) % 20;
             if (history.count < 20) history.count++;
+            oilingPending = true; // Journaled by the next saveProgress()
 
             triggerOil(ranges[activeRangeIndex].pulses);
-            currentProgress -= 1.0; // Carry over remainder
-            if (currentProgress < 0.0) currentProgress = 0.0; // Safety clamp
-            saveProgress(); // Save progress
+            currentProgress -= 1.0f; // Carry over remainder
+            if (currentProgress < 0.0f) currentProgress = 0.0f; // Safety clamp
+            requestSave(PENDING_PROGRESS); // Written by loop() after the pulses
         }
     }
 }
@@ -1185,6 +1514,7 @@ void Oiler::triggerOil(int pulses) {
 
     // Initialize Non-Blocking Oiling
     isOiling = true;
+    scheduler.wake(TASK_PUMP);
     pumpActivityStartTime = millis(); // Safety Cutoff Start
     oilingPulsesRemaining = pulses;
     pulseState = false; // Will start with HIGH in handleOiling
@@ -1192,6 +1522,26 @@ void Oiler::triggerOil(int pulses) {
     
     // LED Indication
     ledOilingEndTimestamp = millis() + 3000;
+
+    if (recorder) recordOiling(pulses);
+}
+
+void Oiler::recordOiling(int pulses) {
+    FlightRecorder::Entry e;
+    e.time = recorder->now();
+    e.lat = lastLat;
+    e.lon = lastLon;
+    e.speedKmh = currentSpeed;
+    e.leanDeg = imu.getRoll();
+    e.tempC = currentTempC;
+    e.pulseMs = (uint16_t)dynamicPulseMs;
+    e.pauseMs = (uint16_t)dynamicPauseMs;
+    e.pulses = (uint8_t)constrain(pulses, 0, 255);
+    e.flags = (rainMode ? FlightRecorder::FLAG_RAIN : 0) | (offroadMode ? FlightRecorder::FLAG_OFFROAD : 0) |
+              (emergencyMode ? FlightRecorder::FLAG_EMERGENCY : 0) | (flushMode ? FlightRecorder::FLAG_FLUSH : 0) |
+              (hasFix ? 0 : FlightRecorder::FLAG_NO_FIX);
+    e.tankMl = currentTankLevelMl;
+    recorder->append(e); // One 24-byte write (plus an erase every 170 oilings)
 }
 
 void Oiler::processPump() {
@@ -1199,6 +1549,7 @@ void Oiler::processPump() {
 
     // IMU Safety Cutoff (Latch)
     if (crashTripped) {
+        pumpTrain.abort();
         if (PUMP_USE_PWM) {
 #ifdef ESP32
             ledcWrite(_pumpPin, 0);
@@ -1211,8 +1562,12 @@ void Oiler::processPump() {
         return;
     }
 
-    // 1. Update State Machine
-    updatePumpPulse();
+    // 1. Update State Machine (or account the pulses of the hardware train)
+    if (pumpTrain.available()) {
+        if (processPumpTrain()) return;
+    } else {
+        updatePumpPulse();
+    }
 
     // Refresh 'now' because updatePumpPulse might have taken time or updated lastPulseTime
     now = millis();
@@ -1245,18 +1600,7 @@ void Oiler::processPump() {
             return; // Done
         }
 
-        // Countdown Log (every 1s)
-        static unsigned long lastBleedingLog = 0;
-        if (now - lastBleedingLog > 1000) {
-            lastBleedingLog = now;
-            unsigned long remaining = (bleedingStartTime + currentBleedingDuration - now) / 1000;
-            // +1 to show "20s" instead of "19s" at start, and "1s" at end
-            remaining++; 
-            
-            String msg = "Bleeding... " + String(remaining) + "s";
-            Serial.println(msg);
-            webConsole.log(msg);
-        }
+        logBleedingCountdown(now);
 
     } else if (!isOiling) {
         // Not bleeding and not oiling -> Idle
@@ -1278,7 +1622,15 @@ void Oiler::processPump() {
             return; // not yet time for next pulse
         }
 
-        startPulse(BLEEDING_PULSE_MS);
+        if (pumpTrain.available()) {
+            // Every pulse that starts within the bleeding duration, in one train
+            unsigned long left = bleedingStartTime + currentBleedingDuration - now;
+            unsigned long count = left / (BLEEDING_PULSE_MS + BLEEDING_PAUSE_MS) + 1;
+            pumpTrain.setRamp(0, 0); // Hard kick, hard stop
+            pumpTrain.start(count > 0xFFFF ? 0xFFFF : (uint16_t)count, BLEEDING_PULSE_MS, BLEEDING_PAUSE_MS);
+        } else {
+            startPulse(BLEEDING_PULSE_MS);
+        }
         return; // Skip all other logic in Bleeding Mode
     }
 
@@ -1294,8 +1646,59 @@ void Oiler::processPump() {
              return;
         }
 
-        // Start Non-Blocking Pulse
-        startPulse(effectivePulse);
+        // Start Non-Blocking Pulse (or all remaining pulses in hardware)
+        if (pumpTrain.available()) {
+            if (PUMP_USE_PWM) {
+                // Same shape as startPulse(): full duty after the ramp up, ramp down on top
+                pumpTrain.setRamp(PUMP_RAMP_UP_MS, PUMP_RAMP_DOWN_MS);
+#if PUMP_RAMP_UP_MS > 0 // Unsigned compare with 0 is always false (-Wtype-limits)
+                if (effectivePulse < PUMP_RAMP_UP_MS) effectivePulse = PUMP_RAMP_UP_MS;
+#endif
+                effectivePulse += PUMP_RAMP_DOWN_MS;
+            }
+            pumpTrain.start((uint16_t)oilingPulsesRemaining, effectivePulse, effectivePause);
+        } else {
+            startPulse(effectivePulse);
+        }
+    }
+}
+
+bool Oiler::processPumpTrain() {
+    uint16_t done = pumpTrain.poll();
+    for (uint16_t i = 0; i < done; i++) handlePulseFinished();
+    if (done > 0) lastPulseTime = pumpTrain.lastPulseEndMs(); // When it ended, not when seen
+
+    if (!pumpTrain.running()) return false;
+
+    if (pumpTrain.overdue()) {
+        Serial.println("[CRITICAL] Safety Cutoff triggered! Pump stuck.");
+        pumpTrain.abort();
+        isOiling = false;
+        bleedingMode = false;
+        return true;
+    }
+
+    if (bleedingMode) {
+        logBleedingCountdown(millis());
+    } else if (imu.isLeaningTowardsTire(20.0)) {
+        // Turn Safety Check: the running pulse ends, the rest starts after the turn
+        pumpTrain.hold();
+    }
+    return true;
+}
+
+void Oiler::logBleedingCountdown(unsigned long now) {
+    // Countdown Log (every 1s)
+    static unsigned long lastBleedingLog = 0;
+    if (now - lastBleedingLog > 1000) {
+        lastBleedingLog = now;
+        unsigned long remaining = (bleedingStartTime + currentBleedingDuration - now) / 1000;
+        // +1 to show "20s" instead of "19s" at start, and "1s" at end
+        remaining++; 
+        
+        String msg = "Bleeding... " + String(remaining) + "s";
+        Serial.println(msg);
+        webConsole.log(msg);
     }
 }
 
@@ -1463,6 +1866,7 @@ void Oiler::setRainMode(bool mode) {
 
     if (mode && !rainMode) {
         rainModeStartTime = millis();
+        scheduler.wake(TASK_RAIN);
         webConsole.log("Rain Mode: ON");
         Serial.println("Rain Mode: ON");
     } else if (!mode && rainMode) {
@@ -1482,6 +1886,7 @@ void Oiler::setFlushMode(bool mode) {
     if (mode && !flushMode) {
         flushModeStartTime = millis();
         lastFlushOilTime = millis(); // Reset interval timer
+        scheduler.wake(TASK_FLUSH);
         flushEventsRemaining = flushConfigEvents; // Reset counter
 #ifdef GPS_DEBUG
         Serial.println("Chain Flush Mode ACTIVATED");
@@ -1497,6 +1902,7 @@ void Oiler::setFlushMode(bool mode) {
 void Oiler::setOffroadMode(bool mode) {
     if (mode && !offroadMode) {
         lastOffroadOilTime = millis(); // Reset timer on start
+        scheduler.wake(TASK_OFFROAD);
 #ifdef GPS_DEBUG
         Serial.println("Offroad Mode ACTIVATED");
 #endif
@@ -1538,6 +1944,7 @@ void Oiler::startBleeding() {
             // Start new bleeding session
             bleedingMode = true;
             bleedingStartTime = now;
+            scheduler.wake(TASK_PUMP);
             currentBleedingDuration = BLEEDING_DURATION_MS;
             bleedingSessionConsumed = 0.0; // Reset counter
             pumpActivityStartTime = now; // Safety Cutoff Start
@@ -1574,7 +1981,7 @@ SpeedRange* Oiler::getRangeConfig(int index) {
 }
 
 bool Oiler::isTempSensorConnected() {
-    return sensors->getDeviceCount() > 0;
+    return tempSensors.getCount() > 0;
 }
 
 bool Oiler::isButtonPressed() {
@@ -1583,41 +1990,23 @@ bool Oiler::isButtonPressed() {
 }
 
 void Oiler::rebuildLUT() {
-    // 1. Define Anchors (Center points of ranges)
-    struct Anchor { float speed; float interval; };
-    Anchor anchors[NUM_RANGES];
-
+    float intervals[NUM_RANGES];
+    bool isDefault = true;
     for(int i=0; i<NUM_RANGES; i++) {
-        float center;
-        if (i == NUM_RANGES - 1) {
-            // Last range (e.g. 95-999). Use start + 10km/h as anchor to avoid stretching
-            center = ranges[i].minSpeed + 10.0;
-        } else {
-            center = (ranges[i].minSpeed + ranges[i].maxSpeed) / 2.0;
-        }
-        anchors[i].speed = center;
-        anchors[i].interval = ranges[i].intervalKm;
+        intervals[i] = ranges[i].intervalKm;
+        if (intervals[i] != rangeIntervalDefaults[i]) isDefault = false;
+    }
+
+    // Default profile: table generated at compile time
+    if (isDefault) {
+        rangeLUT = defaultRangeLUT.e;
+        return;
     }
 
-    // 2. Fill LUT with linear interpolation
     for (int i=0; i<LUT_SIZE; i++) {
-        float speed = i * LUT_STEP;
-        
-        if (speed <= anchors[0].speed) {
-            intervalLUT[i] = anchors[0].interval;
-        } else if (speed >= anchors[NUM_RANGES-1].speed) {
-            intervalLUT[i] = anchors[NUM_RANGES-1].interval;
-        } else {
-            // Interpolate between anchors
-            for (int j=0; j<NUM_RANGES-1; j++) {
-                if (speed >= anchors[j].speed && speed < anchors[j+1].speed) {
-                    float slope = (anchors[j+1].interval - anchors[j].interval) / (anchors[j+1].speed - anchors[j].speed);
-                    intervalLUT[i] = anchors[j].interval + slope * (speed - anchors[j].speed);
-                    break;
-                }
-            }
-        }
+        customLUT[i] = lutEntry(intervals, i);
     }
+    rangeLUT = customLUT;
 }
 
 void Oiler::setTankFill(float levelMl) {
@@ -1644,8 +2033,7 @@ void Oiler::setUpdateMode(bool mode) {
 
 // --- NEW: Temperature Compensation Logic ---
 void Oiler::updateTemperature() {
-    sensors->requestTemperatures(); 
-    float tempC = sensors->getTempCByIndex(0);
+    float tempC = tempSensors.getTempC(0); // Read by the last cycle
 
     // Check for error (-127 is error)
     if (tempC == DEVICE_DISCONNECTED_C) {
@@ -1663,37 +2051,11 @@ void Oiler::updateTemperature() {
     lastTemp = tempC;
     currentTempC = tempC;
 
-    // 1. Calculate Viscosity using Arrhenius Equation
-    // Constants derived from ISO VG 85 Oil (84.2 mm²/s @ 40°C, 11.2 mm²/s @ 100°C)
-    // Formula: ln(v) = A + B/T
-    const float A = -8.122;
-    const float B = 3931.8;
-    
-    float tempK = currentTempC + 273.15;
-    float viscosityCurrent = exp(A + (B / tempK));
-    
-    // Reference Viscosity at 25°C
-    float tempRefK = 25.0 + 273.15;
-    float viscosityRef = exp(A + (B / tempRefK)); // ~158.4 mm²/s
-
-    // 2. Determine Compensation Aggressiveness based on Oil Type Setting
-    // The pump pulse doesn't need to scale 1:1 with viscosity.
-    // We use an exponent to tune how "hard" the system reacts to viscosity changes.
-    // Updated based on real-world calibration at 10°C: Pump is very efficient, needs less compensation.
-    float compensationExponent = 0.25; // Default Normal
-    
-    switch (tempConfig.oilType) {
-        case OIL_THIN:   compensationExponent = 0.15; break; // Gentle compensation (Was 0.3)
-        case OIL_NORMAL: compensationExponent = 0.25; break; // Normal compensation (Was 0.5)
-        case OIL_THICK:  compensationExponent = 0.35; break; // Aggressive compensation (Was 0.7)
-    }
-
-    // 3. Calculate Factor
+    // 1. Viscosity Factor (Arrhenius, exponent per oil type), precomputed per 0.5°C
     // Ratio > 1.0 means oil is thicker than at 25°C
-    float viscosityRatio = viscosityCurrent / viscosityRef;
-    float factor = pow(viscosityRatio, compensationExponent);
+    float factor = ViscosityTable::factor((uint8_t)tempConfig.oilType, currentTempC);
 
-    // 4. Apply Factor
+    // 2. Apply Factor
     unsigned long newPulse = (unsigned long)(tempConfig.basePulse25 * factor);
     unsigned long newPause = (unsigned long)(tempConfig.basePause25 * factor);
 
@@ -6,11 +6,79 @@
 #include <Adafruit_NeoPixel.h>
 #include "ImuHandler.h"
 #include "Persistence.h"
+#include "SpeedRanges.h"
+#include "ConfigStore.h"
+#include "ProgressJournal.h"
+#include "Odometer.h"
+#include "GeoDistance.h"
+#include "SpeedEstimator.h"
+#include "DeadlineScheduler.h"
+#include "LedRenderer.h"
+#include "PulseTrain.h"
+#include "TempSensors.h"
+#include "FlightRecorder.h"
 
-#define SPEED_BUFFER_SIZE 5
 #define LUT_STEP 5
 #define LUT_MAX_SPEED ((int)MAX_SPEED_KMH)
 #define LUT_SIZE ((LUT_MAX_SPEED / LUT_STEP) + 1)
+#define LUT_NO_RANGE -1
+
+// loop() deadlines
+#define INPUT_POLL_MS 10     // IMU reports (50 Hz accel) and button debounce
+#define LED_FRAME_MS 20      // LED animation frame (50 Hz)
+#define TASK_RECHECK_MS 1000 // Inactive modes look again after this (setters wake them at once)
+
+enum OilerTask : uint8_t {
+    TASK_INPUT,
+    TASK_PUMP,
+    TASK_OFFROAD,
+    TASK_FLUSH,
+    TASK_TEMP,
+    TASK_RAIN,
+    TASK_LED,
+    TASK_COUNT
+};
+
+// Status LED patterns, highest priority first (see ledPatterns[] in Oiler.cpp)
+enum LedState : uint8_t {
+    LED_STATE_UPDATE,
+    LED_STATE_CRASH,
+    LED_STATE_BLEEDING,
+    LED_STATE_FLUSH,
+    LED_STATE_OFFROAD,
+    LED_STATE_WIFI,
+    LED_STATE_OILING,
+    LED_STATE_STOP_TANK_EMPTY,
+    LED_STATE_STOP_TANK_LOW,
+    LED_STATE_STOP_RAIN,
+    LED_STATE_STOP_OK,
+    LED_STATE_TANK_LOW,
+    LED_STATE_NO_FIX_EMERGENCY,
+    LED_STATE_NO_FIX,
+    LED_STATE_EMERGENCY,
+    LED_STATE_RAIN,
+    LED_STATE_READY,
+    LED_STATE_AUX_OFF,
+    LED_STATE_AUX_POWER,
+    LED_STATE_AUX_BOOST,
+    LED_STATE_AUX_LOW,
+    LED_STATE_AUX_MED_LOW,
+    LED_STATE_AUX_MED_HIGH,
+    LED_STATE_AUX_HIGH,
+    LED_STATE_COUNT
+};
+
+/**
+ * One LUT_STEP bucket of the speed lookup table: interval at the start of the bucket,
+ * slope up to the next bucket (linear interpolation inside the bucket) and the range
+ * the bucket belongs to. Range bounds are multiples of LUT_STEP, so a bucket never
+ * spans two ranges.
+ */
+struct RangeLutEntry {
+    float intervalKm;  // Interval at speed i * LUT_STEP
+    float slope;       // km per km/h within the bucket
+    int8_t range;      // Range index, LUT_NO_RANGE below/above all ranges
+};
 
 enum PumpState {
     PUMP_IDLE,
@@ -21,17 +89,36 @@ enum PumpState {
 
 class Oiler {
 public:
-    Oiler(IPersistence* store, int pumpPin, int ledPin, int tempPin);
+    // pulseGen: hardware pulse trains for the pump (nullptr: pulses timed by loop())
+    Oiler(IPersistence* store, int pumpPin, int ledPin, int tempPin, IPulseGenerator* pulseGen = nullptr);
     ImuHandler imu;
     void begin(int imuSda, int imuScl);
     void update(float speedKmh, double lat, double lon, bool gpsValid);
-    void loop(); // Main loop for button and LED
+    void loop(); // Main loop for button and LED: runs only the tasks that are due
+    uint32_t msUntilNextDue(); // Time the caller may sleep before the next loop()
+    uint32_t getLedFramesRendered() const { return ledRenderer.getFramesRendered(); }
+    uint32_t getLedFramesSkipped() const { return ledRenderer.getFramesSkipped(); }
+    const PulseTrain& getPumpTrain() const { return pumpTrain; }
+    const TempSensors& getTempSensors() const { return tempSensors; }
     void saveConfig();
     void saveProgress(); // Public for manual saving
+    void setProgressJournal(ProgressJournal* journal) { this->journal = journal; } // Before begin()
+    void setFlightRecorder(FlightRecorder* recorder) { this->recorder = recorder; } // One record per triggerOil()
+    // Saves requested while the pump runs are written by loop() once it is idle
+    // (at once with a pulse generator, whose pulses a flash write cannot stretch).
+    // force = write now regardless of the pump (e.g. ignition off).
+    void flushPendingSaves(bool force = false);
+    bool hasPendingSaves() { return pendingSaves != 0; }
+    uint32_t getMaxSaveStallUs() { return maxSaveStallUs; } // Longest deferred flush (loop blocked)
     
     // --- Configuration Getters ---
     SpeedRange* getRangeConfig(int index);
 
+    // Settings by key ("tc_pulse", "r2_km", see oilerParams in Oiler.cpp), e.g. for remote
+    // access. setParam() clamps to the valid range and applies; saveConfig() persists.
+    bool getParam(const char* key, float& value);
+    bool setParam(const char* key, float value);
+
     // Temperature Configuration
     enum OilType {
         OIL_THIN = 0,
@@ -52,7 +139,7 @@ public:
     
     // --- Logging & Stats Getters ---
     float getSmoothedSpeed() { return currentSpeed; }
-    double getOdometer() { return totalDistance; }
+    double getOdometer() { return odometer.km(); }
     float getCurrentDistAccumulator() { return currentProgress * smoothedInterval; }
     float getCurrentTargetDistance() { return smoothedInterval; }
     bool isPumpRunning() { return isOiling; }
@@ -91,26 +178,33 @@ public:
     void setUpdateMode(bool mode);
 
     // Stats
-    double getTotalDistance() { return totalDistance; }
+    double getTotalDistance() { return odometer.km(); }
     unsigned long getPumpCycles() { return pumpCycles; }
     void resetStats();
     
     // Session Stats (Accumulated since boot)
-    uint32_t sessionTimeInRanges[NUM_RANGES]; // Seconds in each range
-    uint32_t* getSessionStats() { return sessionTimeInRanges; }
+    typedef uint32_t RangeSeconds[NUM_RANGES];
+    RangeSeconds sessionTimeInRanges; // Seconds in each range
+    const RangeSeconds& getSessionStats() const { return sessionTimeInRanges; } // Sized for the LoRa encoder
 
     // Time Stats (History for last 20 oilings)
+    // Whole seconds per range, saturating at 65535 s (18 h per interval and range).
     struct StatsHistory {
         uint8_t head;
         uint8_t count;
         int8_t oilingRange[20];
-        double timeInRanges[20][NUM_RANGES];
+        uint16_t timeInRanges[20][NUM_RANGES];
     };
     
     StatsHistory history;
-    double currentIntervalTime[NUM_RANGES]; // Time accumulated in current interval (not yet oiled)
+    // Time accumulated in current interval (not yet oiled), deciseconds.
+    // Fixed-point: no soft-float double math in the GPS path.
+    uint32_t currentIntervalTime[NUM_RANGES];
+    void addIntervalTime(int rangeIndex, float seconds);
+    float getIntervalTimeSeconds(int rangeIndex) const { return currentIntervalTime[rangeIndex] * 0.1f; }
     
-    // Helper to get summed stats for UI
+    // Helper to get summed stats for UI (history + current interval)
+    uint16_t getHistoryTimeSeconds(int event, int rangeIndex) const { return history.timeInRanges[event][rangeIndex]; }
     double getRecentTimeSeconds(int rangeIndex);
     int getRecentOilingCount(int rangeIndex);
     double getRecentTotalTime();
@@ -185,31 +279,35 @@ private:
     int auxMode = 0; // 0=OFF, 1=SMART, 2=GRIPS
     bool auxBoost = false;
 
-    void processDistance(double distKm, float speedKmh);
+    void processDistance(float distKm, float speedKmh); // Single precision: hot path
     
     int _pumpPin;
     int _tempPin;
     int currentHour;
     bool updateMode;
     SpeedRange ranges[NUM_RANGES];
-    float intervalLUT[LUT_SIZE]; // Lookup Table for smoothed intervals
-    void rebuildLUT(); // Helper to fill LUT
+    const RangeLutEntry* rangeLUT; // Default profile (flash, built at compile time) or customLUT
+    RangeLutEntry customLUT[LUT_SIZE];
+    void rebuildLUT(); // Selects or fills the LUT for the configured intervals
 
     float currentProgress; // 0.0 to 1.0 (1.0 = Oiling due)
     
     double lastLat;
     double lastLon;
+    GeoDistance hopDistance; // Caches cos(lat) of the ride segment
     bool hasFix;
     unsigned long lastSaveTime;
     bool progressChanged;
 
     // Stats
-    double totalDistance;
+    Odometer odometer; // Fixed-point, stored as "totalDist" (double km)
     unsigned long pumpCycles;
 
-    // GPS Smoothing
-    float speedBuffer[SPEED_BUFFER_SIZE];
-    int speedBufferIndex;
+    // GPS Smoothing (fused with IMU forward acceleration)
+    SpeedEstimator speedEstimator;
+
+    DeadlineScheduler<TASK_COUNT> scheduler;
+    bool isPumpBusy() const { return pumpState != PUMP_IDLE || isOiling || bleedingMode; }
 
     // Button & Modes
     bool rainMode;
@@ -237,16 +335,79 @@ private:
     
     // LED
     Adafruit_NeoPixel strip;
+    LedRenderer ledRenderer;
     unsigned long lastLedUpdate;
     void updateLED();
+    LedState selectLedState(unsigned long now);
+    LedState selectAuxLedState();
     void handleButton();
     void processPump(); // Unified pump logic
 
     void loadConfig();
-    void validateConfig();
     // saveProgress is public
     // triggerOil is public
 
+    // Settings are stored in the ConfigStore record, runtime state in separate keys.
+    // Keys, defaults and ranges: oilerParams in Oiler.cpp
+    void migrateLegacySettings(); // Write record, remove old keys
+    bool hasLegacyRangeData(); // Range keys/blobs of firmware before range tables
+    void applySettings(const OilerSettings& s);
+    void exportSettings(OilerSettings& s);
+
+    // Shadow of the last persisted runtime values. Saves only write fields that differ,
+    // e.g. a Rain Mode toggle writes one bool.
+    struct PersistedState {
+        bool rainMode;
+        bool emergencyMode;
+        float currentTankLevelMl;
+        float currentProgress;
+        uint64_t odometerMm;
+        unsigned long pumpCycles;
+        uint32_t historyCrc; // History blob is tracked by checksum (saves a second copy in RAM)
+        uint32_t currentIntervalTime[NUM_RANGES];
+    };
+    PersistedState persisted;
+    bool persistedValid; // false -> next save writes everything
+    bool rangeTableChanged = false; // Stored stats are from another RANGE_PROFILE (during loadConfig)
+
+    void snapshotPersisted();
+
+    // Deferred saves: time-critical paths only request, loop() writes when the pump is idle
+    enum PendingSave : uint8_t {
+        PENDING_PROGRESS = 0x01,
+        PENDING_CONFIG = 0x02 // Includes progress
+    };
+    uint8_t pendingSaves;
+    uint32_t maxSaveStallUs;
+    void requestSave(uint8_t what) { pendingSaves |= what; }
+    // Full checkpoint of all runtime counters (fields that differ from shadow), returns its id.
+    // The shadow copy is taken over by finishCheckpoint() once the transaction is committed.
+    uint32_t saveStats(PersistedState& shadow);
+    void finishCheckpoint(uint32_t ckpt, const PersistedState& shadow, bool committed);
+
+    // Progress journal: deltas against the last checkpoint (nullptr = always full saves)
+    ProgressJournal* journal = nullptr;
+    uint32_t checkpointId;             // Stored as "ckpt" with every checkpoint
+    uint64_t checkpointOdometerMm;     // Odometer at the last checkpoint
+    unsigned long checkpointPumpCycles;
+    unsigned long lastCheckpointTime;
+    uint16_t journalRecords;           // Records appended since the last checkpoint
+    bool oilingPending;                // New history entry not yet journaled
+    bool appendJournal();
+    void replayJournal();
+    static void onJournalRecord(void* context, uint8_t type, const void* payload);
+
+    FlightRecorder* recorder = nullptr;
+    void recordOiling(int pulses);
+
+    // Field of a staged shadow copy (saveStats) differs -> put it
+    template <typename T>
+    bool changed(T& shadow, const T& value) {
+        if (persistedValid && shadow == value) return false;
+        shadow = value;
+        return true;
+    }
+
     // Emergency update and standstill save time
     unsigned long lastEmergUpdate;
     unsigned long lastStandstillSaveTime;
@@ -267,9 +428,14 @@ private:
     int pumpCurrentDuty = 0;
     unsigned long pumpLastStepTime = 0;
 
+    PulseTrain pumpTrain; // Used instead of the state machine above when a generator is set
+    TempSensors tempSensors;
+
     void startPulse(unsigned long durationMs);
     void updatePumpPulse();
     void handlePulseFinished();
+    bool processPumpTrain(); // true while a train runs
+    void logBleedingCountdown(unsigned long now);
 
     // Temperature Compensation
     float currentTempC;
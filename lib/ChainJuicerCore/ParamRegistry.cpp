@@ -0,0 +1,144 @@
+#include "ParamRegistry.h"
+
+static size_t typeSize(ParamType type) {
+    switch (type) {
+        case PARAM_BOOL: return sizeof(bool);
+        case PARAM_U8: return sizeof(uint8_t);
+        case PARAM_I32: return sizeof(int32_t);
+        default: return sizeof(float);
+    }
+}
+
+// Values pass through float: exact for integers up to 2^24, plenty for settings
+static float readValue(const ParamDesc& p, const void* settings, uint8_t i) {
+    const uint8_t* field = (const uint8_t*)settings + p.offset;
+    switch (p.type) {
+        case PARAM_BOOL: return ((const bool*)field)[i] ? 1.0f : 0.0f;
+        case PARAM_U8: return ((const uint8_t*)field)[i];
+        case PARAM_I32: return (float)((const int32_t*)field)[i];
+        default: return ((const float*)field)[i];
+    }
+}
+
+static void writeValue(const ParamDesc& p, void* settings, uint8_t i, float value) {
+    uint8_t* field = (uint8_t*)settings + p.offset;
+    switch (p.type) {
+        case PARAM_BOOL: ((bool*)field)[i] = (value != 0.0f); break;
+        case PARAM_U8: ((uint8_t*)field)[i] = (uint8_t)lroundf(value); break;
+        case PARAM_I32: ((int32_t*)field)[i] = (int32_t)lroundf(value); break;
+        default: ((float*)field)[i] = value; break;
+    }
+}
+
+static float defaultValue(const ParamDesc& p, uint8_t i) {
+    return p.defs ? p.defs[i] : p.def;
+}
+
+// Finds a key; index receives the array element
+static const ParamDesc* findParam(const ParamTable& t, const char* key, uint8_t& index) {
+    char buf[PARAM_MAX_KEY_LEN];
+    for (uint8_t n = 0; n < t.count; n++) {
+        const ParamDesc& p = t.params[n];
+        for (uint8_t i = 0; i < p.count; i++) {
+            paramKey(p, i, buf, sizeof(buf));
+            if (strcmp(buf, key) == 0) {
+                index = i;
+                return &p;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void paramKey(const ParamDesc& p, uint8_t index, char* buf, size_t len) {
+    if (p.count > 1) {
+        snprintf(buf, len, p.key, (unsigned)index);
+    } else {
+        strncpy(buf, p.key, len - 1);
+        buf[len - 1] = '\0';
+    }
+}
+
+void paramDefaults(const ParamTable& t, void* settings) {
+    for (uint8_t n = 0; n < t.count; n++) {
+        const ParamDesc& p = t.params[n];
+        for (uint8_t i = 0; i < p.count; i++) {
+            writeValue(p, settings, i, defaultValue(p, i));
+        }
+    }
+}
+
+void paramLoadLegacy(const ParamTable& t, IPersistence* store, void* settings) {
+    char key[PARAM_MAX_KEY_LEN];
+    store->begin(t.ns, true);
+    for (uint8_t n = 0; n < t.count; n++) {
+        const ParamDesc& p = t.params[n];
+        uint8_t* field = (uint8_t*)settings + p.offset;
+        for (uint8_t i = 0; i < p.count; i++) {
+            paramKey(p, i, key, sizeof(key));
+            switch (p.type) {
+                case PARAM_BOOL: ((bool*)field)[i] = store->getBool(key, ((bool*)field)[i]); break;
+                case PARAM_U8: field[i] = store->getUChar(key, field[i]); break;
+                case PARAM_I32: ((int32_t*)field)[i] = store->getInt(key, ((int32_t*)field)[i]); break;
+                default: ((float*)field)[i] = store->getFloat(key, ((float*)field)[i]); break;
+            }
+        }
+    }
+    store->end();
+}
+
+void paramRemoveLegacy(const ParamTable& t, IPersistence* store) {
+    char key[PARAM_MAX_KEY_LEN];
+    store->begin(t.ns, false);
+    for (uint8_t n = 0; n < t.count; n++) {
+        const ParamDesc& p = t.params[n];
+        for (uint8_t i = 0; i < p.count; i++) {
+            paramKey(p, i, key, sizeof(key));
+            store->remove(key);
+        }
+    }
+    store->end();
+}
+
+int paramValidate(const ParamTable& t, void* settings) {
+    int corrected = 0;
+    for (uint8_t n = 0; n < t.count; n++) {
+        const ParamDesc& p = t.params[n];
+        for (uint8_t i = 0; i < p.count; i++) {
+            float v = readValue(p, settings, i);
+            float c = isnan(v) ? defaultValue(p, i) : constrain(v, p.min, p.max);
+            if (c != v || isnan(v)) {
+                writeValue(p, settings, i, c);
+                corrected++;
+            }
+        }
+    }
+    return corrected;
+}
+
+uint32_t paramDiff(const ParamTable& t, const void* a, const void* b) {
+    uint32_t mask = 0;
+    for (uint8_t n = 0; n < t.count && n < 32; n++) {
+        const ParamDesc& p = t.params[n];
+        if (memcmp((const uint8_t*)a + p.offset, (const uint8_t*)b + p.offset, typeSize(p.type) * p.count) != 0) {
+            mask |= (1UL << n);
+        }
+    }
+    return mask;
+}
+
+bool paramGet(const ParamTable& t, const void* settings, const char* key, float& value) {
+    uint8_t index;
+    const ParamDesc* p = findParam(t, key, index);
+    if (!p) return false;
+    value = readValue(*p, settings, index);
+    return true;
+}
+
+bool paramSet(const ParamTable& t, void* settings, const char* key, float value) {
+    uint8_t index;
+    const ParamDesc* p = findParam(t, key, index);
+    if (!p || isnan(value)) return false;
+    writeValue(*p, settings, index, constrain(value, p->min, p->max));
+    return true;
+}
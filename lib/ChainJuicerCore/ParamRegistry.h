@@ -0,0 +1,79 @@
+#ifndef PARAM_REGISTRY_H
+#define PARAM_REGISTRY_H
+
+#include <Arduino.h>
+#include <stddef.h>
+#include "Persistence.h"
+
+/**
+ * Parameter registry: each module describes its settings struct once in a constexpr
+ * table (key, type, offset, default, range). Defaults, migration of per-key settings,
+ * validation, change detection and remote access are single linear passes over that
+ * table instead of hand-written key lists.
+ */
+
+enum ParamType : uint8_t {
+    PARAM_BOOL,
+    PARAM_U8,
+    PARAM_I32,
+    PARAM_F32
+};
+
+/**
+ * Describes one setting inside a settings struct (OilerSettings, ImuSettings, AuxSettings).
+ * Arrays (count > 1) use a key pattern with %u for the index, e.g. "r%u_km".
+ */
+struct ParamDesc {
+    const char* key;    // Per-key name of older firmware, also the name for remote access
+    ParamType type;
+    uint8_t count;      // Array elements (1 = scalar)
+    uint16_t offset;    // offsetof() in the settings struct
+    float def;          // Default (all elements unless defs is set)
+    float min;          // Validation range, values are clamped
+    float max;
+    const float* defs;  // Optional per-element defaults (count entries)
+};
+
+struct ParamTable {
+    const char* ns;     // Namespace of the per-key settings of older firmware
+    const ParamDesc* params;
+    uint8_t count;
+};
+
+#define PARAM_MAX_KEY_LEN 16
+
+// One line per setting, e.g. PARAM(PARAM_U8, OilerSettings, ledBrightnessDim, "led_dim", 64, 2, 202)
+#define PARAM(type, Struct, field, key, def, min, max) \
+    { key, type, 1, (uint16_t)offsetof(Struct, field), (float)(def), (float)(min), (float)(max), nullptr }
+#define PARAM_ARRAY(type, Struct, field, key, def, min, max) \
+    { key, type, PARAM_COUNT(Struct, field), (uint16_t)offsetof(Struct, field), \
+      (float)(def), (float)(min), (float)(max), nullptr }
+#define PARAM_ARRAY_DEFS(type, Struct, field, key, defs, min, max) \
+    { key, type, PARAM_COUNT(Struct, field), (uint16_t)offsetof(Struct, field), \
+      (defs)[0], (float)(min), (float)(max), defs }
+#define PARAM_COUNT(Struct, field) (uint8_t)(sizeof(((Struct*)0)->field) / sizeof(((Struct*)0)->field[0]))
+#define PARAM_TABLE(ns, params) { ns, params, (uint8_t)(sizeof(params) / sizeof(params[0])) }
+
+#define PARAM_UNLIMITED 1e9f
+
+// Fills all described fields with their defaults (other fields are left alone)
+void paramDefaults(const ParamTable& t, void* settings);
+
+// Per-key values of older firmware (missing keys keep the current value)
+void paramLoadLegacy(const ParamTable& t, IPersistence* store, void* settings);
+void paramRemoveLegacy(const ParamTable& t, IPersistence* store);
+
+// Clamps all values to their range. Returns the number of corrected values.
+int paramValidate(const ParamTable& t, void* settings);
+
+// Bit i set = table entry i differs between a and b (first 32 entries)
+uint32_t paramDiff(const ParamTable& t, const void* a, const void* b);
+
+// Remote access by key ("tc_pulse", "r2_km"). Set clamps; both return false for unknown keys.
+bool paramGet(const ParamTable& t, const void* settings, const char* key, float& value);
+bool paramSet(const ParamTable& t, void* settings, const char* key, float value);
+
+// Key of an element: "r2_km" for pattern "r%u_km" and index 2
+void paramKey(const ParamDesc& p, uint8_t index, char* buf, size_t len);
+
+#endif
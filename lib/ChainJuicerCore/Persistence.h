@@ -2,6 +2,7 @@
 #define PERSISTENCE_H
 
 #include <Arduino.h>
+#include "WearStats.h"
 
 /**
  * Abstract Interface for Data Persistence.
@@ -18,6 +19,14 @@ public:
     
     // Clear
     virtual void clear() = 0;
+    virtual void remove(const char* key) = 0; // Delete a single key (not part of a transaction)
+
+    // Transactions
+    // All puts between beginTransaction() and commit() are stored together: after a power cut
+    // either all of them or none are visible. Backends without support write immediately.
+    // commit() returns false and writes nothing if the puts overflowed the staging buffer.
+    virtual void beginTransaction() {}
+    virtual bool commit() { return true; }
     
     // Integer
     virtual void putInt(const char* key, int32_t value) = 0;
@@ -47,6 +56,9 @@ public:
     virtual void putBytes(const char* key, const void* value, size_t len) = 0;
     virtual size_t getBytes(const char* key, void* buf, size_t maxLen) = 0;
     virtual size_t getBytesLength(const char* key) = 0;
+
+    // Flash wear counters since boot (nullptr if the backend does not track them)
+    virtual const WearStats* getWearStats() const { return nullptr; }
 };
 
 #endif
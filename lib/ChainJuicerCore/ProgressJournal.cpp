@@ -0,0 +1,194 @@
+#include "ProgressJournal.h"
+#include "Crc32.h"
+
+#define JOURNAL_PAGE_MAGIC 0x4C4E524A // "JRNL"
+#define JOURNAL_MAX_WORDS 15
+
+static_assert(sizeof(ProgressJournal::Delta) == 12, "Delta record must stay 16 bytes incl. header");
+static_assert((4 + sizeof(ProgressJournal::Oiling) + 3) / 4 <= JOURNAL_MAX_WORDS, "Too many ranges for an oiling record");
+
+ProgressJournal::ProgressJournal(IFlashDevice* flash) {
+    _flash = flash;
+}
+
+bool ProgressJournal::readPageHeader(uint32_t page, PageHeader& hdr) {
+    _flash->read(page * _flash->pageSize(), &hdr, sizeof(hdr));
+    return hdr.magic == JOURNAL_PAGE_MAGIC;
+}
+
+uint8_t ProgressJournal::recordCrc(const uint8_t* record, size_t len) {
+    uint32_t crc = crc32Update(0, record, 1);       // typeWords
+    crc = crc32Update(crc, record + 2, len - 2);   // checkpoint + payload (skip crc byte)
+    return (uint8_t)crc;
+}
+
+bool ProgressJournal::begin() {
+    if (_ready) return true;
+    if (!_flash->begin() || _flash->pageCount() != 2) {
+        Serial.println("Journal: Flash region unavailable");
+        return false;
+    }
+
+    // Head = valid page with the highest sequence
+    bool found = false;
+    for (uint32_t p = 0; p < 2; p++) {
+        PageHeader hdr;
+        if (readPageHeader(p, hdr) && (!found || hdr.seq > _headSeq)) {
+            _headPage = p;
+            _headSeq = hdr.seq;
+            found = true;
+        }
+    }
+
+    if (!found) {
+        Serial.println("Journal: Formatting");
+        format();
+    } else {
+        uint32_t ps = _flash->pageSize();
+        _headOffset = scanPage(_headPage, -1, nullptr, nullptr, nullptr);
+        // Appends need erased flash behind the last record. A record header torn by a
+        // power cut ends the scan, but its bytes are programmed: close the head page,
+        // the next append rotates to the other one.
+        if (_headOffset < ps && !_flash->isErased(_headPage * ps + _headOffset, ps - _headOffset)) {
+            Serial.printf("Journal: Page %lu not erased after @ %lu, closed\n", (unsigned long)_headPage, (unsigned long)_headOffset);
+            _headOffset = ps;
+        }
+        _headClosed = (_headOffset >= ps);
+    }
+
+    _ready = true;
+    return true;
+}
+
+bool ProgressJournal::format() {
+    // Both pages: no record of an earlier journal may survive
+    bool ok = _flash->erasePage(1) && _flash->erasePage(0);
+    _erases += 2;
+    PageHeader hdr = { 1, JOURNAL_PAGE_MAGIC };
+    ok = ok && _flash->write(0, &hdr, sizeof(hdr));
+    _headPage = 0;
+    _headSeq = 1;
+    _headOffset = sizeof(PageHeader);
+    _checkpoint = 0;
+    _checkpointBytes = 0;
+    _headClosed = false;
+    return ok;
+}
+
+bool ProgressJournal::clear() {
+    // Factory reset: the checkpoint counter restarts at 0, records of the old
+    // checkpoint 0 must not be replayed into the cleared stats
+    if (!_ready) return false;
+    Serial.println("Journal: Cleared");
+    return format();
+}
+
+uint32_t ProgressJournal::scanPage(uint32_t page, int checkpoint, ReplayCallback callback, void* context, size_t* count) {
+    uint32_t ps = _flash->pageSize();
+    uint32_t base = page * ps;
+    uint32_t offset = sizeof(PageHeader);
+    uint8_t record[JOURNAL_MAX_WORDS * 4];
+
+    while (offset + sizeof(RecordHeader) <= ps) {
+        RecordHeader hdr;
+        _flash->read(base + offset, &hdr, sizeof(hdr));
+        if (hdr.typeWords == 0xFF) break; // Erased -> end of journal
+
+        uint32_t len = (hdr.typeWords & 0x0F) * 4;
+        if (len < sizeof(RecordHeader) || offset + len > ps) {
+            return ps; // Corrupt length: treat the rest of the page as used
+        }
+
+        if (checkpoint >= 0 && hdr.checkpoint == (uint16_t)checkpoint) {
+            _checkpointBytes += len;
+            _flash->read(base + offset, record, len);
+            // Torn records (power cut while writing) fail the CRC and are skipped
+            if (recordCrc(record, len) == hdr.crc) {
+                callback(context, hdr.typeWords >> 4, record + sizeof(RecordHeader));
+                (*count)++;
+            }
+        }
+        offset += len;
+    }
+    return offset;
+}
+
+size_t ProgressJournal::replay(uint16_t checkpoint, ReplayCallback callback, void* context) {
+    if (!_ready) return 0;
+    size_t count = 0;
+    _checkpoint = checkpoint;
+    _checkpointBytes = 0;
+
+    // Older page first (if it still holds a valid journal), then the head
+    uint32_t other = 1 - _headPage;
+    PageHeader hdr;
+    if (readPageHeader(other, hdr) && hdr.seq < _headSeq) {
+        scanPage(other, checkpoint, callback, context, &count);
+    }
+    if (_headClosed && _checkpointBytes > 0) {
+        // Leaving the closed head would erase these records although the checkpoint's
+        // records did not fill a page -> refuse appends, the caller writes a checkpoint
+        _checkpointBytes = pageCapacity();
+    }
+    scanPage(_headPage, checkpoint, callback, context, &count);
+    return count;
+}
+
+bool ProgressJournal::rotate() {
+    uint32_t next = 1 - _headPage;
+    if (!_flash->erasePage(next)) return false;
+    _erases++;
+
+    PageHeader hdr = { _headSeq + 1, JOURNAL_PAGE_MAGIC };
+    if (!_flash->write(next * _flash->pageSize(), &hdr, sizeof(hdr))) return false;
+    _headPage = next;
+    _headSeq++;
+    _headOffset = sizeof(PageHeader);
+    _headClosed = false;
+    return true;
+}
+
+bool ProgressJournal::append(uint8_t type, uint16_t checkpoint, const void* payload, size_t len) {
+    if (!_ready) return false;
+
+    uint8_t record[JOURNAL_MAX_WORDS * 4];
+    uint32_t words = (sizeof(RecordHeader) + len + 3) / 4;
+    memset(record, 0xFF, words * 4);
+
+    RecordHeader hdr;
+    hdr.typeWords = (type << 4) | words;
+    hdr.crc = 0;
+    hdr.checkpoint = checkpoint;
+    memcpy(record, &hdr, sizeof(hdr));
+    memcpy(record + sizeof(hdr), payload, len);
+    record[1] = recordCrc(record, words * 4);
+
+    // Records of one checkpoint must fit into one page, otherwise a rotation could
+    // erase some of them -> caller has to write a checkpoint first
+    if (checkpoint != _checkpoint) {
+        _checkpoint = checkpoint;
+        _checkpointBytes = 0;
+    }
+    if (_checkpointBytes + words * 4 > pageCapacity()) {
+        return false;
+    }
+
+    if (_headOffset + words * 4 > _flash->pageSize() && !rotate()) {
+        return false;
+    }
+
+    // Header word first: its length stays valid even if the rest is torn
+    bool ok = _flash->write(_headPage * _flash->pageSize() + _headOffset, record, words * 4);
+    _headOffset += words * 4;
+    _checkpointBytes += words * 4;
+    _appends++;
+    return ok;
+}
+
+bool ProgressJournal::appendDelta(uint16_t checkpoint, const Delta& delta) {
+    return append(REC_DELTA, checkpoint, &delta, sizeof(delta));
+}
+
+bool ProgressJournal::appendOiling(uint16_t checkpoint, const Oiling& oiling) {
+    return append(REC_OILING, checkpoint, &oiling, sizeof(oiling));
+}
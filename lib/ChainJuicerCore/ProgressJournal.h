@@ -0,0 +1,91 @@
+#ifndef PROGRESS_JOURNAL_H
+#define PROGRESS_JOURNAL_H
+
+#include "config.h"
+#include "SpeedRanges.h"
+#include "FlashDevice.h"
+
+/**
+ * Append-only journal for odometer/progress on raw flash pages.
+ *
+ * Between two full checkpoints (written via IPersistence) the Oiler only appends small
+ * records: a 16-byte delta (distance and pump cycles since the checkpoint, absolute
+ * progress and tank level) and one record per oiling event (the new history entry).
+ * Records carry the checkpoint number they belong to; records of older checkpoints
+ * are ignored on replay, so a checkpoint never has to erase the journal.
+ *
+ * Pages are used alternately. When the current page is full the other one is erased
+ * and becomes the head, i.e. one erase per ~250 saves. The records of one checkpoint
+ * are limited to one page (append fails beyond that, the caller then writes a new
+ * checkpoint), so a rotation never erases records that are still needed.
+ */
+class ProgressJournal {
+public:
+    enum RecordType {
+        REC_DELTA = 1,
+        REC_OILING = 2
+    };
+
+    struct Delta {
+        uint32_t distanceM;   // Since checkpoint
+        float progress;       // Absolute
+        uint16_t pumpCycles;  // Since checkpoint
+        uint16_t tankDeciMl;  // Absolute, 0.1 ml
+    };
+
+    struct Oiling {
+        int8_t range;
+        uint8_t reserved;
+        uint16_t timeInRanges[NUM_RANGES]; // Seconds, new history entry
+    };
+
+    // Called for every valid record of the requested checkpoint, oldest first
+    typedef void (*ReplayCallback)(void* context, uint8_t type, const void* payload);
+
+    ProgressJournal(IFlashDevice* flash);
+
+    bool begin();
+    bool isReady() const { return _ready; }
+
+    bool appendDelta(uint16_t checkpoint, const Delta& delta);
+    bool appendOiling(uint16_t checkpoint, const Oiling& oiling);
+    size_t replay(uint16_t checkpoint, ReplayCallback callback, void* context);
+    bool clear(); // Erase all records (factory reset, checkpoints restart at 0)
+
+    // Status
+    uint32_t getAppendCount() const { return _appends; }
+    uint32_t getEraseCount() const { return _erases; }
+
+private:
+    struct PageHeader {
+        uint32_t seq;
+        uint32_t magic; // Written after seq
+    };
+
+    struct RecordHeader {
+        uint8_t typeWords;   // Type (upper 4 bits) | record length in words (lower 4 bits)
+        uint8_t crc;         // Low byte of CRC32 over the record with crc = 0
+        uint16_t checkpoint;
+    };
+
+    IFlashDevice* _flash;
+    bool _ready = false;
+    uint32_t _headPage = 0;
+    uint32_t _headSeq = 0;
+    uint32_t _headOffset = 0;
+    uint32_t _appends = 0;
+    uint32_t _erases = 0;
+    uint16_t _checkpoint = 0;       // Checkpoint of the last append/replay
+    uint32_t _checkpointBytes = 0;  // Journal bytes belonging to it
+    bool _headClosed = false;       // Head page ends in garbage (begin), left on the next append
+
+    bool append(uint8_t type, uint16_t checkpoint, const void* payload, size_t len);
+    bool rotate();
+    bool format();
+    bool readPageHeader(uint32_t page, PageHeader& hdr);
+    uint32_t scanPage(uint32_t page, int checkpoint, ReplayCallback callback, void* context, size_t* count);
+    uint32_t pageCapacity() const { return _flash->pageSize() - sizeof(PageHeader); }
+    static uint8_t recordCrc(const uint8_t* record, size_t len);
+};
+
+#endif
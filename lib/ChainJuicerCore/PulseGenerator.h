@@ -0,0 +1,40 @@
+#ifndef PULSE_GENERATOR_H
+#define PULSE_GENERATOR_H
+
+#include <Arduino.h>
+
+/**
+ * Abstract hardware pulse train on one output pin (active high).
+ * start() hands over the whole train; the pin edges are generated without the CPU,
+ * so a blocking call in the main loop cannot stretch a pulse. Software only polls
+ * completed() and busy().
+ * Times are in microseconds, pulse k (from 0) runs from k * (pulse + pause) to
+ * k * (pulse + pause) + pulse after start().
+ */
+class IPulseGenerator {
+public:
+    virtual ~IPulseGenerator() {}
+
+    virtual bool begin(uint8_t pin) = 0;
+
+    // PWM generators shape each pulse: ramp up over the first upUs and down over the last
+    // downUs of the width. Others switch hard. Applies to the next start().
+    virtual void setRamp(uint32_t upUs, uint32_t downUs) { (void)upUs; (void)downUs; }
+
+    // First pulse starts now. False while a train is still running.
+    virtual bool start(uint16_t count, uint32_t pulseUs, uint32_t pauseUs) = 0;
+
+    // No further pulse starts; a running pulse still ends on time
+    virtual void cancel() = 0;
+
+    // Pin off now, a running pulse is cut short (safety cutoff, crash)
+    virtual void stop() = 0;
+
+    // Pulses that ended since start()
+    virtual uint16_t completed() = 0;
+
+    // True until the last pulse of the train (or of a cancelled train) has ended
+    virtual bool busy() = 0;
+};
+
+#endif
@@ -0,0 +1,63 @@
+#include "PulseTrain.h"
+
+bool PulseTrain::start(uint16_t count, unsigned long pulseMs, unsigned long pauseMs) {
+    if (!_gen || _running || count == 0) return false;
+
+    uint32_t pulseUs = pulseMs * 1000;
+    uint32_t pauseUs = pauseMs * 1000;
+    uint32_t startUs = micros();
+    if (!_gen->start(count, pulseUs, pauseUs)) return false;
+
+    _running = true;
+    _count = count;
+    _seen = 0;
+    _startUs = startUs;
+    _pulseUs = pulseUs;
+    _periodUs = pulseUs + pauseUs;
+    return true;
+}
+
+void PulseTrain::hold() {
+    if (!_running) return;
+    _gen->cancel();
+
+    // Pulses started by now still run to their end
+    uint32_t elapsed = micros() - _startUs;
+    uint32_t started = elapsed / _periodUs + 1;
+    if (started < _count) _count = (uint16_t)started;
+}
+
+void PulseTrain::abort() {
+    if (!_gen) return;
+    _gen->stop();
+    _running = false;
+}
+
+uint16_t PulseTrain::poll() {
+    if (!_running) return 0;
+
+    bool busy = _gen->busy();
+    uint16_t done = _gen->completed();
+    uint16_t fresh = done > _seen ? done - _seen : 0;
+    _seen = done;
+
+    if (fresh > 0) {
+        uint32_t nowUs = micros();
+        uint32_t lateUs = nowUs - pulseEndUs(done - 1);
+        _lastEndMs = millis() - lateUs / 1000;
+
+        if (!busy) {
+            _trains++;
+            _latencySumUs += lateUs;
+            if (lateUs > _maxLatencyUs) _maxLatencyUs = lateUs;
+        }
+    }
+    if (!busy) _running = false;
+    return fresh;
+}
+
+bool PulseTrain::overdue() const {
+    if (!_running) return false;
+    int32_t lateUs = (int32_t)(micros() - pulseEndUs(_count - 1));
+    return lateUs > (int32_t)PULSE_TRAIN_OVERDUE_MS * 1000;
+}
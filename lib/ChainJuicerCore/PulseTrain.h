@@ -0,0 +1,63 @@
+#ifndef PULSE_TRAIN_H
+#define PULSE_TRAIN_H
+
+#include "PulseGenerator.h"
+
+#define PULSE_TRAIN_POLL_MS 10        // Pump task period while a train runs (accounting, lean check)
+#define PULSE_TRAIN_OVERDUE_MS 1000   // Still busy this long after the expected end: generator stuck
+
+/**
+ * Pump pulse trains on top of an IPulseGenerator: keeps the expected timeline of the
+ * running train, reports pulses as they finish and measures how late software sees the
+ * completion (the pulse widths themselves are timed by the generator).
+ * Runs against SimPulseGenerator on the host (ride_replay --pulse).
+ */
+class PulseTrain {
+public:
+    explicit PulseTrain(IPulseGenerator* gen) : _gen(gen) {}
+
+    bool available() const { return _gen != nullptr; }
+    bool begin(uint8_t pin) { return _gen && _gen->begin(pin); }
+
+    void setRamp(unsigned long upMs, unsigned long downMs) { if (_gen) _gen->setRamp(upMs * 1000, downMs * 1000); }
+    bool start(uint16_t count, unsigned long pulseMs, unsigned long pauseMs);
+
+    // Let the running pulse end, start no further one (lean angle); the caller restarts the rest
+    void hold();
+
+    // Pin off now and forget the train
+    void abort();
+
+    // Pulses that ended since the last poll()
+    uint16_t poll();
+
+    bool running() const { return _running; }
+    bool overdue() const;
+
+    // millis() at which the last pulse of the train ended (by the generator's timeline)
+    unsigned long lastPulseEndMs() const { return _lastEndMs; }
+
+    // Completion latency: generator finished -> poll() noticed
+    uint32_t getTrains() const { return _trains; }
+    uint32_t getMeanLatencyUs() const { return _trains ? (uint32_t)(_latencySumUs / _trains) : 0; }
+    uint32_t getMaxLatencyUs() const { return _maxLatencyUs; }
+
+private:
+    IPulseGenerator* _gen;
+    bool _running = false;
+    uint16_t _count = 0;    // Pulses that will run (less after hold())
+    uint16_t _seen = 0;     // Pulses reported by poll()
+    uint32_t _startUs = 0;
+    uint32_t _pulseUs = 0;
+    uint32_t _periodUs = 0;
+    unsigned long _lastEndMs = 0;
+
+    uint32_t _trains = 0;
+    uint64_t _latencySumUs = 0;
+    uint32_t _maxLatencyUs = 0;
+
+    // micros() at which pulse k ends
+    uint32_t pulseEndUs(uint16_t k) const { return _startUs + k * _periodUs + _pulseUs; }
+};
+
+#endif
@@ -0,0 +1,45 @@
+#include "SpeedEstimator.h"
+
+#define MS_TO_KMH 3.6f
+#define BIAS_INITIAL_VAR (1.8f * 1.8f) // 0.5 m/s^2
+
+void SpeedEstimator::reset(float speedKmh) {
+    _v = speedKmh;
+    _p00 = GPS_NOISE_KMH * GPS_NOISE_KMH;
+    _p01 = 0.0f;
+    _p11 = BIAS_INITIAL_VAR;
+    _init = true;
+}
+
+float SpeedEstimator::update(float gpsKmh, float dtS, float imuDeltaVMs, bool imuValid) {
+    if (!_init || !(dtS > 0.0f) || dtS > MAX_DT_S) {
+        reset(gpsKmh); // Bias is kept: it belongs to the sensor, not to the ride
+        return speedKmh();
+    }
+
+    // Predict: x = F x + u with F = [1 -dt; 0 1], u = [deltaV; 0]
+    if (imuValid) {
+        _v += imuDeltaVMs * MS_TO_KMH - _bias * dtS;
+        float p00 = _p00 - dtS * (_p01 + _p01) + dtS * dtS * _p11;
+        float p01 = _p01 - dtS * _p11;
+        _p00 = p00 + IMU_NOISE_KMH_S * IMU_NOISE_KMH_S * dtS;
+        _p01 = p01;
+    } else {
+        _p00 += GPS_ONLY_NOISE_KMH_S * GPS_ONLY_NOISE_KMH_S * dtS;
+    }
+    _p11 += BIAS_DRIFT * BIAS_DRIFT * dtS;
+
+    // Correct with the GPS speed: H = [1 0]
+    float s = _p00 + GPS_NOISE_KMH * GPS_NOISE_KMH;
+    float k0 = _p00 / s;
+    float k1 = imuValid ? _p01 / s : 0.0f; // Bias is only observable with IMU input
+    float y = gpsKmh - _v;
+    _v += k0 * y;
+    _bias += k1 * y; // k1 < 0: P01 carries the sign of the -dt in F
+    float p01 = _p01;
+    _p11 -= k1 * p01;
+    _p01 -= k0 * p01;
+    _p00 -= k0 * _p00;
+
+    return speedKmh();
+}
@@ -0,0 +1,39 @@
+#ifndef SPEED_ESTIMATOR_H
+#define SPEED_ESTIMATOR_H
+
+#include <Arduino.h>
+
+/**
+ * Speed estimate from GPS speed and IMU forward acceleration: a two-state Kalman filter
+ * (speed, accelerometer bias), single precision, O(1) per fix.
+ * Predict: the IMU velocity change since the last fix minus the estimated bias.
+ * Correct: the GPS speed. The bias state absorbs mounting tilt and sensor offset.
+ * Without IMU data the speed is a random walk and the filter reduces to an adaptive
+ * low-pass (less lag than the former 5-sample average, see ride_replay --speed).
+ */
+class SpeedEstimator {
+public:
+    // Noise model (km/h, s)
+    static constexpr float GPS_NOISE_KMH = 1.5f;      // GPS Doppler speed, 1 sigma
+    static constexpr float IMU_NOISE_KMH_S = 0.7f;    // IMU velocity change, per sqrt(s) (vibration averages out)
+    static constexpr float GPS_ONLY_NOISE_KMH_S = 1.0f; // Speed random walk without IMU, per sqrt(s)
+    static constexpr float BIAS_DRIFT = 0.01f;        // Bias random walk (km/h/s per sqrt(s))
+    static constexpr float MAX_DT_S = 2.0f;           // Longer gaps restart from the GPS speed
+
+    void reset(float speedKmh);
+
+    // dtS: seconds since the previous fix. imuDeltaVMs: forward velocity change from the
+    // IMU over dtS in m/s (ignored when imuValid is false). Returns the new estimate.
+    float update(float gpsKmh, float dtS, float imuDeltaVMs, bool imuValid);
+
+    float speedKmh() const { return _v > 0.0f ? _v : 0.0f; }
+    float biasKmhS() const { return _bias; }
+
+private:
+    float _v = 0.0f;     // km/h
+    float _bias = 0.0f;  // km/h per s
+    float _p00 = 0.0f, _p01 = 0.0f, _p11 = 0.0f; // Covariance
+    bool _init = false;
+};
+
+#endif
@@ -0,0 +1,6 @@
+#include "SpeedRanges.h"
+
+// Storage of the selected table (C++11: odr-used constexpr members need a definition)
+constexpr int RangeTable::count;
+constexpr float RangeTable::bounds[];
+constexpr float RangeTable::intervalKm[];
@@ -0,0 +1,77 @@
+#ifndef SPEED_RANGES_H
+#define SPEED_RANGES_H
+
+#include <Arduino.h>
+#include "config.h"
+
+#define RANGE_MIN_COUNT 3
+#define RANGE_MAX_COUNT 10
+
+struct SpeedRange {
+    float minSpeed;
+    float maxSpeed;
+    float intervalKm;
+    int pulses;
+};
+
+/**
+ * Speed range tables, one per build (RANGE_PROFILE in config.h). The table fixes the
+ * number of ranges, their bounds and the default intervals at compile time; NUM_RANGES
+ * and everything sized by it (settings, time stats, journal records, LoRa session stats)
+ * follow, so a 3-range enduro build carries no slots for unused ranges.
+ *
+ * bounds: count + 1 speeds in km/h, multiples of LUT_STEP, the last one MAX_SPEED_KMH.
+ * Only intervals and pulses are configurable at runtime.
+ */
+template<int Profile> struct RangeProfile;
+
+// Swiss Alpine (default, the 5 ranges of earlier firmware)
+template<> struct RangeProfile<RANGE_PROFILE_ALPINE> {
+    static constexpr int count = 5;
+    static constexpr float bounds[count + 1] = {
+        10,           // City / Hairpins -> 6.0 km (Low centrifugal force)
+        45,           // Mountain Passes / Main Zone -> 5.0 km (Base)
+        75,           // Country Roads -> 4.4 km (-12.5% from Base)
+        105,          // Highway -> 3.8 km (-25% from Base)
+        135,          // High Speed -> 3.0 km (-40% from Base)
+        MAX_SPEED_KMH
+    };
+    static constexpr float intervalKm[count] = { 6.0, 5.0, 4.4, 3.8, 3.0 };
+};
+
+// Touring: motorway speeds in finer steps
+template<> struct RangeProfile<RANGE_PROFILE_TOURING> {
+    static constexpr int count = 6;
+    static constexpr float bounds[count + 1] = { 10, 50, 80, 100, 120, 140, MAX_SPEED_KMH };
+    static constexpr float intervalKm[count] = { 6.0, 5.0, 4.4, 4.0, 3.5, 3.0 };
+};
+
+// Enduro: trail, transfer, road
+template<> struct RangeProfile<RANGE_PROFILE_ENDURO> {
+    static constexpr int count = 3;
+    static constexpr float bounds[count + 1] = { 10, 40, 80, MAX_SPEED_KMH };
+    static constexpr float intervalKm[count] = { 4.5, 4.0, 3.5 };
+};
+
+#if RANGE_PROFILE == RANGE_PROFILE_CUSTOM
+// Own table from config.h / build flags, e.g. RANGE_CUSTOM_COUNT 4,
+// RANGE_CUSTOM_BOUNDS { 10, 40, 90, 130, MAX_SPEED_KMH }, RANGE_CUSTOM_INTERVALS { 5, 4.5, 4, 3.2 }
+template<> struct RangeProfile<RANGE_PROFILE_CUSTOM> {
+    static constexpr int count = RANGE_CUSTOM_COUNT;
+    static constexpr float bounds[count + 1] = RANGE_CUSTOM_BOUNDS;
+    static constexpr float intervalKm[count] = RANGE_CUSTOM_INTERVALS;
+};
+#endif
+
+typedef RangeProfile<RANGE_PROFILE> RangeTable;
+#define NUM_RANGES (RangeTable::count)
+
+static_assert(NUM_RANGES >= RANGE_MIN_COUNT && NUM_RANGES <= RANGE_MAX_COUNT, "3 to 10 speed ranges");
+static_assert(RangeTable::bounds[NUM_RANGES] == (float)MAX_SPEED_KMH, "Last range bound must be MAX_SPEED_KMH");
+
+// Identifies count and bounds in stored per-range stats (FNV-1a over the bounds)
+template<class Table> constexpr uint32_t rangeLayoutId(int i = 0, uint32_t h = 2166136261UL ^ Table::count) {
+    return i > Table::count ? h : rangeLayoutId<Table>(i + 1, (h ^ (uint32_t)Table::bounds[i]) * 16777619UL);
+}
+
+#endif
@@ -0,0 +1,166 @@
+#include "TempSensors.h"
+#include "CycleCounter.h"
+
+#define DS18B20_FAMILY 0x28
+#define DS18B20_SKIP_ROM 0xCC
+#define DS18B20_MATCH_ROM 0x55
+#define DS18B20_CONVERT 0x44
+#define DS18B20_READ_SCRATCHPAD 0xBE
+#define DS18B20_WRITE_SCRATCHPAD 0x4E
+#define DS18B20_ALARM_HIGH 75   // TH/TL are written with the config byte (factory values)
+#define DS18B20_ALARM_LOW 70
+
+uint8_t TempSensors::begin(uint8_t resolutionBits) {
+    _count = 0;
+    if (_pin < 0) return 0;
+    if (!_bus) _bus = new OneWire(_pin);
+    _resolution = constrain(resolutionBits, 9, 12);
+
+    uint8_t addr[8];
+    _bus->reset_search();
+    while (_count < TEMP_MAX_SENSORS && _bus->search(addr)) {
+        if (OneWire::crc8(addr, 7) != addr[7] || addr[0] != DS18B20_FAMILY) continue;
+        memcpy(_rom[_count], addr, 8);
+        _valid[_count] = false;
+        _count++;
+    }
+
+    _configPending = _count > 0;
+    _phase = PHASE_IDLE;
+    _nextCycleMs = millis();
+    return _count;
+}
+
+void TempSensors::setResolution(uint8_t bits) {
+    bits = constrain(bits, 9, 12);
+    if (bits == _resolution) return;
+    _resolution = bits;
+    _configPending = true;
+}
+
+unsigned long TempSensors::step(unsigned long now, unsigned long intervalMs, bool& cycleDone) {
+    cycleDone = false;
+    switch (_phase) {
+        case PHASE_IDLE:
+            if ((long)(now - _nextCycleMs) < 0) return _nextCycleMs - now;
+            _nextCycleMs = now + intervalMs;
+            if (_count == 0) { // Nothing on the bus: an empty cycle (readings stay invalid)
+                cycleDone = true;
+                return intervalMs;
+            }
+            beginTransaction(_configPending ? PHASE_CONFIG : PHASE_CONVERT);
+            break;
+        case PHASE_WAIT: {
+            unsigned long ready = _convertStartMs + conversionMs(_resolution);
+            if ((long)(now - ready) < 0) return ready - now;
+            _sensor = 0;
+            beginTransaction(PHASE_READ);
+            break;
+        }
+        default:
+            break;
+    }
+
+    uint32_t t0 = cycleCount();
+    bool present = busStep();
+    uint32_t us = (cycleCount() - t0) / (CYCLE_COUNTER_HZ / 1000000UL);
+    if (us > _maxStepUs) _maxStepUs = us;
+
+    if (!present) {
+        // Bus shorted or sensors gone: this cycle reads nothing, the next one tries again
+        _errors++;
+        for (uint8_t i = 0; i < _count; i++) _valid[i] = false;
+        _phase = PHASE_IDLE;
+        cycleDone = true;
+        return _nextCycleMs - now;
+    }
+    if (_pos < 1 + _txLen + _rxLen) return TEMP_STEP_MS;
+
+    switch (_phase) {
+        case PHASE_CONFIG:
+            _configPending = false;
+            beginTransaction(PHASE_CONVERT);
+            return TEMP_STEP_MS;
+        case PHASE_CONVERT:
+            // Conversion runs from the end of the command; wait from the next ms on
+            _convertStartMs = millis() + 1;
+            _phase = PHASE_WAIT;
+            return conversionMs(_resolution) + 1;
+        case PHASE_READ:
+            storeReading();
+            if (++_sensor < _count) {
+                beginTransaction(PHASE_READ);
+                return TEMP_STEP_MS;
+            }
+            _phase = PHASE_IDLE;
+            cycleDone = true;
+            return (long)(_nextCycleMs - now) > 0 ? _nextCycleMs - now : 0;
+        default:
+            return TEMP_STEP_MS;
+    }
+}
+
+void TempSensors::beginTransaction(Phase phase) {
+    _phase = phase;
+    _pos = 0;
+    _rxLen = 0;
+    switch (phase) {
+        case PHASE_CONFIG:
+            _tx[0] = DS18B20_SKIP_ROM;
+            _tx[1] = DS18B20_WRITE_SCRATCHPAD;
+            _tx[2] = DS18B20_ALARM_HIGH;
+            _tx[3] = DS18B20_ALARM_LOW;
+            _tx[4] = configByte();
+            _txLen = 5;
+            break;
+        case PHASE_CONVERT:
+            _tx[0] = DS18B20_SKIP_ROM;
+            _tx[1] = DS18B20_CONVERT; // All sensors at once
+            _txLen = 2;
+            break;
+        case PHASE_READ:
+            _tx[0] = DS18B20_MATCH_ROM;
+            memcpy(&_tx[1], _rom[_sensor], 8);
+            _tx[9] = DS18B20_READ_SCRATCHPAD;
+            _txLen = 10;
+            _rxLen = 9;
+            break;
+        default:
+            _txLen = 0;
+            break;
+    }
+}
+
+bool TempSensors::busStep() {
+    if (_pos == 0) {
+        if (!_bus->reset()) return false;
+    } else if (_pos <= _txLen) {
+        _bus->write(_tx[_pos - 1]);
+    } else {
+        _rx[_pos - 1 - _txLen] = _bus->read();
+    }
+    _pos++;
+    return true;
+}
+
+void TempSensors::storeReading() {
+    if (OneWire::crc8(_rx, 8) != _rx[8]) {
+        _valid[_sensor] = false;
+        _errors++;
+        return;
+    }
+
+    // A sensor that lost power is back at its EEPROM resolution and may still hold the
+    // 85°C power-on value: skip it and write our configuration again next cycle
+    if (_rx[4] != configByte()) {
+        _valid[_sensor] = false;
+        _configPending = true;
+        return;
+    }
+
+    int16_t raw = (int16_t)((_rx[1] << 8) | _rx[0]);
+    raw &= (int16_t)(0xFFFF << (12 - _resolution)); // Low bits are undefined below 12 bits
+    _tempC[_sensor] = raw * 0.0625f;
+    _valid[_sensor] = true;
+    _readings++;
+}
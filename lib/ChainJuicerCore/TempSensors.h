@@ -0,0 +1,87 @@
+#ifndef TEMP_SENSORS_H
+#define TEMP_SENSORS_H
+
+#include <Arduino.h>
+#include <OneWire.h>
+
+#ifndef DEVICE_DISCONNECTED_C
+#define DEVICE_DISCONNECTED_C -127 // Reading of a missing sensor (DallasTemperature convention)
+#endif
+
+#define TEMP_MAX_SENSORS 4      // DS18B20s found at boot, the first one is the oil temperature
+#define TEMP_STEP_MS 1          // Between two bus steps of a cycle
+
+/**
+ * DS18B20 temperature sensors on one 1-Wire bus without blocking the main loop.
+ * A cycle starts the conversion on all sensors at once (skip ROM), waits the conversion
+ * time of the resolution (94-750 ms) and reads one scratchpad per sensor (match ROM).
+ * step() does a single bus operation per call: a reset (~1 ms) or one byte (~0.6 ms),
+ * so the loop is never held longer than that. DallasTemperature's requestTemperatures()
+ * blocks for the whole conversion and getTempC() for a complete transaction (~7 ms).
+ * Sensors are searched at boot only (begin(), blocking).
+ */
+class TempSensors {
+public:
+    explicit TempSensors(int pin) : _pin(pin) {}
+    ~TempSensors() { delete _bus; }
+
+    // Searches the bus and sets the resolution (9-12 bits) on all sensors. Returns the number found.
+    uint8_t begin(uint8_t resolutionBits);
+
+    // Takes effect with the next cycle (written to the sensors' scratchpad, not to their EEPROM)
+    void setResolution(uint8_t bits);
+    uint8_t getResolution() const { return _resolution; }
+
+    // Next cycle starts at once instead of after intervalMs
+    void requestNow() { _nextCycleMs = millis(); }
+
+    // One bus operation if one is due. Returns the ms until the next one (cycles start
+    // every intervalMs). True in 'cycleDone' when the readings of a cycle are complete.
+    unsigned long step(unsigned long now, unsigned long intervalMs, bool& cycleDone);
+
+    uint8_t getCount() const { return _count; }
+    bool isValid(uint8_t i) const { return i < _count && _valid[i]; }
+    float getTempC(uint8_t i) const { return isValid(i) ? _tempC[i] : DEVICE_DISCONNECTED_C; }
+    const uint8_t* getAddress(uint8_t i) const { return _rom[i]; }
+
+    static unsigned long conversionMs(uint8_t bits) { return 750UL >> (12 - bits); }
+
+    uint32_t getReadings() const { return _readings; }
+    uint32_t getErrors() const { return _errors; }   // CRC mismatch or no presence pulse
+    uint32_t getMaxStepUs() const { return _maxStepUs; }
+
+private:
+    enum Phase : uint8_t { PHASE_IDLE, PHASE_CONFIG, PHASE_CONVERT, PHASE_WAIT, PHASE_READ };
+
+    int _pin;
+    OneWire* _bus = nullptr;
+    uint8_t _count = 0;
+    uint8_t _rom[TEMP_MAX_SENSORS][8];
+    float _tempC[TEMP_MAX_SENSORS];
+    bool _valid[TEMP_MAX_SENSORS];
+    uint8_t _resolution = 12;
+    bool _configPending = false;
+
+    Phase _phase = PHASE_IDLE;
+    uint8_t _sensor = 0;        // Read in PHASE_READ
+    unsigned long _convertStartMs = 0; // Conversion started (all sensors)
+    unsigned long _nextCycleMs = 0;
+
+    // Current transaction: reset, _txLen bytes out, _rxLen bytes in; one per step()
+    uint8_t _tx[10];
+    uint8_t _txLen = 0;
+    uint8_t _rx[9];
+    uint8_t _rxLen = 0;
+    uint8_t _pos = 0;
+
+    uint32_t _readings = 0;
+    uint32_t _errors = 0;
+    uint32_t _maxStepUs = 0;
+
+    void beginTransaction(Phase phase);
+    bool busStep();              // False: no presence pulse
+    void storeReading();
+    uint8_t configByte() const { return (uint8_t)(((_resolution - 9) << 5) | 0x1F); }
+};
+
+#endif
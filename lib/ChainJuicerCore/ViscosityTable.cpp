@@ -0,0 +1,55 @@
+#include "ViscosityTable.h"
+
+// The pump pulse doesn't need to scale 1:1 with viscosity: the exponent sets how hard the
+// compensation reacts. Calibrated at 10°C: the pump is very efficient, needs less.
+static constexpr double viscExponents[VISC_OIL_TYPES] = {
+    0.15, // OIL_THIN: gentle (was 0.3)
+    0.25, // OIL_NORMAL (was 0.5)
+    0.35  // OIL_THICK: aggressive (was 0.7)
+};
+
+// exp() for the table, Taylor series summed until the terms vanish. Arguments stay
+// within +-1.1 over the table range, i.e. ~25 terms. Single-expression constexpr (C++11).
+static constexpr double viscExpTerms(double x, double term, int n) {
+    return (term < 1e-18 && term > -1e-18) ? 0.0 : term + viscExpTerms(x, term * x / (n + 1), n + 1);
+}
+static constexpr double viscExp(double x) { return viscExpTerms(x, 1.0, 0); }
+
+static constexpr double viscTempC(int i) { return VISC_TEMP_MIN_C + (double)i / VISC_STEPS_PER_C; }
+
+static constexpr double viscFactor(int oil, double tempC) {
+    return viscExp(viscExponents[oil] * VISC_ARRHENIUS_B * (1.0 / (tempC + 273.15) - 1.0 / (VISC_REF_C + 273.15)));
+}
+
+template<int... I> struct ViscIndices {};
+template<int N, int... I> struct MakeViscIndices : MakeViscIndices<N - 1, N - 1, I...> {};
+template<int... I> struct MakeViscIndices<0, I...> { typedef ViscIndices<I...> type; };
+
+struct ViscRow { float f[VISC_TABLE_SIZE]; };
+
+template<int... I> static constexpr ViscRow makeViscRow(int oil, ViscIndices<I...>) {
+    return {{ (float)viscFactor(oil, viscTempC(I))... }};
+}
+
+static constexpr ViscRow viscTable[VISC_OIL_TYPES] = {
+    makeViscRow(0, MakeViscIndices<VISC_TABLE_SIZE>::type()),
+    makeViscRow(1, MakeViscIndices<VISC_TABLE_SIZE>::type()),
+    makeViscRow(2, MakeViscIndices<VISC_TABLE_SIZE>::type())
+};
+
+static_assert(viscTable[1].f[(int)(VISC_REF_C - VISC_TEMP_MIN_C) * VISC_STEPS_PER_C] == 1.0f, "Factor 1 at 25°C");
+
+float ViscosityTable::factor(uint8_t oilType, float tempC) {
+    const float* f = viscTable[oilType < VISC_OIL_TYPES ? oilType : 1].f;
+    float x = (tempC - (float)VISC_TEMP_MIN_C) * (float)VISC_STEPS_PER_C;
+    if (!(x > 0.0f)) return f[0]; // Also NaN
+    if (x >= (float)(VISC_TABLE_SIZE - 1)) return f[VISC_TABLE_SIZE - 1];
+    int i = (int)x;
+    return f[i] + (f[i + 1] - f[i]) * (x - (float)i);
+}
+
+double ViscosityTable::model(uint8_t oilType, double tempC) {
+    double v = exp(VISC_ARRHENIUS_A + VISC_ARRHENIUS_B / (tempC + 273.15));
+    double vRef = exp(VISC_ARRHENIUS_A + VISC_ARRHENIUS_B / (VISC_REF_C + 273.15)); // ~158.4 mm²/s
+    return pow(v / vRef, viscExponents[oilType < VISC_OIL_TYPES ? oilType : 1]);
+}
@@ -0,0 +1,33 @@
+#ifndef VISCOSITY_TABLE_H
+#define VISCOSITY_TABLE_H
+
+#include <Arduino.h>
+
+#define VISC_TEMP_MIN_C -30     // Table range; readings outside use the end values
+#define VISC_TEMP_MAX_C 80
+#define VISC_STEPS_PER_C 2      // 0.5°C
+#define VISC_TABLE_SIZE ((VISC_TEMP_MAX_C - VISC_TEMP_MIN_C) * VISC_STEPS_PER_C + 1)
+#define VISC_OIL_TYPES 3        // Oiler::OilType
+
+// Arrhenius fit of ISO VG 85 oil (84.2 mm²/s @ 40°C, 11.2 mm²/s @ 100°C): ln(v) = A + B/T
+#define VISC_ARRHENIUS_A -8.122
+#define VISC_ARRHENIUS_B 3931.8
+#define VISC_REF_C 25.0         // basePulse25/basePause25 apply here (factor 1)
+
+/**
+ * Pulse/pause factor of the temperature compensation: (v(T) / v(25°C)) ^ exponent, with
+ * the exponent of the oil type. Generated at compile time into one flash table per oil
+ * type (221 floats each) and interpolated linearly, instead of two exp() and a pow()
+ * per reading. The ratio does not depend on A: exp(exponent * B * (1/T - 1/T25)).
+ *
+ * Error against the model (ride_replay --viscosity): relative < 3e-5 in the table range.
+ */
+class ViscosityTable {
+public:
+    static float factor(uint8_t oilType, float tempC);
+
+    // Analytic model in double (reference for the table)
+    static double model(uint8_t oilType, double tempC);
+};
+
+#endif
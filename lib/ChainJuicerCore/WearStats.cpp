@@ -0,0 +1,75 @@
+#include "WearStats.h"
+
+WearCounter* WearStats::find(NamedCounter* table, uint8_t& count, uint8_t capacity, const char* name, size_t len) {
+    if (len >= WEAR_KEY_NAME_LEN) len = WEAR_KEY_NAME_LEN - 1;
+    for (uint8_t i = 0; i < count; i++) {
+        if (strncmp(table[i].name, name, len) == 0 && table[i].name[len] == '\0') {
+            return &table[i].counter;
+        }
+    }
+    if (count >= capacity) return nullptr;
+
+    NamedCounter& n = table[count++];
+    memcpy(n.name, name, len);
+    n.name[len] = '\0';
+    return &n.counter;
+}
+
+void WearStats::recordWrite(const char* nsKey, uint32_t calls, uint32_t payload, uint32_t physical, float erases) {
+    _total.add(calls, payload, physical, erases);
+
+    const char* sep = strchr(nsKey, '/');
+    size_t nsLen = sep ? (size_t)(sep - nsKey) : strlen(nsKey);
+    WearCounter* ns = find(_namespaces, _nsCount, WEAR_NAMESPACE_SLOTS, nsKey, nsLen);
+    if (ns) ns->add(calls, payload, physical, erases);
+
+    WearCounter* key = find(_keys, _keyCount, WEAR_KEY_SLOTS, nsKey, strlen(nsKey));
+    (key ? key : &_otherKeys)->add(calls, payload, physical, erases);
+}
+
+float WearStats::getEraseEstimate() const {
+    // Performed erases lag behind (a page is erased only when the log wraps)
+    return ((float)_pageErases > _total.erases) ? (float)_pageErases : _total.erases;
+}
+
+float WearStats::getWriteAmplification() const {
+    return _total.payloadBytes ? (float)_total.physicalBytes / _total.payloadBytes : 0.0f;
+}
+
+float WearStats::getLifetimeYears() const {
+    float hours = millis() / 3600000.0f;
+    float erases = getEraseEstimate();
+    if (_budgetPages == 0 || erases <= 0.0f || hours < 0.01f) return 0.0f;
+
+    float erasesPerHour = erases / hours;
+    float budget = (float)_budgetPages * FLASH_ENDURANCE_CYCLES;
+    return budget / erasesPerHour / (24.0f * 365.0f);
+}
+
+void WearStats::printCounter(Print& out, const char* name, const WearCounter& c) {
+    out.printf("  %-24s %6lu %8lu %8lu %7.2f\n", name, (unsigned long)c.writes,
+               (unsigned long)c.payloadBytes, (unsigned long)c.physicalBytes, c.erases);
+}
+
+void WearStats::printReport(Print& out) const {
+    out.printf("--- Flash Wear (%.1f h since boot) ---\n", millis() / 3600000.0f);
+    out.println("  Name                     Writes  Payload Physical  Erases");
+    printCounter(out, "TOTAL", _total);
+    for (uint8_t i = 0; i < _nsCount; i++) {
+        printCounter(out, _namespaces[i].name, _namespaces[i].counter);
+    }
+    out.println("  Keys:");
+    for (uint8_t i = 0; i < _keyCount; i++) {
+        printCounter(out, _keys[i].name, _keys[i].counter);
+    }
+    if (_otherKeys.writes > 0) {
+        printCounter(out, "(other)", _otherKeys);
+    }
+    out.printf("  Page erases: %lu performed, %.1f estimated\n", (unsigned long)_pageErases, _total.erases);
+    out.printf("  Write amplification: %.2f\n", getWriteAmplification());
+    float years = getLifetimeYears();
+    if (years > 0.0f) {
+        out.printf("  Flash life at this rate: %.0f years (%lu pages x %d cycles)\n",
+                   years, (unsigned long)_budgetPages, FLASH_ENDURANCE_CYCLES);
+    }
+}
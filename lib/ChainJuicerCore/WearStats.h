@@ -0,0 +1,67 @@
+#ifndef WEAR_STATS_H
+#define WEAR_STATS_H
+
+#include <Arduino.h>
+
+#define WEAR_NAMESPACE_SLOTS 8
+#define WEAR_KEY_SLOTS 24      // Keys beyond this are summed up in "(other)"
+#define WEAR_KEY_NAME_LEN 24   // "namespace/key", truncated
+#define FLASH_ENDURANCE_CYCLES 10000 // nRF52840: guaranteed erase cycles per page
+
+struct WearCounter {
+    uint32_t writes;        // Put calls that reached flash
+    uint32_t payloadBytes;  // Value bytes handed to the store
+    uint32_t physicalBytes; // Estimated programmed bytes (headers, padding, metadata, copies)
+    float erases;           // Estimated page erases caused by these writes
+
+    void add(uint32_t calls, uint32_t payload, uint32_t physical, float pageErases) {
+        writes += calls;
+        payloadBytes += payload;
+        physicalBytes += physical;
+        erases += pageErases;
+    }
+};
+
+/**
+ * Flash wear counters of a persistence backend since boot.
+ * Tracks writes per namespace and per key ("namespace/key") and the page erases the
+ * backend actually performed. printReport() projects the flash lifetime from the
+ * erase rate, e.g. to verify the save intervals of Oiler::update().
+ */
+class WearStats {
+public:
+    // pages: erase blocks the backend wears evenly
+    void setEraseBudget(uint32_t pages) { _budgetPages = pages; }
+
+    // nsKey = "namespace/key"; calls = 0 for internal writes (compaction copies)
+    void recordWrite(const char* nsKey, uint32_t calls, uint32_t payload, uint32_t physical, float erases);
+    void recordErase(uint32_t pages = 1) { _pageErases += pages; }
+
+    const WearCounter& getTotal() const { return _total; }
+    uint32_t getPageErases() const { return _pageErases; } // Performed erases (0 if not measurable)
+    float getEraseEstimate() const; // Larger of performed and estimated erases
+    float getWriteAmplification() const;
+    float getLifetimeYears() const; // At the current erase rate, 0 = not enough data
+
+    void printReport(Print& out) const;
+
+private:
+    struct NamedCounter {
+        char name[WEAR_KEY_NAME_LEN];
+        WearCounter counter;
+    };
+
+    WearCounter _total = {};
+    NamedCounter _namespaces[WEAR_NAMESPACE_SLOTS] = {};
+    NamedCounter _keys[WEAR_KEY_SLOTS] = {};
+    WearCounter _otherKeys = {};
+    uint8_t _nsCount = 0;
+    uint8_t _keyCount = 0;
+    uint32_t _pageErases = 0;
+    uint32_t _budgetPages = 0;
+
+    static WearCounter* find(NamedCounter* table, uint8_t& count, uint8_t capacity, const char* name, size_t len);
+    static void printCounter(Print& out, const char* name, const WearCounter& c);
+};
+
+#endif
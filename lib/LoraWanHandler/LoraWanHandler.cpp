@@ -109,26 +109,9 @@ void LoraWanHandler::sendEvent(uint8_t eventId) {
     }
 }
 
-void LoraWanHandler::sendSessionStats(uint32_t* timeInRanges, uint8_t numRanges) {
+void LoraWanHandler::sendSessionPayload(const uint8_t* buffer, size_t len) {
     if (!_joined) return;
 
-    uint8_t buffer[32];
-    // Byte 0: Type (0x05 = SESSION_STATS)
-    buffer[0] = 0x05;
-    
-    // Payload: 2 Bytes per Range (Seconds)
-    // uint16 max is 65535 seconds = 18 hours. Should be enough for a ride.
-    
-    for(int i=0; i<numRanges; i++) {
-        uint32_t seconds = timeInRanges[i];
-        if (seconds > 65535) seconds = 65535; // Cap at ~18h
-        
-        buffer[1 + (i*2)] = (seconds >> 8) & 0xFF;
-        buffer[1 + (i*2) + 1] = seconds & 0xFF;
-    }
-    
-    size_t len = 1 + (numRanges * 2);
-    
     Serial.println("LoRa: Sending Session Stats for AI...");
     int state = _node->sendReceive(buffer, len);
     
@@ -142,6 +125,49 @@ void LoraWanHandler::sendSessionStats(uint32_t* timeInRanges, uint8_t numRanges)
     }
 }
 
+void LoraWanHandler::sendWearStats(uint32_t writes, uint32_t payloadBytes, uint32_t physicalBytes, uint16_t pageErases, uint16_t lifetimeYears) {
+    if (!_joined) return;
+
+    // Byte 0: Type (0x06 = WEAR_STATS)
+    // Byte 1-2: Uptime (minutes)
+    // Byte 3-4: Write calls (capped)
+    // Byte 5-8: Payload bytes
+    // Byte 9-12: Physical bytes (estimated)
+    // Byte 13-14: Page erases
+    // Byte 15-16: Projected flash lifetime (years)
+    uint8_t buffer[17];
+    uint32_t minutes = millis() / 60000;
+    if (minutes > 65535) minutes = 65535;
+    if (writes > 65535) writes = 65535;
+
+    buffer[0] = 0x06;
+    buffer[1] = (minutes >> 8) & 0xFF;
+    buffer[2] = minutes & 0xFF;
+    buffer[3] = (writes >> 8) & 0xFF;
+    buffer[4] = writes & 0xFF;
+    buffer[5] = (payloadBytes >> 24) & 0xFF;
+    buffer[6] = (payloadBytes >> 16) & 0xFF;
+    buffer[7] = (payloadBytes >> 8) & 0xFF;
+    buffer[8] = payloadBytes & 0xFF;
+    buffer[9] = (physicalBytes >> 24) & 0xFF;
+    buffer[10] = (physicalBytes >> 16) & 0xFF;
+    buffer[11] = (physicalBytes >> 8) & 0xFF;
+    buffer[12] = physicalBytes & 0xFF;
+    buffer[13] = (pageErases >> 8) & 0xFF;
+    buffer[14] = pageErases & 0xFF;
+    buffer[15] = (lifetimeYears >> 8) & 0xFF;
+    buffer[16] = lifetimeYears & 0xFF;
+
+    Serial.println("LoRa: Sending Wear Stats...");
+    int state = _node->sendReceive(buffer, sizeof(buffer));
+
+    if (state == RADIOLIB_ERR_NONE) {
+        Serial.println("LoRa: Wear Stats Sent");
+    } else {
+        Serial.printf("LoRa: Wear Stats TX Failed, code %d\n", state);
+    }
+}
+
 void LoraWanHandler::encodeStatus(uint8_t* buffer, size_t& len, float voltage, float tankLevel, float totalDistance) {
     // Simple Custom Protocol (CayenneLPP style or custom)
     // Using Custom for compactness
@@ -23,7 +23,20 @@ public:
     void sendStatus(float voltage, float tankLevel, float totalDistance);
     void sendAlarm(double lat, double lon);
     void sendEvent(uint8_t eventId); // 1=Ignition, 2=Home
-    void sendSessionStats(uint32_t* timeInRanges, uint8_t numRanges); // Send AI Stats
+    // Send AI Stats. Byte 0: Type (0x05 = SESSION_STATS), then seconds per range as
+    // uint16 big endian (capped at ~18 h). Sized by the range count of the build.
+    template<size_t N> void sendSessionStats(const uint32_t (&timeInRanges)[N]) {
+        static_assert(N >= 1 && N <= 10, "Session stats: 1 to 10 ranges");
+        uint8_t buffer[1 + 2 * N];
+        buffer[0] = 0x05;
+        for (size_t i = 0; i < N; i++) {
+            uint32_t seconds = timeInRanges[i] > 65535 ? 65535 : timeInRanges[i];
+            buffer[1 + i * 2] = (seconds >> 8) & 0xFF;
+            buffer[2 + i * 2] = seconds & 0xFF;
+        }
+        sendSessionPayload(buffer, sizeof(buffer));
+    }
+    void sendWearStats(uint32_t writes, uint32_t payloadBytes, uint32_t physicalBytes, uint16_t pageErases, uint16_t lifetimeYears); // Flash diagnostics
     
     // Downlink / Remote Config
     void setConfigCallback(void (*callback)(uint32_t newInterval));
@@ -38,6 +51,8 @@ public:
     void setDevEui(const char* devEui);
 
 private:
+    void sendSessionPayload(const uint8_t* buffer, size_t len);
+
     SX1262* _radio;
     LoRaWANNode* _node;
     bool _joined = false;
@@ -0,0 +1,209 @@
+/**
+ * Save-pattern benchmark (env:native_bench).
+ *
+ * Drives the real Oiler through the same simulated rides once per persistence
+ * strategy and reports what reached "flash": write calls, payload and programmed
+ * bytes, page erases and the modeled time the flash was busy, in total and per km.
+ *
+ *   persistence_bench [km] [posix-dir]
+ *
+ * Rides are deterministic (fixed seed), so runs can be compared before/after a change.
+ */
+#include <Arduino.h>
+#include "Oiler.h"
+#include "ConfigStore.h"
+#include "LogPersistence.h"
+#include "ProgressJournal.h"
+#include "RamPersistence.h"
+#include "PosixPersistence.h"
+#include "RamFlash.h"
+
+#define BENCH_DEFAULT_KM 500
+#define BENCH_RIDE_KM 40          // Ignition cycle (reboot) after each ride
+#define BENCH_GPS_INTERVAL_MS 1000
+#define BENCH_KM_PER_DEG_LAT 111.195
+
+struct Result {
+    const char* name;
+    double km;
+    uint32_t writes;
+    uint32_t payloadBytes;
+    uint32_t physicalBytes;
+    float erases;
+    float busyMs;
+};
+
+// Simple deterministic generator, independent of the host libc
+static uint32_t rng = 1;
+static uint32_t nextRandom(uint32_t max) {
+    rng = rng * 1103515245 + 12345;
+    return (rng >> 16) % max;
+}
+
+// One ride: mix of city, country road and motorway with stops in between
+static void ride(Oiler& oiler, double km, double& lat) {
+    double driven = 0.0;
+    while (driven < km) {
+        float speed;
+        uint32_t seconds;
+        switch (nextRandom(4)) {
+            case 0: speed = 25 + nextRandom(25); seconds = 60 + nextRandom(240); break;   // City
+            case 1: speed = 70 + nextRandom(30); seconds = 120 + nextRandom(600); break;  // Country
+            case 2: speed = 110 + nextRandom(20); seconds = 300 + nextRandom(900); break; // Motorway
+            default: speed = 0; seconds = 20 + nextRandom(100); break;                   // Stop
+        }
+
+        for (uint32_t s = 0; s < seconds && driven < km; s++) {
+            double step = speed * (BENCH_GPS_INTERVAL_MS / 3600000.0);
+            driven += step;
+            lat += step / BENCH_KM_PER_DEG_LAT;
+            hostClockAdvance(BENCH_GPS_INTERVAL_MS);
+            oiler.update(speed, lat, 8.5, true);
+            oiler.loop();
+        }
+    }
+
+    // Ignition off: park for a while, standstill save
+    for (int s = 0; s < 60; s++) {
+        hostClockAdvance(BENCH_GPS_INTERVAL_MS);
+        oiler.update(0, lat, 8.5, true);
+        oiler.loop();
+    }
+}
+
+static Result run(const char* name, IPersistence* store, ProgressJournal* journal,
+                  IFlashDevice* configFlash, double km) {
+    rng = 1;
+    double lat = 47.0;
+    double driven = 0.0;
+
+    while (driven < km) {
+        double rideKm = (km - driven < BENCH_RIDE_KM) ? km - driven : BENCH_RIDE_KM;
+
+        // Boot: fresh RAM state, persisted state from the store
+        configStore = ConfigStore();
+        if (configFlash) configStore.setFlash(configFlash);
+        Oiler* oiler = new Oiler(store, 2, 3, 4);
+        if (journal && journal->begin()) oiler->setProgressJournal(journal);
+        oiler->begin(0, 0);
+
+        // One settings change per ride (e.g. Rain Mode from the web UI)
+        oiler->setRainMode(!oiler->isRainMode());
+        oiler->saveConfig();
+
+        ride(*oiler, rideKm, lat);
+        driven += rideKm;
+        delete oiler;
+    }
+
+    const WearStats* wear = store->getWearStats();
+    WearCounter total = wear ? wear->getTotal() : WearCounter();
+    Result r = { name, driven, total.writes, total.payloadBytes, total.physicalBytes,
+                 wear ? wear->getEraseEstimate() : 0.0f, 0.0f };
+    return r;
+}
+
+static void printResult(const Result& r) {
+    Serial.printf("%-14s %8.0f %8lu %10lu %11lu %8.1f %10.0f | %7.2f %8.0f %9.0f %7.3f %8.1f\n",
+                  r.name, r.km, (unsigned long)r.writes, (unsigned long)r.payloadBytes,
+                  (unsigned long)r.physicalBytes, r.erases, r.busyMs,
+                  r.writes / r.km, r.payloadBytes / r.km, r.physicalBytes / r.km,
+                  r.erases / r.km, r.busyMs / r.km);
+}
+
+int main(int argc, char** argv) {
+    double km = (argc > 1) ? atof(argv[1]) : BENCH_DEFAULT_KM;
+    const char* posixDir = (argc > 2) ? argv[2] : "/tmp/chainjuicer_bench";
+    FlashCostModel cost;
+
+    Result results[5];
+    int count = 0;
+    uint32_t logCacheHits = 0, logCacheMisses = 0; // Index lookup cache of the "log" run
+
+    // 1. One file per key (NrfPersistence on InternalFS)
+    {
+        RamPersistence store(cost);
+        Result r = run("files", &store, nullptr, nullptr, km);
+        r.busyMs = cost.busyMs(store.getWearStats()->getTotal());
+        results[count++] = r;
+    }
+
+    // 2. Log-structured store on raw pages
+    {
+        RamFlash flash(cost.pageSize, KV_LOG_PAGES);
+        LogPersistence store(&flash);
+        store.mount(); // Format is not part of the save pattern
+        uint32_t words0 = flash.getWordsProgrammed(), erases0 = flash.getEraseCount();
+        Result r = run("log", &store, nullptr, nullptr, km);
+        logCacheHits = store.getCacheHits();
+        logCacheMisses = store.getCacheMisses();
+        // Measured instead of estimated: what the log really programmed and erased
+        uint32_t words = flash.getWordsProgrammed() - words0;
+        r.physicalBytes = words * 4;
+        r.erases = flash.getEraseCount() - erases0;
+        r.busyMs = r.erases * cost.eraseMs + words * cost.wordProgramUs / 1000.0f;
+        results[count++] = r;
+    }
+
+    // 3. Log-structured store + progress journal
+    // 4. Same + settings record on its own flash pages (ConfigStore::setFlash)
+    for (int withConfig = 0; withConfig < 2; withConfig++) {
+        RamFlash flash(cost.pageSize, KV_LOG_PAGES);
+        RamFlash journalFlash(cost.pageSize, PROGRESS_JOURNAL_PAGES);
+        RamFlash configFlash(cost.pageSize, CONFIG_FLASH_PAGES);
+        LogPersistence store(&flash);
+        ProgressJournal journal(&journalFlash);
+        store.mount();
+        journal.begin();
+        uint32_t journalWords0 = journalFlash.getWordsProgrammed();
+        uint32_t words0 = flash.getWordsProgrammed() + journalWords0;
+        uint32_t erases0 = flash.getEraseCount() + journalFlash.getEraseCount();
+        Result r = run(withConfig ? "log+jrnl+cfg" : "log+journal", &store, &journal,
+                       withConfig ? &configFlash : nullptr, km);
+        uint32_t words = flash.getWordsProgrammed() + journalFlash.getWordsProgrammed() - words0;
+        // Journal records count as writes and payload (they are the saved values)
+        r.writes += journal.getAppendCount();
+        r.payloadBytes += (journalFlash.getWordsProgrammed() - journalWords0) * 4;
+        // Config pages likewise (one record + header per save)
+        uint32_t configWords = configFlash.getWordsProgrammed();
+        r.writes += configFlash.getEraseCount();
+        r.payloadBytes += configWords * 4;
+        words += configWords;
+        r.physicalBytes = words * 4;
+        r.erases = flash.getEraseCount() + journalFlash.getEraseCount() + configFlash.getEraseCount() - erases0;
+        r.busyMs = r.erases * cost.eraseMs + words * cost.wordProgramUs / 1000.0f;
+        results[count++] = r;
+    }
+
+    // 5. Files on the host file system (same model as 1., state kept in posixDir)
+    {
+        {
+            // Start from factory state (not counted)
+            PosixPersistence reset(posixDir, cost);
+            const char* namespaces[] = { "oiler", CONFIG_NAMESPACE };
+            for (const char* ns : namespaces) {
+                reset.begin(ns, false);
+                reset.clear();
+                reset.end();
+            }
+        }
+        PosixPersistence store(posixDir, cost);
+        Result r = run("posix-files", &store, nullptr, nullptr, km);
+        r.busyMs = cost.busyMs(store.getWearStats()->getTotal());
+        results[count++] = r;
+    }
+
+    // Table after all runs (the Oiler logs to Serial while riding)
+    Serial.printf("\nSimulated %.0f km, %d km per ignition cycle\n\n", km, BENCH_RIDE_KM);
+    Serial.println("                      Total                                               | Per km");
+    Serial.println("Strategy             km   Writes    Payload    Physical   Erases    Busy ms |  Writes  Payload  Physical  Erases  Busy ms");
+    for (int i = 0; i < count; i++) {
+        printResult(results[i]);
+    }
+    Serial.printf("\nBusy ms: %.0f ms per page erase, %.0f us per programmed word (nRF52840 max).\n",
+                  cost.eraseMs, cost.wordProgramUs);
+    uint32_t lookups = logCacheHits + logCacheMisses;
+    Serial.printf("Log index lookups: %lu, cache hits %lu (%.1f%%).\n", (unsigned long)lookups,
+                  (unsigned long)logCacheHits, lookups ? logCacheHits * 100.0f / lookups : 0.0f);
+    return 0;
+}
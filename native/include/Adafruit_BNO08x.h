@@ -0,0 +1,31 @@
+#ifndef NATIVE_ADAFRUIT_BNO08X_H
+#define NATIVE_ADAFRUIT_BNO08X_H
+
+#include <Wire.h>
+
+#define SH2_LINEAR_ACCELERATION 0x04
+#define SH2_SIG_MOTION 0x12
+#define SH2_ARVR_STABILIZED_RV 0x28
+
+typedef uint8_t sh2_SensorId_t;
+
+typedef struct {
+    uint8_t sensorId;
+    uint8_t status;
+    union {
+        struct { float i, j, k, real, accuracy; } arvrStabilizedRV;
+        struct { float x, y, z; } linearAcceleration;
+    } un;
+} sh2_SensorValue_t;
+
+// Host stand-in: sensor not found, ImuHandler runs without IMU
+class Adafruit_BNO08x {
+public:
+    Adafruit_BNO08x(int8_t resetPin = -1) { (void)resetPin; }
+    bool begin_I2C(uint8_t addr = 0x4A, TwoWire* wire = &Wire, int32_t sensorId = 0) { (void)addr; (void)wire; (void)sensorId; return false; }
+    bool enableReport(sh2_SensorId_t, uint32_t interval_us = 10000) { (void)interval_us; return false; }
+    bool getSensorEvent(sh2_SensorValue_t*) { return false; }
+    bool wasReset() { return false; }
+};
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef NATIVE_ADAFRUIT_NEOPIXEL_H
+#define NATIVE_ADAFRUIT_NEOPIXEL_H
+
+#include <Arduino.h>
+
+#define NEO_GRB 0x52
+#define NEO_KHZ800 0x0000
+
+// Host stand-in: keeps the pixel colors in RAM, show() does nothing
+class Adafruit_NeoPixel {
+public:
+    Adafruit_NeoPixel(uint16_t n = 1, int16_t pin = -1, uint16_t type = NEO_GRB + NEO_KHZ800) : _count(n > 8 ? 8 : n) { (void)pin; (void)type; }
+    void begin() {}
+    void show() {}
+    void clear() { memset(_pixels, 0, sizeof(_pixels)); }
+    void setBrightness(uint8_t b) { _brightness = b; }
+    uint8_t getBrightness() const { return _brightness; }
+    void setPixelColor(uint16_t n, uint32_t c) { if (n < _count) _pixels[n] = c; }
+    void setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b) { setPixelColor(n, Color(r, g, b)); }
+    uint32_t getPixelColor(uint16_t n) const { return n < _count ? _pixels[n] : 0; }
+    static uint32_t Color(uint8_t r, uint8_t g, uint8_t b) { return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b; }
+
+private:
+    uint16_t _count;
+    uint8_t _brightness = 255;
+    uint32_t _pixels[8] = {};
+};
+
+#endif
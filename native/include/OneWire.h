@@ -0,0 +1,172 @@
+#ifndef NATIVE_ONEWIRE_H
+#define NATIVE_ONEWIRE_H
+
+#include <Arduino.h>
+
+#define DEVICE_DISCONNECTED_C -127
+#define HOST_ONEWIRE_SENSORS 4
+#define HOST_ONEWIRE_RESET_US 960 // 480 us low, presence sample after 70 us, 410 us recovery
+#define HOST_ONEWIRE_SLOT_US 70   // One bit (write 1: 10 + 55 us, write 0: 65 + 5 us, read: 3 + 10 + 53 us)
+
+// Simulated DS18B20s on the host bus. A sensor is present while its temperature is set
+// (hostSetTemperature()), none is by default (Oiler uses its 25°C defaults).
+struct HostDs18b20 {
+    float tempC = DEVICE_DISCONNECTED_C;
+    uint8_t config = 0x7F;            // 12 bit (factory)
+    int16_t reg = 0x0550;             // 85°C until the first conversion
+    int16_t pendingReg = 0;
+    unsigned long readyUs = 0;        // Conversion result lands in reg
+    bool converting = false;
+
+    void update() {
+        if (converting && (long)(micros() - readyUs) >= 0) { reg = pendingReg; converting = false; }
+    }
+};
+
+inline HostDs18b20 hostDs18b20[HOST_ONEWIRE_SENSORS];
+inline void hostSetTemperature(float tempC, uint8_t index = 0) { hostDs18b20[index].tempC = tempC; }
+
+/**
+ * Host stand-in for the OneWire library: byte-level protocol of the DS18B20 commands the
+ * firmware uses (skip/match ROM, search, convert, read/write scratchpad). Every bus
+ * operation advances the simulated clock by its time on the wire, so loop() stalls caused
+ * by 1-Wire traffic show up on the simulated clock.
+ */
+class OneWire {
+public:
+    OneWire(uint8_t pin) { (void)pin; }
+
+    static uint8_t crc8(const uint8_t* data, uint8_t len) {
+        uint8_t crc = 0;
+        while (len--) {
+            uint8_t b = *data++;
+            for (uint8_t i = 0; i < 8; i++) {
+                uint8_t mix = (crc ^ b) & 0x01;
+                crc >>= 1;
+                if (mix) crc ^= 0x8C;
+                b >>= 1;
+            }
+        }
+        return crc;
+    }
+
+    static void rom(uint8_t index, uint8_t* out) {
+        static const uint8_t serial[6] = { 0x5A, 0x3C, 0x11, 0x72, 0x04, 0x00 };
+        out[0] = 0x28;
+        for (uint8_t i = 0; i < 6; i++) out[1 + i] = serial[i] + index * 0x21;
+        out[7] = crc8(out, 7);
+    }
+
+    uint8_t reset() {
+        delayMicroseconds(HOST_ONEWIRE_RESET_US);
+        _state = ROM_COMMAND;
+        _selected = 0;
+        for (uint8_t i = 0; i < HOST_ONEWIRE_SENSORS; i++) {
+            if (present(i)) _selected |= 1 << i;
+        }
+        return _selected != 0;
+    }
+
+    void write(uint8_t v, uint8_t power = 0) {
+        (void)power;
+        delayMicroseconds(8 * HOST_ONEWIRE_SLOT_US);
+        switch (_state) {
+            case ROM_COMMAND:
+                if (v == 0xCC) _state = FUNCTION;
+                else if (v == 0x55) { _state = MATCH; _pos = 0; }
+                else _state = NONE;
+                break;
+            case MATCH:
+                for (uint8_t i = 0; i < HOST_ONEWIRE_SENSORS; i++) {
+                    uint8_t r[8];
+                    rom(i, r);
+                    if (r[_pos] != v) _selected &= ~(1 << i);
+                }
+                if (++_pos == 8) _state = FUNCTION;
+                break;
+            case FUNCTION:
+                if (v == 0x44) convert();
+                else if (v == 0xBE) { _state = READ_SCRATCHPAD; _pos = 0; }
+                else if (v == 0x4E) { _state = WRITE_SCRATCHPAD; _pos = 0; }
+                else _state = NONE;
+                break;
+            case WRITE_SCRATCHPAD:
+                if (++_pos == 3) { // TH, TL, config
+                    for (uint8_t i = 0; i < HOST_ONEWIRE_SENSORS; i++) {
+                        if (_selected & (1 << i)) hostDs18b20[i].config = (uint8_t)((v & 0x60) | 0x1F);
+                    }
+                    _state = NONE;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    uint8_t read() {
+        delayMicroseconds(8 * HOST_ONEWIRE_SLOT_US);
+        if (_state != READ_SCRATCHPAD || _pos >= 9) return 0xFF;
+        uint8_t v = 0xFF; // Open drain: wired AND of all selected sensors
+        for (uint8_t i = 0; i < HOST_ONEWIRE_SENSORS; i++) {
+            if (!(_selected & (1 << i))) continue;
+            uint8_t pad[9];
+            scratchpad(i, pad);
+            v &= pad[_pos];
+        }
+        _pos++;
+        return v;
+    }
+
+    void reset_search() { _searchNext = 0; }
+
+    // Devices in index order; a full search pass costs a reset, the command and 64 x 3 slots
+    bool search(uint8_t* addr, bool searchMode = true) {
+        (void)searchMode;
+        while (_searchNext < HOST_ONEWIRE_SENSORS) {
+            uint8_t i = _searchNext++;
+            if (!present(i)) continue;
+            delayMicroseconds(HOST_ONEWIRE_RESET_US + (8 + 64 * 3) * HOST_ONEWIRE_SLOT_US);
+            rom(i, addr);
+            _state = NONE;
+            return true;
+        }
+        return false;
+    }
+
+private:
+    enum State { NONE, ROM_COMMAND, MATCH, FUNCTION, READ_SCRATCHPAD, WRITE_SCRATCHPAD };
+    State _state = NONE;
+    uint8_t _selected = 0;
+    uint8_t _pos = 0;
+    uint8_t _searchNext = 0;
+
+    static bool present(uint8_t i) { return hostDs18b20[i].tempC != DEVICE_DISCONNECTED_C; }
+
+    void convert() {
+        for (uint8_t i = 0; i < HOST_ONEWIRE_SENSORS; i++) {
+            if (!(_selected & (1 << i))) continue;
+            HostDs18b20& s = hostDs18b20[i];
+            uint8_t bits = ((s.config >> 5) & 0x03) + 9;
+            s.pendingReg = (int16_t)lroundf(s.tempC * 16.0f);
+            s.readyUs = micros() + (750000UL >> (12 - bits));
+            s.converting = true;
+        }
+        _state = NONE;
+    }
+
+    static void scratchpad(uint8_t i, uint8_t* pad) {
+        HostDs18b20& s = hostDs18b20[i];
+        s.update();
+        pad[0] = (uint8_t)(s.reg & 0xFF);
+        pad[1] = (uint8_t)((uint16_t)s.reg >> 8);
+        pad[2] = 75;
+        pad[3] = 70;
+        pad[4] = s.config;
+        pad[5] = 0xFF;
+        pad[6] = 0x0C;
+        pad[7] = 0x10;
+        pad[8] = crc8(pad, 8);
+    }
+};
+
+#endif
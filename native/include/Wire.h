@@ -0,0 +1,17 @@
+#ifndef NATIVE_WIRE_H
+#define NATIVE_WIRE_H
+
+#include <Arduino.h>
+
+class TwoWire {
+public:
+    void begin() {}
+    void begin(int sda, int scl) { (void)sda; (void)scl; }
+    void end() {}
+    void setClock(uint32_t) {}
+    void setTimeOut(uint16_t) {}
+};
+
+extern TwoWire Wire;
+
+#endif
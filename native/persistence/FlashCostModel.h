@@ -0,0 +1,22 @@
+#ifndef FLASH_COST_MODEL_H
+#define FLASH_COST_MODEL_H
+
+#include "WearStats.h"
+
+/**
+ * Cost of flash operations for host-side backends and benchmarks.
+ * Defaults are the nRF52840 datasheet maxima (t_ERASEPAGE 85 ms, t_WRITE 41 us per word).
+ */
+struct FlashCostModel {
+    uint32_t pageSize = 4096;     // Erase block
+    uint32_t pagesPerWrite = 2;   // File-per-key stores: pages rewritten per put (data + metadata)
+    float eraseMs = 85.0f;
+    float wordProgramUs = 41.0f;
+
+    // Modeled time the CPU/flash is blocked for the given writes
+    float busyMs(const WearCounter& c) const {
+        return c.erases * eraseMs + (c.physicalBytes / 4) * wordProgramUs / 1000.0f;
+    }
+};
+
+#endif
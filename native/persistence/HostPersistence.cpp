@@ -0,0 +1,98 @@
+#include "HostPersistence.h"
+
+HostPersistence::HostPersistence(const FlashCostModel& cost, uint32_t erasePages) : _cost(cost) {
+    _wear.setEraseBudget(erasePages);
+}
+
+void HostPersistence::begin(const char* namespaceName, bool readOnly) {
+    (void)readOnly;
+    _namespace = namespaceName;
+}
+
+void HostPersistence::end() {
+    if (_txnActive) commit();
+}
+
+void HostPersistence::clear() {
+    clearNamespace(_namespace);
+    // Directory update
+    _wear.recordWrite((_namespace + "/(clear)").c_str(), 1, 0, _cost.pageSize, 1.0f);
+}
+
+void HostPersistence::remove(const char* key) {
+    std::string path = pathOf(key);
+    removeRaw(path);
+    _wear.recordWrite(path.c_str(), 1, 0, _cost.pageSize, 1.0f);
+}
+
+void HostPersistence::beginTransaction() {
+    _txnActive = true;
+    _txn.clear();
+}
+
+bool HostPersistence::commit() {
+    if (!_txnActive) return true;
+    _txnActive = false;
+    if (_txn.empty()) return true;
+
+    // Like NrfPersistence: the batch goes to a journal file first, then every file is replaced
+    _wear.recordWrite((_namespace + "/(journal)").c_str(), 0, 0,
+                      _cost.pagesPerWrite * _cost.pageSize, (float)_cost.pagesPerWrite);
+
+    for (const Staged& s : _txn) {
+        store(s.path, s.value.data(), s.value.size());
+    }
+    _txn.clear();
+    return true;
+}
+
+HostPersistence::Staged* HostPersistence::staged(const std::string& path) {
+    for (Staged& s : _txn) {
+        if (s.path == path) return &s;
+    }
+    return nullptr;
+}
+
+void HostPersistence::put(const char* key, const void* value, size_t len) {
+    std::string path = pathOf(key);
+    if (_txnActive) {
+        Staged* s = staged(path);
+        if (!s) {
+            _txn.push_back({path, {}});
+            s = &_txn.back();
+        }
+        s->value.assign((const uint8_t*)value, (const uint8_t*)value + len);
+        return;
+    }
+    store(path, value, len);
+}
+
+void HostPersistence::store(const std::string& path, const void* value, size_t len) {
+    writeRaw(path, value, len);
+    _wear.recordWrite(path.c_str(), 1, len, _cost.pagesPerWrite * _cost.pageSize, (float)_cost.pagesPerWrite);
+}
+
+size_t HostPersistence::getBytes(const char* key, void* buf, size_t maxLen) {
+    std::string path = pathOf(key);
+    const Staged* s = staged(path);
+    if (s) {
+        size_t len = s->value.size() < maxLen ? s->value.size() : maxLen;
+        memcpy(buf, s->value.data(), len);
+        return len;
+    }
+
+    std::vector<uint8_t> value;
+    if (!readRaw(path, value)) return 0;
+    size_t len = value.size() < maxLen ? value.size() : maxLen;
+    memcpy(buf, value.data(), len);
+    return len;
+}
+
+size_t HostPersistence::getBytesLength(const char* key) {
+    std::string path = pathOf(key);
+    const Staged* s = staged(path);
+    if (s) return s->value.size();
+
+    std::vector<uint8_t> value;
+    return readRaw(path, value) ? value.size() : 0;
+}
@@ -0,0 +1,84 @@
+#ifndef HOST_PERSISTENCE_H
+#define HOST_PERSISTENCE_H
+
+#include "Persistence.h"
+#include "FlashCostModel.h"
+#include <string>
+#include <vector>
+
+/**
+ * Base of the host-side key/value backends.
+ * Implements the typed API, transactions and wear accounting on top of four raw
+ * operations. Values are stored with the same layout as NrfPersistence (one value
+ * per "namespace/key", scalars in native byte order), and every put is charged like
+ * a LittleFS file rewrite: cost.pagesPerWrite pages programmed and erased.
+ */
+class HostPersistence : public IPersistence {
+public:
+    HostPersistence(const FlashCostModel& cost, uint32_t erasePages);
+
+    void begin(const char* namespaceName, bool readOnly) override;
+    void end() override;
+    void clear() override;
+    void remove(const char* key) override;
+
+    void beginTransaction() override;
+    bool commit() override;
+
+    void putInt(const char* key, int32_t value) override { put(key, &value, sizeof(value)); }
+    int32_t getInt(const char* key, int32_t defaultValue) override { return get(key, defaultValue); }
+
+    void putUInt(const char* key, uint32_t value) override { put(key, &value, sizeof(value)); }
+    uint32_t getUInt(const char* key, uint32_t defaultValue) override { return get(key, defaultValue); }
+
+    void putFloat(const char* key, float value) override { put(key, &value, sizeof(value)); }
+    float getFloat(const char* key, float defaultValue) override { return get(key, defaultValue); }
+
+    void putDouble(const char* key, double value) override { put(key, &value, sizeof(value)); }
+    double getDouble(const char* key, double defaultValue) override { return get(key, defaultValue); }
+
+    void putBool(const char* key, bool value) override { put(key, &value, sizeof(value)); }
+    bool getBool(const char* key, bool defaultValue) override { return get(key, defaultValue); }
+
+    void putUChar(const char* key, uint8_t value) override { put(key, &value, sizeof(value)); }
+    uint8_t getUChar(const char* key, uint8_t defaultValue) override { return get(key, defaultValue); }
+
+    void putBytes(const char* key, const void* value, size_t len) override { put(key, value, len); }
+    size_t getBytes(const char* key, void* buf, size_t maxLen) override;
+    size_t getBytesLength(const char* key) override;
+
+    const WearStats* getWearStats() const override { return &_wear; }
+    const FlashCostModel& getCostModel() const { return _cost; }
+
+protected:
+    // Raw storage, path = "namespace/key"
+    virtual bool readRaw(const std::string& path, std::vector<uint8_t>& value) = 0;
+    virtual void writeRaw(const std::string& path, const void* value, size_t len) = 0;
+    virtual void removeRaw(const std::string& path) = 0;
+    virtual void clearNamespace(const std::string& ns) = 0;
+
+private:
+    struct Staged {
+        std::string path;
+        std::vector<uint8_t> value;
+    };
+
+    FlashCostModel _cost;
+    WearStats _wear;
+    std::string _namespace;
+    bool _txnActive = false;
+    std::vector<Staged> _txn;
+
+    std::string pathOf(const char* key) const { return _namespace + "/" + key; }
+    void put(const char* key, const void* value, size_t len);
+    void store(const std::string& path, const void* value, size_t len);
+    Staged* staged(const std::string& path);
+
+    template <typename T>
+    T get(const char* key, T defaultValue) {
+        T value;
+        return (getBytes(key, &value, sizeof(T)) == sizeof(T)) ? value : defaultValue;
+    }
+};
+
+#endif
@@ -0,0 +1,55 @@
+#include "PosixPersistence.h"
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+PosixPersistence::PosixPersistence(const char* rootDir, const FlashCostModel& cost, uint32_t erasePages)
+    : HostPersistence(cost, erasePages), _root(rootDir) {
+    mkdir(_root.c_str(), 0755);
+}
+
+bool PosixPersistence::readRaw(const std::string& path, std::vector<uint8_t>& value) {
+    FILE* f = fopen(fileOf(path).c_str(), "rb");
+    if (!f) return false;
+
+    value.clear();
+    uint8_t buf[256];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        value.insert(value.end(), buf, buf + n);
+    }
+    fclose(f);
+    return true;
+}
+
+void PosixPersistence::writeRaw(const std::string& path, const void* value, size_t len) {
+    std::string file = fileOf(path);
+    mkdir(file.substr(0, file.rfind('/')).c_str(), 0755); // Namespace directory
+
+    // Write to a temp file and rename, so a killed benchmark never leaves half a value
+    std::string tmp = file + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if (!f) {
+        Serial.printf("PosixPersistence: Cannot write %s\n", file.c_str());
+        return;
+    }
+    fwrite(value, 1, len, f);
+    fclose(f);
+    rename(tmp.c_str(), file.c_str());
+}
+
+void PosixPersistence::removeRaw(const std::string& path) {
+    unlink(fileOf(path).c_str());
+}
+
+void PosixPersistence::clearNamespace(const std::string& ns) {
+    std::string dir = fileOf(ns);
+    DIR* d = opendir(dir.c_str());
+    if (!d) return;
+    struct dirent* e;
+    while ((e = readdir(d)) != nullptr) {
+        if (e->d_name[0] == '.') continue;
+        unlink((dir + "/" + e->d_name).c_str());
+    }
+    closedir(d);
+}
@@ -0,0 +1,28 @@
+#ifndef POSIX_PERSISTENCE_H
+#define POSIX_PERSISTENCE_H
+
+#include "HostPersistence.h"
+
+/**
+ * Host file system backend: one file per key ("<root>/namespace/key"), the same
+ * layout NrfPersistence uses on InternalFS. Keeps the state between benchmark runs,
+ * so a store written by one run can be inspected or reused by the next.
+ * Transactions are staged in RAM and are not crash safe on the host.
+ */
+class PosixPersistence : public HostPersistence {
+public:
+    PosixPersistence(const char* rootDir, const FlashCostModel& cost = FlashCostModel(), uint32_t erasePages = 7);
+
+protected:
+    bool readRaw(const std::string& path, std::vector<uint8_t>& value) override;
+    void writeRaw(const std::string& path, const void* value, size_t len) override;
+    void removeRaw(const std::string& path) override;
+    void clearNamespace(const std::string& ns) override;
+
+private:
+    std::string _root;
+
+    std::string fileOf(const std::string& path) const { return _root + "/" + path; }
+};
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef RAM_FLASH_H
+#define RAM_FLASH_H
+
+#include "FlashDevice.h"
+#include <vector>
+
+/**
+ * IFlashDevice in RAM with NOR semantics (write clears bits, erase sets 0xFF).
+ * Lets LogPersistence and ProgressJournal run on the host; counts programmed
+ * words and page erases for the benchmark.
+ */
+class RamFlash : public IFlashDevice {
+public:
+    RamFlash(uint32_t pageSize, uint32_t pages) : _mem(pageSize * pages, 0xFF), _pageSize(pageSize), _pages(pages) {}
+
+    bool begin() override { return true; }
+    uint32_t pageSize() const override { return _pageSize; }
+    uint32_t pageCount() const override { return _pages; }
+    const uint8_t* mapped(uint32_t offset) const override { return _mem.data() + offset; }
+
+    bool read(uint32_t offset, void* buf, size_t len) override {
+        if (offset + len > _mem.size()) return false;
+        memcpy(buf, _mem.data() + offset, len);
+        return true;
+    }
+
+    bool write(uint32_t offset, const void* data, size_t len) override {
+        if ((offset & 3) || (len & 3) || offset + len > _mem.size()) return false;
+        const uint8_t* src = (const uint8_t*)data;
+        for (size_t i = 0; i < len; i++) _mem[offset + i] &= src[i];
+        _wordsProgrammed += len / 4;
+        return true;
+    }
+
+    bool erasePage(uint32_t page) override {
+        if (page >= _pages) return false;
+        memset(_mem.data() + page * _pageSize, 0xFF, _pageSize);
+        _erases++;
+        return true;
+    }
+
+    uint32_t getEraseCount() const { return _erases; }
+    uint32_t getWordsProgrammed() const { return _wordsProgrammed; }
+
+private:
+    std::vector<uint8_t> _mem;
+    uint32_t _pageSize;
+    uint32_t _pages;
+    uint32_t _erases = 0;
+    uint32_t _wordsProgrammed = 0;
+};
+
+#endif
@@ -0,0 +1,19 @@
+#include "RamPersistence.h"
+
+bool RamPersistence::readRaw(const std::string& path, std::vector<uint8_t>& value) {
+    auto it = _values.find(path);
+    if (it == _values.end()) return false;
+    value = it->second;
+    return true;
+}
+
+void RamPersistence::writeRaw(const std::string& path, const void* value, size_t len) {
+    _values[path].assign((const uint8_t*)value, (const uint8_t*)value + len);
+}
+
+void RamPersistence::clearNamespace(const std::string& ns) {
+    std::string prefix = ns + "/";
+    for (auto it = _values.begin(); it != _values.end();) {
+        it = (it->first.compare(0, prefix.size(), prefix) == 0) ? _values.erase(it) : std::next(it);
+    }
+}
@@ -0,0 +1,29 @@
+#ifndef RAM_PERSISTENCE_H
+#define RAM_PERSISTENCE_H
+
+#include "HostPersistence.h"
+#include <map>
+
+/**
+ * In-memory key/value store with the cost model of NrfPersistence (one InternalFS
+ * file per key). Survives "reboots" as long as the object lives, e.g. when a new
+ * Oiler is constructed on the same store.
+ */
+class RamPersistence : public HostPersistence {
+public:
+    RamPersistence(const FlashCostModel& cost = FlashCostModel(), uint32_t erasePages = 7)
+        : HostPersistence(cost, erasePages) {}
+
+    size_t getKeyCount() const { return _values.size(); }
+
+protected:
+    bool readRaw(const std::string& path, std::vector<uint8_t>& value) override;
+    void writeRaw(const std::string& path, const void* value, size_t len) override;
+    void removeRaw(const std::string& path) override { _values.erase(path); }
+    void clearNamespace(const std::string& ns) override;
+
+private:
+    std::map<std::string, std::vector<uint8_t>> _values;
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef SIM_PULSE_GENERATOR_H
+#define SIM_PULSE_GENERATOR_H
+
+#include "PulseGenerator.h"
+
+/**
+ * IPulseGenerator on the simulated clock: the train timeline is computed from micros(),
+ * as exact as the nRF52 TIMER (1 us). cancel() and stop() follow NrfPulseGenerator:
+ * a cancelled train finishes its running pulse, a stopped one cuts it and does not count it.
+ */
+class SimPulseGenerator : public IPulseGenerator {
+public:
+    bool begin(uint8_t pin) override { _pin = pin; return true; }
+
+    bool start(uint16_t count, uint32_t pulseUs, uint32_t pauseUs) override {
+        if (count == 0 || pulseUs == 0 || busy()) return false;
+        _delivered += completed();
+        _startUs = micros();
+        _pulseUs = pulseUs;
+        _periodUs = pulseUs + pauseUs;
+        _limit = count;
+        _trains++;
+        return true;
+    }
+
+    void cancel() override {
+        uint32_t started = elapsedUs() / _periodUs + 1;
+        if (started < _limit) _limit = (uint16_t)started;
+    }
+
+    void stop() override {
+        _limit = completed();
+        _stops++;
+    }
+
+    uint16_t completed() override {
+        if (_limit == 0) return 0;
+        uint32_t t = elapsedUs();
+        if (t < _pulseUs) return 0;
+        uint32_t ended = (t - _pulseUs) / _periodUs + 1;
+        return ended < _limit ? (uint16_t)ended : _limit;
+    }
+
+    bool busy() override { return completed() < _limit; }
+
+    uint32_t getTrains() const { return _trains; }
+    uint32_t getStops() const { return _stops; }
+    uint32_t getPulses() { return _delivered + completed(); } // Pulses that ran their full width
+    uint32_t getPulseUs() const { return _pulseUs; }
+
+private:
+    uint8_t _pin = 0;
+    uint32_t _startUs = 0;
+    uint32_t _pulseUs = 1;
+    uint32_t _periodUs = 1;
+    uint16_t _limit = 0;
+    uint32_t _trains = 0;
+    uint32_t _stops = 0;
+    uint32_t _delivered = 0;
+
+    uint32_t elapsedUs() const { return (uint32_t)micros() - _startUs; }
+};
+
+#endif
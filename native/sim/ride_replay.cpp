@@ -0,0 +1,743 @@
+/**
+ * Ride replay (env:native_sim).
+ *
+ * Feeds recorded rides into the real Oiler faster than real time: GPS fixes go to
+ * update() like main.cpp does, loop() runs in between on the simulated clock and the
+ * clock then jumps to the next deadline (msUntilNextDue(), like main.cpp sleeps).
+ * Prints one line per oiling decision, the host CPU time per update()/loop() call,
+ * the loop() wakeups per second and how many LED frames had to be pushed to the strip.
+ * The 1-Wire bus advances the simulated clock by its time on the wire; the longest
+ * loop() call on the simulated clock is the worst stall the temperature sensors cause.
+ *
+ *   ride_replay [options] trace...
+ *     -n N    replay each trace N times (one ignition cycle each, state is kept)
+ *     -i MS   fixed loop() step while the pump is idle instead of the deadlines
+ *     -s      pump pulses timed by loop() instead of the hardware train (SimPulseGenerator)
+ *     -t C[,C...]  DS18B20 readings in °C, one sensor each (default: no sensor)
+ *     -r FILE write the flight recorder (16 pages of RAM flash, kept over all rides) as CSV
+ *     -q      no per-oiling lines, summary only
+ *     -v      show the firmware log (Serial)
+ *
+ *   ride_replay --odometer KM
+ *     accuracy of the fixed-point Odometer over KM of 1 Hz hops against a long double sum
+ *
+ *   ride_replay --distance
+ *     GeoDistance error against long double haversine (latitudes 0-85 deg, hops 1 m-20 km,
+ *     36 bearings) and host time per call of GeoDistance vs TinyGPSPlus::distanceBetween
+ *
+ *   ride_replay --speed [trace]
+ *     lag and noise of the speed filters: former 5-sample average vs SpeedEstimator without
+ *     and with IMU. Truth is a synthetic stop-and-go profile or the speed of the trace;
+ *     GPS gets 1 Hz noise, the IMU 50 Hz acceleration with bias and vibration noise
+ *
+ *   ride_replay --viscosity
+ *     temperature compensation factor from ViscosityTable against the analytic model (double)
+ *     and the former float exp()/pow() code, -30 to 80 deg C in 0.01 steps; host time per call
+ *
+ *   ride_replay --pulse
+ *     pump pulse widths with the main loop stalling at random (blocking LoRa uplinks,
+ *     flash erases): pulses timed by loop() vs the hardware train (SimPulseGenerator),
+ *     and how late the firmware sees the end of a train
+ *
+ * Trace formats (detected per file):
+ *   NMEA  raw GPS log ($GPRMC/$GNRMC/$GPGGA...), parsed by TinyGPSPlus as on the device
+ *   CSV   t_s,lat,lon,speed_kmh[,temp_c] per line; '#' comments and a header are skipped
+ *
+ * Sample trace (scripts/make_ride_trace.py, fixed seed; 4715 s stop-and-go at 0-120 km/h):
+ *   python3 scripts/make_ride_trace.py /tmp/sim && ride_replay -q -n 3 /tmp/sim/ride.csv
+ *   -> 3 rides, 224.8 km, 49 oilings
+ *
+ * Example, a year of commuting: ride_replay -q -n 400 commute.nmea
+ */
+#include <Arduino.h>
+#include <TinyGPS++.h>
+#include <OneWire.h>
+#include <ctype.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "Oiler.h"
+#include "ConfigStore.h"
+#include "RamPersistence.h"
+#include "RamFlash.h"
+#include "FlightRecorder.h"
+#include "Odometer.h"
+#include "GeoDistance.h"
+#include "SpeedEstimator.h"
+#include "SimPulseGenerator.h"
+#include "ViscosityTable.h"
+
+#define SIM_PUMP_PIN 2
+#define SIM_LED_PIN 3
+#define SIM_TEMP_PIN 4
+#define SIM_PUMP_STEP_MS 1        // loop() resolution while the pump runs (-i)
+#define SIM_PARK_SECONDS 60       // Standing still after each ride (standstill save)
+#define SIM_TIMING_BUCKET_NS 50
+#define SIM_TIMING_BUCKETS 2000   // Histogram up to 100 us, slower calls land in the last bucket
+#define SIM_RECORDER_PAGES 16     // FLIGHT_RECORDER_PAGES
+
+struct Sample {
+    double t;      // Seconds since trace start
+    double lat;
+    double lon;
+    float speedKmh;
+    float tempC;   // NAN = keep
+    int hour;      // UTC hour, -1 = unknown
+};
+
+// Host CPU time per call (steady_clock, includes ~20-40 ns of clock overhead)
+struct CallTiming {
+    uint64_t calls = 0;
+    uint64_t totalNs = 0;
+    uint64_t maxNs = 0;
+    std::vector<uint32_t> buckets = std::vector<uint32_t>(SIM_TIMING_BUCKETS);
+
+    void add(uint64_t ns) {
+        calls++;
+        totalNs += ns;
+        if (ns > maxNs) maxNs = ns;
+        uint64_t b = ns / SIM_TIMING_BUCKET_NS;
+        buckets[b < SIM_TIMING_BUCKETS ? b : SIM_TIMING_BUCKETS - 1]++;
+    }
+
+    uint64_t percentile(double p) const {
+        uint64_t target = (uint64_t)(calls * p), seen = 0;
+        for (int i = 0; i < SIM_TIMING_BUCKETS; i++) {
+            seen += buckets[i];
+            if (seen > target) return (uint64_t)(i + 1) * SIM_TIMING_BUCKET_NS;
+        }
+        return maxNs;
+    }
+
+    void print(const char* name) const {
+        printf("%-9s %10llu calls  mean %6.0f ns  p50 <%5llu ns  p99 <%6llu ns  max %8llu ns\n",
+               name, (unsigned long long)calls, calls ? (double)totalNs / calls : 0.0,
+               (unsigned long long)percentile(0.50), (unsigned long long)percentile(0.99),
+               (unsigned long long)maxNs);
+    }
+};
+
+struct Options {
+    int repeat = 1;
+    unsigned long idleStepMs = 0;   // 0: step to the next deadline
+    std::vector<float> tempC;       // One DS18B20 each
+    bool quiet = false;
+    bool verbose = false;
+    bool softPulses = false;        // -s: no pulse generator, loop() times the pulses
+    const char* recorderCsv = nullptr;
+};
+
+static CallTiming updateTiming;
+static CallTiming loopTiming;
+static unsigned long lastPumpCycles = 0;
+static uint32_t oilings = 0;
+static double simSeconds = 0.0;
+static double odometerKm = 0.0;
+static uint32_t ledShown = 0, ledSkipped = 0;
+static uint32_t pumpTrains = 0, pumpMaxLatencyUs = 0;
+static uint64_t pumpLatencySumUs = 0;
+static uint32_t loopStallMaxUs = 0;     // Longest loop() on the simulated clock
+static RamFlash recorderFlash(4096, SIM_RECORDER_PAGES);
+static FlightRecorder recorder(&recorderFlash);
+static uint32_t tempReadings = 0, tempErrors = 0, tempMaxStepUs = 0;
+
+static bool loadCsv(FILE* f, std::vector<Sample>& out) {
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        if (line[0] == '#' || !(isdigit((unsigned char)line[0]) || line[0] == '-' || line[0] == '.')) continue;
+        Sample s = { 0, 0, 0, 0, NAN, -1 };
+        int n = sscanf(line, "%lf,%lf,%lf,%f,%f", &s.t, &s.lat, &s.lon, &s.speedKmh, &s.tempC);
+        if (n < 4) continue;
+        if (n < 5) s.tempC = NAN;
+        out.push_back(s);
+    }
+    return !out.empty();
+}
+
+static bool loadNmea(FILE* f, std::vector<Sample>& out) {
+    TinyGPSPlus gps;
+    double dayOffset = 0.0, lastTod = -1.0, t0 = -1.0;
+    int c;
+    while ((c = fgetc(f)) != EOF) {
+        if (!gps.encode((char)c)) continue;
+        if (!(gps.location.isUpdated() || gps.speed.isUpdated()) || !gps.location.isValid()) continue;
+
+        double t;
+        if (gps.time.isValid()) {
+            double tod = gps.time.hour() * 3600.0 + gps.time.minute() * 60.0 +
+                         gps.time.second() + gps.time.centisecond() / 100.0;
+            if (lastTod >= 0.0 && tod + 43200.0 < lastTod) dayOffset += 86400.0; // Midnight
+            lastTod = tod;
+            t = tod + dayOffset;
+        } else {
+            t = out.empty() ? 0.0 : out.back().t + t0 + 1.0; // Assume 1 Hz
+        }
+        if (t0 < 0.0) t0 = t;
+
+        Sample s = { t - t0, gps.location.lat(), gps.location.lng(), (float)gps.speed.kmph(), NAN,
+                     gps.time.isValid() ? gps.time.hour() : -1 };
+        if (!out.empty() && s.t <= out.back().t) continue; // Same fix from another sentence
+        out.push_back(s);
+    }
+    return !out.empty();
+}
+
+static bool loadTrace(const char* path, std::vector<Sample>& out) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+    int first;
+    while ((first = fgetc(f)) != EOF && isspace(first)) {}
+    rewind(f);
+    bool ok = (first == '$') ? loadNmea(f, out) : loadCsv(f, out);
+    fclose(f);
+    if (!ok) fprintf(stderr, "%s: no usable samples\n", path);
+    return ok;
+}
+
+static void checkOiling(Oiler& oiler, const Sample& s, const Options& opt) {
+    unsigned long cycles = oiler.getPumpCycles();
+    if (cycles == lastPumpCycles) return;
+    oilings += cycles - lastPumpCycles;
+    lastPumpCycles = cycles;
+    if (opt.quiet) return;
+    printf("oil,%.1f,%.3f,%.1f,%.1f,%.2f,%.2f,%s%s%s\n", simSeconds, oiler.getOdometer(),
+           s.speedKmh, oiler.getSmoothedSpeed(), oiler.getCurrentTargetDistance(),
+           oiler.currentTankLevelMl, oiler.isRainMode() ? "R" : "",
+           oiler.isOffroadMode() ? "O" : "", oiler.isEmergencyMode() ? "E" : "");
+}
+
+static void timedLoop(Oiler& oiler) {
+    uint32_t us0 = micros();
+    auto t0 = std::chrono::steady_clock::now();
+    oiler.loop();
+    auto t1 = std::chrono::steady_clock::now();
+    loopTiming.add(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+    uint32_t stallUs = micros() - us0;
+    if (stallUs > loopStallMaxUs) loopStallMaxUs = stallUs;
+}
+
+// Flight recorder dump through the bulk read API, as 'r' on the device console
+static bool writeRecorderCsv(const char* path) {
+    FILE* f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        return false;
+    }
+    fprintf(f, "time,lat,lon,speed_kmh,lean_deg,temp_c,pulse_ms,pause_ms,pulses,flags,tank_ml\n");
+    FlightRecorder::Entry chunk[64];
+    uint32_t index = 0;
+    size_t n;
+    while ((n = recorder.read(index, chunk, 64)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            const FlightRecorder::Entry& e = chunk[i];
+            fprintf(f, "%lu,%.5f,%.5f,%.1f,%.0f,%.0f,%u,%u,%u,%u,%.1f\n", (unsigned long)e.time, e.lat, e.lon,
+                    e.speedKmh, e.leanDeg, e.tempC, e.pulseMs, e.pauseMs, e.pulses, e.flags, e.tankMl);
+        }
+        index += n;
+    }
+    fclose(f);
+    return true;
+}
+
+// Runs loop() until 'ms' of simulated time have passed
+static void advance(Oiler& oiler, unsigned long ms, const Sample& s, const Options& opt) {
+    while (ms > 0) {
+        unsigned long step;
+        if (opt.idleStepMs) {
+            step = oiler.isPumpRunning() ? SIM_PUMP_STEP_MS : opt.idleStepMs;
+        } else {
+            step = oiler.msUntilNextDue();
+            if (step == 0) step = 1; // Something is due now: it runs in this step
+        }
+        if (step > ms) step = ms;
+        hostClockAdvance(step);
+        simSeconds += step / 1000.0;
+        ms -= step;
+        timedLoop(oiler);
+        checkOiling(oiler, s, opt);
+    }
+}
+
+static void ride(IPersistence* store, const std::vector<Sample>& trace, const Options& opt) {
+    // Boot: fresh RAM state, persisted state from the store
+    configStore = ConfigStore();
+    SimPulseGenerator pulses;
+    Oiler* oiler = new Oiler(store, SIM_PUMP_PIN, SIM_LED_PIN, SIM_TEMP_PIN, opt.softPulses ? nullptr : &pulses);
+    if (recorder.begin()) oiler->setFlightRecorder(&recorder);
+    oiler->begin(0, 0);
+    recorder.setTime(FlightRecorder::unixTime(2025, 6, 1, 8, 0, 0) + (uint32_t)simSeconds); // Rides back to back
+    lastPumpCycles = oiler->getPumpCycles();
+
+    double lastT = trace.front().t;
+    for (const Sample& s : trace) {
+        advance(*oiler, (unsigned long)((s.t - lastT) * 1000.0 + 0.5), s, opt);
+        lastT = s.t;
+        if (!isnan(s.tempC)) hostSetTemperature(s.tempC);
+        if (s.hour >= 0) oiler->setCurrentHour(s.hour);
+
+        auto t0 = std::chrono::steady_clock::now();
+        oiler->update(s.speedKmh, s.lat, s.lon, true);
+        auto t1 = std::chrono::steady_clock::now();
+        updateTiming.add(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+        checkOiling(*oiler, s, opt);
+    }
+
+    // Ignition off: park, then write what is still pending
+    Sample park = trace.back();
+    park.speedKmh = 0;
+    for (int i = 0; i < SIM_PARK_SECONDS; i++) {
+        advance(*oiler, 1000, park, opt);
+        oiler->update(0, park.lat, park.lon, true);
+    }
+    oiler->flushPendingSaves(true);
+    odometerKm = oiler->getOdometer();
+    ledShown += oiler->getLedFramesRendered();
+    ledSkipped += oiler->getLedFramesSkipped();
+    const PulseTrain& train = oiler->getPumpTrain();
+    pumpTrains += train.getTrains();
+    pumpLatencySumUs += (uint64_t)train.getMeanLatencyUs() * train.getTrains();
+    if (train.getMaxLatencyUs() > pumpMaxLatencyUs) pumpMaxLatencyUs = train.getMaxLatencyUs();
+    const TempSensors& temp = oiler->getTempSensors();
+    tempReadings += temp.getReadings();
+    tempErrors += temp.getErrors();
+    if (temp.getMaxStepUs() > tempMaxStepUs) tempMaxStepUs = temp.getMaxStepUs();
+    delete oiler;
+}
+
+// Odometer (float hops, integer mm) against a long double sum of the exact hops.
+// Speed does a random walk between 5 and 200 km/h; each hop is one 1 Hz fix.
+static int odometerCheck(double km) {
+    Odometer odo;
+    long double refKm = 0.0L;
+    double speed = 60.0, maxErrM = 0.0;
+    uint32_t rng = 1;
+    uint64_t hops = 0;
+    while (refKm < km) {
+        rng = rng * 1103515245 + 12345;
+        speed += ((int)((rng >> 16) % 2001) - 1000) / 200.0; // +-5 km/h per second
+        speed = constrain(speed, 5.0, 200.0);
+        double hopKm = speed / 3600.0;
+        odo.add((float)hopKm); // Firmware sees the hop as float
+        refKm += hopKm;
+        hops++;
+        if ((hops & 0xFFF) == 0) {
+            double err = fabs((double)(odo.km() - (double)refKm)) * 1000.0;
+            if (err > maxErrM) maxErrM = err;
+        }
+    }
+    double errM = (odo.km() - (double)refKm) * 1000.0;
+    if (fabs(errM) > maxErrM) maxErrM = fabs(errM);
+    printf("Odometer: %.0f km in %llu hops, error %+.3f m at the end, max %.3f m (%.2e relative)\n",
+           (double)refKm, (unsigned long long)hops, errM, maxErrM, maxErrM / ((double)refKm * 1000.0));
+    return 0;
+}
+
+static long double haversineRef(long double lat1, long double lon1, long double lat2, long double lon2) {
+    const long double r = PI / 180.0L;
+    long double sLat = sinl((lat2 - lat1) * r * 0.5L), sLon = sinl((lon2 - lon1) * r * 0.5L);
+    long double a = sLat * sLat + cosl(lat1 * r) * cosl(lat2 * r) * sLon * sLon;
+    return 2.0L * GEO_EARTH_RADIUS_M * atan2l(sqrtl(a), sqrtl(1.0L - a));
+}
+
+// Error per hop length class, then the host cost of both kernels on 1 Hz-like hops
+static int distanceCheck() {
+    static const double lats[] = {0.0, 15.0, 30.0, 45.0, 52.5, 60.0, 70.0, 80.0, 84.9, -45.0};
+    static const double hops[] = {1.0, 10.0, 30.0, 100.0, 1000.0, 5000.0, 11000.0, 20000.0};
+    const long double r = PI / 180.0L;
+    printf("hop m      max abs m    max rel   fallbacks\n");
+    for (double hop : hops) {
+        double maxAbs = 0.0, maxRel = 0.0;
+        uint32_t fallbacks = 0;
+        for (double lat : lats) {
+            GeoDistance geo;
+            for (int b = 0; b < 36; b++) {
+                // Destination on the sphere (long double), offset in longitude to avoid 0.0
+                long double brg = b * 10.0L * r, d = hop / (long double)GEO_EARTH_RADIUS_M;
+                long double la1 = lat * r, lo1 = (11.0L + b * 0.37L) * r;
+                long double la2 = asinl(sinl(la1) * cosl(d) + cosl(la1) * sinl(d) * cosl(brg));
+                long double lo2 = lo1 + atan2l(sinl(brg) * sinl(d) * cosl(la1), cosl(d) - sinl(la1) * sinl(la2));
+                double lat1 = (double)(la1 / r), lon1 = (double)(lo1 / r);
+                double lat2 = (double)(la2 / r), lon2 = (double)(lo2 / r);
+                double ref = (double)haversineRef(lat1, lon1, lat2, lon2);
+                double err = fabs(geo.metres(lat1, lon1, lat2, lon2) - ref);
+                if (err > maxAbs) maxAbs = err;
+                if (err / ref > maxRel) maxRel = err / ref;
+            }
+            fallbacks += geo.getFallbacks();
+        }
+        printf("%7.0f  %11.6f  %9.2e  %5lu/%u\n", hop, maxAbs, maxRel, (unsigned long)fallbacks,
+               (unsigned)(sizeof(lats) / sizeof(lats[0]) * 36));
+    }
+
+    // 10 Hz track at ~80 km/h heading north-east from 48 deg
+    const int n = 200000;
+    std::vector<double> track(2 * (n + 1));
+    for (int i = 0; i <= n; i++) {
+        track[2 * i] = 48.0 + i * 1.5e-5;
+        track[2 * i + 1] = 11.0 + i * 2.0e-5;
+    }
+    GeoDistance geo;
+    volatile double sinkGeo = 0.0, sinkTiny = 0.0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) sinkGeo = sinkGeo + geo.metres(track[2 * i], track[2 * i + 1], track[2 * i + 2], track[2 * i + 3]);
+    auto t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) sinkTiny = sinkTiny + TinyGPSPlus::distanceBetween(track[2 * i], track[2 * i + 1], track[2 * i + 2], track[2 * i + 3]);
+    auto t2 = std::chrono::steady_clock::now();
+    double nsGeo = std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+    double nsTiny = std::chrono::duration<double, std::nano>(t2 - t1).count() / n;
+    printf("\nHost time per hop: GeoDistance %.1f ns, TinyGPSPlus::distanceBetween %.1f ns (%lu cos refreshes)\n",
+           nsGeo, nsTiny, (unsigned long)geo.getRefreshes());
+    printf("Track %.3f km vs %.3f km\n", sinkGeo * 0.001, sinkTiny * 0.001);
+    return 0;
+}
+
+#define SPEED_IMU_HZ 50
+
+// Deterministic Gaussian noise (Box-Muller on an LCG)
+static float gaussian(uint32_t& rng) {
+    rng = rng * 1664525u + 1013904223u;
+    float u1 = ((rng >> 8) + 1) * (1.0f / 16777217.0f);
+    rng = rng * 1664525u + 1013904223u;
+    float u2 = (rng >> 8) * (1.0f / 16777216.0f);
+    return sqrtf(-2.0f * logf(u1)) * cosf(6.2831853f * u2);
+}
+
+// Synthetic ride at SPEED_IMU_HZ: accelerate, cruise, brake, repeated with varying targets
+static void syntheticSpeed(std::vector<float>& truth) {
+    uint32_t rng = 7;
+    float v = 0.0f;
+    for (int seg = 0; seg < 120; seg++) {
+        rng = rng * 1664525u + 1013904223u;
+        float target = (seg % 6 == 5) ? 0.0f : 20.0f + (rng >> 8) % 110; // Stop every 6th segment
+        float accel = (target > v ? 2.0f + (rng >> 4) % 3 : -(3.0f + (rng >> 6) % 4)) * 3.6f; // km/h/s
+        while (fabsf(target - v) > 0.01f) {
+            float step = accel / SPEED_IMU_HZ;
+            v = fabsf(target - v) < fabsf(step) ? target : v + step;
+            truth.push_back(v);
+        }
+        for (int i = 0; i < (10 + (int)((rng >> 10) % 30)) * SPEED_IMU_HZ; i++) truth.push_back(v);
+    }
+}
+
+static void traceSpeed(const std::vector<Sample>& trace, std::vector<float>& truth) {
+    for (size_t i = 0; i + 1 < trace.size(); i++) {
+        int n = (int)lround((trace[i + 1].t - trace[i].t) * SPEED_IMU_HZ);
+        for (int k = 0; k < n; k++) {
+            truth.push_back(trace[i].speedKmh + (trace[i + 1].speedKmh - trace[i].speedKmh) * k / n);
+        }
+    }
+}
+
+struct FilterStats {
+    const char* name;
+    double sumSq = 0, cruiseSq = 0, lagSum = 0, accelSum = 0;
+    uint32_t n = 0, cruiseN = 0;
+
+    void add(float est, float truth, float accelKmhS, bool cruise) {
+        double err = est - truth;
+        sumSq += err * err;
+        n++;
+        if (cruise) {
+            cruiseSq += err * err;
+            cruiseN++;
+        }
+        if (fabsf(accelKmhS) > 3.0f) { // Lag = error / rate of change, weighted by the rate
+            lagSum += -err * (accelKmhS > 0 ? 1 : -1);
+            accelSum += fabsf(accelKmhS);
+        }
+    }
+    void print() const {
+        printf("%-20s %9.2f %12.2f %9.2f\n", name, sqrt(sumSq / n), cruiseN ? sqrt(cruiseSq / cruiseN) : 0.0,
+               accelSum > 0 ? lagSum / accelSum : 0.0);
+    }
+};
+
+static int speedCheck(const char* path) {
+    std::vector<float> truth;
+    if (path) {
+        std::vector<Sample> trace;
+        if (!loadTrace(path, trace)) return 1;
+        traceSpeed(trace, truth);
+    } else {
+        syntheticSpeed(truth);
+    }
+
+    uint32_t rng = 99;
+    const float imuBias = 0.2f;      // m/s^2, mounting tilt and offset
+    const float imuNoise = 1.0f;     // m/s^2, engine and road vibration
+    const float gpsNoise = SpeedEstimator::GPS_NOISE_KMH;
+
+    float box[5] = {0};
+    int boxIndex = 0;
+    SpeedEstimator gpsOnly, fused;
+    FilterStats stats[3];
+    stats[0].name = "5-sample average";
+    stats[1].name = "estimator, GPS only";
+    stats[2].name = "estimator, GPS+IMU";
+    float deltaV = 0.0f;
+    uint64_t ns[2] = {0, 0};
+
+    for (size_t i = 1; i < truth.size(); i++) {
+        float accelKmhS = (truth[i] - truth[i - 1]) * SPEED_IMU_HZ;
+        deltaV += (accelKmhS / 3.6f + imuBias + imuNoise * gaussian(rng)) / SPEED_IMU_HZ;
+        if (i % SPEED_IMU_HZ) continue;
+
+        // 1 Hz fix
+        float gps = truth[i] + gpsNoise * gaussian(rng);
+        if (gps < 0.0f) gps = 0.0f;
+        box[boxIndex] = gps;
+        boxIndex = (boxIndex + 1) % 5;
+        float avg = (box[0] + box[1] + box[2] + box[3] + box[4]) / 5.0f;
+        auto t0 = std::chrono::steady_clock::now();
+        float g = gpsOnly.update(gps, 1.0f, 0.0f, false);
+        auto t1 = std::chrono::steady_clock::now();
+        float f = fused.update(gps, 1.0f, deltaV, true);
+        auto t2 = std::chrono::steady_clock::now();
+        ns[0] += std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+        ns[1] += std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count();
+        deltaV = 0.0f;
+
+        // Cruise: no speed change during the last 5 s (box filter settled)
+        bool cruise = i >= 5 * SPEED_IMU_HZ && truth[i] > 5.0f && truth[i - 5 * SPEED_IMU_HZ] == truth[i];
+        float slope = (truth[i] - truth[i - SPEED_IMU_HZ / 2]) * 2.0f;
+        stats[0].add(avg, truth[i], slope, cruise);
+        stats[1].add(g, truth[i], slope, cruise);
+        stats[2].add(f, truth[i], slope, cruise);
+    }
+
+    printf("%s, %.0f min at 1 Hz, GPS noise %.1f km/h, IMU bias %.1f m/s^2, IMU noise %.1f m/s^2\n\n",
+           path ? path : "synthetic stop-and-go", truth.size() / (60.0 * SPEED_IMU_HZ), gpsNoise, imuBias, imuNoise);
+    printf("%-20s %9s %12s %9s\n", "filter", "RMS km/h", "cruise km/h", "lag s");
+    for (const FilterStats& s : stats) s.print();
+    printf("\nIMU bias estimate %.3f m/s^2, host time per update %.0f / %.0f ns\n", fused.biasKmhS() / 3.6f,
+           (double)ns[0] / stats[0].n, (double)ns[1] / stats[0].n);
+    return 0;
+}
+
+#define PULSE_OILINGS 2000
+#define PULSE_PER_OILING 3
+#define PULSE_OIL_EVERY_MS 10000
+#define PULSE_STALL_MIN_MS 20      // GPS burst, flash page erase is ~85 ms
+#define PULSE_STALL_MAX_MS 2500    // LoRaWAN sendReceive() with RX1 and RX2 windows
+#define PULSE_STALL_GAP_MS 20000   // Mean time between stalls (uniform 0..2x)
+
+struct PulseResult {
+    std::vector<uint32_t> widthsUs; // Measured at the pump pin (loop() timing) or by the generator
+    uint32_t trains = 0;
+    uint32_t meanLatencyUs = 0;
+    uint32_t maxLatencyUs = 0;
+};
+
+// One Oiler, PULSE_OILINGS oilings of PULSE_PER_OILING pulses, random main loop stalls
+static void pulseRun(bool hardware, PulseResult& r) {
+    FlashCostModel cost;
+    RamPersistence store(cost);
+    configStore = ConfigStore();
+    SimPulseGenerator gen;
+    Oiler* oiler = new Oiler(&store, SIM_PUMP_PIN, SIM_LED_PIN, SIM_TEMP_PIN, hardware ? &gen : nullptr);
+    oiler->begin(0, 0);
+
+    uint32_t rng = 5;
+    auto uniform = [&rng](uint32_t n) { rng = rng * 1664525u + 1013904223u; return (rng >> 8) % n; };
+    unsigned long nextStall = millis() + uniform(2 * PULSE_STALL_GAP_MS);
+    unsigned long nextOil = millis() + 1000;
+    int oilings = 0;
+    int level = hostPinLevel(SIM_PUMP_PIN);
+    unsigned long riseUs = 0;
+    uint32_t pulsesBefore = 0;
+
+    while (oilings < PULSE_OILINGS || oiler->isPumpRunning()) {
+        if (oilings < PULSE_OILINGS && (long)(millis() - nextOil) >= 0 && !oiler->isPumpRunning()) {
+            oiler->triggerOil(PULSE_PER_OILING);
+            oilings++;
+            nextOil = millis() + PULSE_OIL_EVERY_MS;
+        }
+
+        if ((long)(millis() - nextStall) >= 0) {
+            hostClockAdvance(PULSE_STALL_MIN_MS + uniform(PULSE_STALL_MAX_MS - PULSE_STALL_MIN_MS));
+            nextStall = millis() + uniform(2 * PULSE_STALL_GAP_MS);
+        } else {
+            unsigned long step = oiler->msUntilNextDue();
+            hostClockAdvance(step > 0 ? step : 1);
+        }
+        oiler->loop();
+
+        // loop() timing: the pin only changes inside loop(), so micros() is the edge time
+        int now = hostPinLevel(SIM_PUMP_PIN);
+        if (now != level) {
+            if (now) riseUs = micros();
+            else r.widthsUs.push_back(micros() - riseUs);
+            level = now;
+        }
+        // Hardware train: widths are the generator's compare value (full pulses only)
+        for (uint32_t pulses = gen.getPulses(); pulsesBefore < pulses; pulsesBefore++) r.widthsUs.push_back(gen.getPulseUs());
+    }
+
+    const PulseTrain& train = oiler->getPumpTrain();
+    r.trains = train.getTrains();
+    r.meanLatencyUs = train.getMeanLatencyUs();
+    r.maxLatencyUs = train.getMaxLatencyUs();
+    delete oiler;
+}
+
+static void pulsePrint(const char* name, PulseResult& r) {
+    std::vector<uint32_t>& w = r.widthsUs;
+    std::sort(w.begin(), w.end());
+    double sum = 0;
+    size_t stretched = 0;
+    for (uint32_t us : w) {
+        sum += us;
+        if (us > PULSE_DURATION_MS * 1000 + 1000) stretched++;
+    }
+    size_t n = w.size();
+    printf("%-16s %6zu %8.1f %8.1f %8.1f %9.1f %8.2f%%\n", name, n, n ? sum / n / 1000.0 : 0.0,
+           n ? w[n / 2] / 1000.0 : 0.0, n ? w[(size_t)(n * 0.99)] / 1000.0 : 0.0, n ? w[n - 1] / 1000.0 : 0.0,
+           n ? stretched * 100.0 / n : 0.0);
+}
+
+// Former Oiler::updateTemperature(): two exp() and a pow() in float per reading
+static float viscosityFloatFormula(uint8_t oilType, float tempC) {
+    const float A = -8.122;
+    const float B = 3931.8;
+    float tempK = tempC + 273.15f;
+    float viscosityCurrent = expf(A + (B / tempK));
+    float viscosityRef = expf(A + (B / (25.0f + 273.15f)));
+    float exponent = oilType == 0 ? 0.15f : (oilType == 2 ? 0.35f : 0.25f);
+    return powf(viscosityCurrent / viscosityRef, exponent);
+}
+
+static int viscosityCheck() {
+    static const char* names[VISC_OIL_TYPES] = { "thin", "normal", "thick" };
+    printf("oil      factor range     table max rel   at C   float formula max rel\n");
+    for (uint8_t oil = 0; oil < VISC_OIL_TYPES; oil++) {
+        double maxTable = 0.0, maxFloat = 0.0, worstC = 0.0;
+        for (int i = VISC_TEMP_MIN_C * 100; i <= VISC_TEMP_MAX_C * 100; i++) {
+            double c = i / 100.0;
+            double ref = ViscosityTable::model(oil, c);
+            double errTable = fabs(ViscosityTable::factor(oil, (float)c) - ref) / ref;
+            double errFloat = fabs(viscosityFloatFormula(oil, (float)c) - ref) / ref;
+            if (errTable > maxTable) { maxTable = errTable; worstC = c; }
+            if (errFloat > maxFloat) maxFloat = errFloat;
+        }
+        printf("%-7s  %.3f - %.3f  %13.2e  %5.2f  %22.2e\n", names[oil], ViscosityTable::model(oil, VISC_TEMP_MAX_C),
+               ViscosityTable::model(oil, VISC_TEMP_MIN_C), maxTable, worstC, maxFloat);
+    }
+    printf("Outside the table the end values apply, e.g. normal at -40 C: %.3f (model %.3f)\n",
+           ViscosityTable::factor(1, -40.0f), ViscosityTable::model(1, -40.0));
+
+    // One reading per call, temperatures spread over the range, all oil types
+    const int n = 3000000;
+    std::vector<float> temps(n);
+    for (int i = 0; i < n; i++) temps[i] = VISC_TEMP_MIN_C + ((uint32_t)i * 7919u % 110000u) / 1000.0f;
+    volatile float sinkTable = 0.0f, sinkFloat = 0.0f;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) sinkTable = sinkTable + ViscosityTable::factor((uint8_t)(i % 3), temps[i]);
+    auto t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) sinkFloat = sinkFloat + viscosityFloatFormula((uint8_t)(i % 3), temps[i]);
+    auto t2 = std::chrono::steady_clock::now();
+    printf("\nHost time per reading: table %.1f ns, float exp()/pow() %.1f ns (sums %.1f / %.1f)\n",
+           std::chrono::duration<double, std::nano>(t1 - t0).count() / n,
+           std::chrono::duration<double, std::nano>(t2 - t1).count() / n, (double)sinkTable, (double)sinkFloat);
+    return 0;
+}
+
+static int pulseCheck() {
+    Serial.muted = true;
+    hostSetTemperature(DEVICE_DISCONNECTED_C);
+
+    PulseResult soft, hard;
+    pulseRun(false, soft);
+    pulseRun(true, hard);
+
+    printf("%d oilings x %d pulses of %d ms, main loop stalls of %d-%d ms every %.0f s on average\n\n",
+           PULSE_OILINGS, PULSE_PER_OILING, PULSE_DURATION_MS, PULSE_STALL_MIN_MS, PULSE_STALL_MAX_MS,
+           PULSE_STALL_GAP_MS / 1000.0);
+    printf("%-16s %6s %8s %8s %8s %9s %9s\n", "pulse width", "pulses", "mean ms", "p50 ms", "p99 ms", "max ms", ">+1 ms");
+    pulsePrint("timed by loop()", soft);
+    pulsePrint("hardware train", hard);
+    printf("\nHardware trains: %lu, end seen by the firmware after mean %.1f ms, max %.1f ms\n",
+           (unsigned long)hard.trains, hard.meanLatencyUs / 1000.0, hard.maxLatencyUs / 1000.0);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc == 2 && !strcmp(argv[1], "--distance")) return distanceCheck();
+    if (argc >= 2 && argc <= 3 && !strcmp(argv[1], "--speed")) return speedCheck(argc == 3 ? argv[2] : nullptr);
+    if (argc == 3 && !strcmp(argv[1], "--odometer")) return odometerCheck(atof(argv[2]));
+    if (argc == 2 && !strcmp(argv[1], "--pulse")) return pulseCheck();
+    if (argc == 2 && !strcmp(argv[1], "--viscosity")) return viscosityCheck();
+
+    Options opt;
+    std::vector<const char*> paths;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) opt.repeat = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-i") && i + 1 < argc) opt.idleStepMs = strtoul(argv[++i], nullptr, 10);
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc) {
+            for (char* c = strtok(argv[++i], ","); c && opt.tempC.size() < HOST_ONEWIRE_SENSORS; c = strtok(nullptr, ","))
+                opt.tempC.push_back(atof(c));
+        }
+        else if (!strcmp(argv[i], "-q")) opt.quiet = true;
+        else if (!strcmp(argv[i], "-v")) opt.verbose = true;
+        else if (!strcmp(argv[i], "-s")) opt.softPulses = true;
+        else if (!strcmp(argv[i], "-r") && i + 1 < argc) opt.recorderCsv = argv[++i];
+        else if (argv[i][0] == '-') {
+            fprintf(stderr, "Usage: %s [-n repeat] [-i idle_step_ms] [-t temp_c[,...]] [-s] [-r csv] [-q] [-v] trace...\n", argv[0]);
+            return 2;
+        } else paths.push_back(argv[i]);
+    }
+    if (paths.empty() || opt.repeat < 1) {
+        fprintf(stderr, "Usage: %s [-n repeat] [-i idle_step_ms] [-t temp_c[,...]] [-s] [-r csv] [-q] [-v] trace...\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<std::vector<Sample>> traces;
+    for (const char* path : paths) {
+        std::vector<Sample> trace;
+        if (!loadTrace(path, trace)) return 1;
+        traces.push_back(trace);
+    }
+
+    Serial.muted = !opt.verbose;
+    for (size_t i = 0; i < opt.tempC.size(); i++) hostSetTemperature(opt.tempC[i], (uint8_t)i);
+    FlashCostModel cost;
+    RamPersistence store(cost);
+
+    if (!opt.quiet) printf("event,t_s,odo_km,gps_kmh,smoothed_kmh,interval_km,tank_ml,modes\n");
+    auto wall0 = std::chrono::steady_clock::now();
+    int rides = 0;
+    for (int r = 0; r < opt.repeat; r++) {
+        for (const auto& trace : traces) {
+            ride(&store, trace, opt);
+            rides++;
+        }
+    }
+    double wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall0).count();
+    double km = odometerKm;
+
+    printf("\n%d rides, %.1f km, %.1f h simulated in %.2f s (%.0fx real time), %u oilings (%.2f per 100 km)\n",
+           rides, km, simSeconds / 3600.0, wallS, wallS > 0 ? simSeconds / wallS : 0.0,
+           oilings, km > 0 ? oilings * 100.0 / km : 0.0);
+    updateTiming.print("update()");
+    loopTiming.print("loop()");
+    if (simSeconds > 0) {
+        printf("loop() %.1f wakeups/s, host CPU busy %.4f%% of simulated time\n", loopTiming.calls / simSeconds,
+               (loopTiming.totalNs + updateTiming.totalNs) * 1e-7 / simSeconds);
+    }
+    printf("LED %lu frames shown, %lu skipped (unchanged, %.1f%%)\n", (unsigned long)ledShown,
+           (unsigned long)ledSkipped, ledShown + ledSkipped ? ledSkipped * 100.0 / (ledShown + ledSkipped) : 0.0);
+    if (pumpTrains > 0) {
+        printf("Pump %lu hardware trains, end seen after mean %.1f ms, max %.1f ms\n", (unsigned long)pumpTrains,
+               pumpLatencySumUs / 1000.0 / pumpTrains, pumpMaxLatencyUs / 1000.0);
+    }
+    printf("Recorder %lu oilings stored (capacity %lu), %lu appends, %lu page erases\n",
+           (unsigned long)recorder.count(), (unsigned long)recorder.getCapacity(),
+           (unsigned long)recorder.getAppendCount(), (unsigned long)recorder.getEraseCount());
+    if (opt.recorderCsv && !writeRecorderCsv(opt.recorderCsv)) return 1;
+    printf("Temp %lu readings, %lu errors, longest bus step %lu us; longest loop() %lu us (simulated clock)\n",
+           (unsigned long)tempReadings, (unsigned long)tempErrors, (unsigned long)tempMaxStepUs,
+           (unsigned long)loopStallMaxUs);
+    return 0;
+}
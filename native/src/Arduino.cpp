@@ -0,0 +1,74 @@
+#include <Arduino.h>
+#include <Wire.h>
+
+HardwareSerial Serial;
+TwoWire Wire;
+
+static unsigned long long clockUs = 1000;
+
+#define HOST_PIN_COUNT 64
+static int pinLevels[HOST_PIN_COUNT];
+static int pinInputs[HOST_PIN_COUNT];
+static bool pinInputsSet[HOST_PIN_COUNT];
+
+std::string String::format(double v, unsigned char decimals) {
+    char buf[48];
+    snprintf(buf, sizeof(buf), "%.*f", decimals, v);
+    return buf;
+}
+
+void String::trim() {
+    size_t start = _s.find_first_not_of(" \t\r\n");
+    size_t end = _s.find_last_not_of(" \t\r\n");
+    _s = (start == std::string::npos) ? std::string() : _s.substr(start, end - start + 1);
+}
+
+size_t Print::write(const uint8_t* buf, size_t len) {
+    size_t n = 0;
+    while (len--) n += write(*buf++);
+    return n;
+}
+
+size_t Print::printf(const char* format, ...) {
+    char buf[512];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    if (len < 0) return 0;
+    if ((size_t)len >= sizeof(buf)) len = sizeof(buf) - 1;
+    return write((const uint8_t*)buf, len);
+}
+
+unsigned long millis() { return (unsigned long)(clockUs / 1000); }
+unsigned long micros() { return (unsigned long)clockUs; }
+void delay(unsigned long ms) { clockUs += (unsigned long long)ms * 1000; }
+void delayMicroseconds(unsigned int us) { clockUs += us; }
+void yield() {}
+void hostClockAdvance(unsigned long ms) { clockUs += (unsigned long long)ms * 1000; }
+
+static void recordPin(uint8_t pin, int value) {
+    if (pin < HOST_PIN_COUNT) pinLevels[pin] = value;
+}
+
+void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t pin, uint8_t value) { recordPin(pin, value); }
+int digitalRead(uint8_t pin) { return (pin < HOST_PIN_COUNT && pinInputsSet[pin]) ? pinInputs[pin] : HIGH; }
+int analogRead(uint8_t) { return 0; }
+void analogWrite(uint8_t pin, int value) { recordPin(pin, value); }
+void ledcAttach(uint8_t, uint32_t, uint8_t) {}
+void ledcWrite(uint8_t pin, uint32_t duty) { recordPin(pin, (int)duty); }
+
+int hostPinLevel(uint8_t pin) { return pin < HOST_PIN_COUNT ? pinLevels[pin] : 0; }
+void hostSetInput(uint8_t pin, int level) {
+    if (pin >= HOST_PIN_COUNT) return;
+    pinInputs[pin] = level;
+    pinInputsSet[pin] = true;
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax) {
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+long random(long max) { return max > 0 ? rand() % max : 0; }
+long random(long min, long max) { return max > min ? min + rand() % (max - min) : min; }
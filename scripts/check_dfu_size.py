@@ -0,0 +1,29 @@
+# PlatformIO post-build check: the firmware image must fit below the raw flash stores
+# when the bootloader stages it for a DFU update (see Flash Layout in include/config.h).
+import os
+import re
+
+Import("env")
+
+
+def config_value(text, name):
+    m = re.search(r"#define\s+%s\s+(0x[0-9A-Fa-f]+|\d+)" % name, text)
+    return int(m.group(1), 0)
+
+
+def check_dfu_size(source, target, env):
+    with open(os.path.join(env.subst("$PROJECT_DIR"), "include", "config.h")) as f:
+        config = f.read()
+    limit = config_value(config, "FLIGHT_RECORDER_ADDR") - config_value(config, "DFU_BANK1_ADDR")
+
+    # Image in flash: code plus initialized data (Berkeley format: text data bss)
+    out = env.subst("$SIZETOOL") + " -B " + str(target[0])
+    text, data = [int(v) for v in os.popen(out).read().splitlines()[1].split()[:2]]
+    size = text + data
+    print("DFU: Image %d bytes, %d bytes left below the raw flash stores" % (size, limit - size))
+    if size > limit:
+        print("DFU: Image exceeds DFU_MAX_IMAGE_SIZE (%d bytes), an update would erase the flight recorder" % limit)
+        env.Exit(1)
+
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", check_dfu_size)
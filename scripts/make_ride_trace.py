@@ -0,0 +1,42 @@
+# Sample trace for the ride replay (env:native_sim): 40 segments of constant speed
+# (0/30/60/90/120 km/h, 30-200 s each) at 1 Hz heading north from 47.0 N 8.5 E.
+# Fixed seed, so every run writes the same ride; the figures in the commit log
+# (49 oilings / 224.8 km over 3 rides) are from
+#   python3 scripts/make_ride_trace.py /tmp/sim
+#   .pio/build/native_sim/program -q -n 3 /tmp/sim/ride.csv
+# The NMEA file is the same ride as $GPRMC sentences for the TinyGPSPlus path.
+import os
+import random
+import sys
+
+
+def main(out_dir):
+    random.seed(1)
+    lat, lon = 47.0, 8.5
+    t = 0
+    with open(os.path.join(out_dir, "ride.csv"), "w") as f, \
+            open(os.path.join(out_dir, "ride.nmea"), "w") as g:
+        f.write("t_s,lat,lon,speed_kmh\n")
+        for seg in range(40):
+            sp = random.choice([0, 30, 60, 90, 120])
+            dur = random.randint(30, 200)
+            for i in range(dur):
+                t += 1
+                lat += sp / 3600 / 111.195
+                f.write("%d,%.7f,%.7f,%d\n" % (t, lat, lon, sp))
+                hh = (t // 3600 + 10) % 24
+                mm = (t // 60) % 60
+                ss = t % 60
+                la = int(lat) * 100 + (lat - int(lat)) * 60
+                lo = int(lon) * 100 + (lon - int(lon)) * 60
+                body = "GPRMC,%02d%02d%02d.00,A,%.5f,N,%.5f,E,%.2f,0.0,010125,,,A" % (
+                    hh, mm, ss, la, lo, sp / 1.852)
+                cs = 0
+                for ch in body:
+                    cs ^= ord(ch)
+                g.write("$%s*%02X\r\n" % (body, cs))
+    print("Trace: %d s written to %s" % (t, out_dir))
+
+
+if __name__ == "__main__":
+    main(sys.argv[1] if len(sys.argv) > 1 else ".")
@@ -5,7 +5,15 @@
 #include <TinyGPS++.h>
 #include <Adafruit_BNO08x.h>
 #include "config.h" // Include the new config file
+#include "NrfFlash.h"
+#include "NrfPulseGenerator.h"
+#include "NrfPwmPulseGenerator.h"
+#include "LogPersistence.h"
 #include "NrfPersistence.h"
+#include "ProgressJournal.h"
+#include "FlightRecorder.h"
+#include "CycleCounter.h"
+#include "GeoDistance.h"
 #include "LoraWanHandler.h"
 #include "Oiler.h"
 #include "ImuHandler.h"
@@ -14,8 +22,17 @@
 SX1262 radio = new Module(LORA_NSS, LORA_DIO1, LORA_NRST, LORA_BUSY);
 LoraWanHandler lora(&radio);
 TinyGPSPlus gps;
-NrfPersistence persistence;
-Oiler oiler(&persistence, PUMP_PIN, LED_PIN, -1); // No Temp Sensor for now
+NrfFlash kvFlash(KV_LOG_FLASH_ADDR, KV_LOG_PAGES);
+LogPersistence persistence(&kvFlash);
+NrfFlash journalFlash(PROGRESS_JOURNAL_ADDR, PROGRESS_JOURNAL_PAGES);
+ProgressJournal progressJournal(&journalFlash);
+NrfFlash configFlash(CONFIG_FLASH_ADDR, CONFIG_FLASH_PAGES);
+NrfFlash recorderFlash(FLIGHT_RECORDER_ADDR, FLIGHT_RECORDER_PAGES);
+FlightRecorder flightRecorder(&recorderFlash);
+NrfPulseGenerator pumpPulses;       // Pulse trains timed by TIMER3/4 + PPI
+NrfPwmPulseGenerator pumpPwmPulses; // Same with soft-start ramps, played by PWM3 + EasyDMA
+Oiler oiler(&persistence, PUMP_PIN, LED_PIN, -1,
+            PUMP_USE_PWM ? (IPulseGenerator*)&pumpPwmPulses : &pumpPulses); // No Temp Sensor for now
 // ImuHandler imuHandler; // TODO: Integrate ImuHandler properly
 
 // --- Callbacks ---
@@ -25,11 +42,94 @@ void onHomeConfig(double lat, double lon) {
     homeLon = lon;
     
     persistence.begin("hello", false);
+    persistence.beginTransaction();
     persistence.putDouble("home_lat", homeLat);
     persistence.putDouble("home_lon", homeLon);
+    persistence.commit();
     persistence.end();
 }
 
+// --- Storage ---
+// One-time import of the old file-per-key InternalFS store into the flash log.
+// Done once the marker written after the last key exists: an import cut short by a
+// power loss runs again on the next boot (values already imported are skipped).
+void migrateLegacyStore() {
+    persistence.begin("storage", false);
+    bool done = persistence.getBool("migrated", false);
+    persistence.end();
+    if (done) return;
+
+    const char* namespaces[] = { "hello", "oiler", "imu", "aux" };
+    NrfPersistence* legacy = new NrfPersistence; // 1.5 KB transaction buffer: heap, freed below
+    if (!legacy) return;
+
+    for (const char* ns : namespaces) {
+        legacy->begin(ns, true);
+        persistence.begin(ns, false);
+        size_t count = legacy->exportTo(&persistence);
+        persistence.end();
+        legacy->end();
+        Serial.printf("Storage: Migrated %u keys from /%s\n", (unsigned)count, ns);
+    }
+    delete legacy;
+
+    persistence.begin("storage", false);
+    persistence.putBool("migrated", true);
+    persistence.end();
+}
+
+// Flash wear since boot: serial report + compact diagnostic uplink (end of ride)
+void reportFlashWear(bool uplink) {
+    const WearStats* wear = persistence.getWearStats();
+    wear->printReport(Serial);
+    Serial.printf("  Max. save stall: %.1f ms\n", oiler.getMaxSaveStallUs() / 1000.0f);
+    if (uplink) {
+        const WearCounter& total = wear->getTotal();
+        float years = wear->getLifetimeYears();
+        lora.sendWearStats(total.writes, total.payloadBytes, total.physicalBytes,
+                           (uint16_t)wear->getEraseEstimate(), (uint16_t)(years > 65535.0f ? 65535.0f : years));
+    }
+}
+
+// CPU time of the per-fix path ('p' on the serial console)
+CycleStats updateCycles;
+CycleStats loopCycles;
+SleepStats driveSleep; // Drive mode sleep between loop passes
+
+void reportProfile() {
+    Serial.println("CPU profile since boot:");
+    updateCycles.print(Serial, "update()");
+    loopCycles.print(Serial, "loop()");
+    driveSleep.print(Serial, "drive");
+    Serial.printf("  LED frames %lu shown, %lu skipped (unchanged)\n", (unsigned long)oiler.getLedFramesRendered(),
+                  (unsigned long)oiler.getLedFramesSkipped());
+    const PulseTrain& pump = oiler.getPumpTrain();
+    Serial.printf("  Pump trains %lu, end seen after mean %lu us, max %lu us\n", (unsigned long)pump.getTrains(),
+                  (unsigned long)pump.getMeanLatencyUs(), (unsigned long)pump.getMaxLatencyUs());
+    const TempSensors& temp = oiler.getTempSensors();
+    Serial.printf("  Temp %u sensors, %lu readings, %lu errors, longest bus step %lu us\n", temp.getCount(),
+                  (unsigned long)temp.getReadings(), (unsigned long)temp.getErrors(), (unsigned long)temp.getMaxStepUs());
+    persistence.printCacheStats(Serial);
+}
+
+// Flight recorder as CSV for offline analysis ('r' on the serial console)
+void dumpFlightRecorder() {
+    Serial.printf("# %lu oilings (capacity %lu)\n", (unsigned long)flightRecorder.count(),
+                  (unsigned long)flightRecorder.getCapacity());
+    Serial.println("time,lat,lon,speed_kmh,lean_deg,temp_c,pulse_ms,pause_ms,pulses,flags,tank_ml");
+    FlightRecorder::Entry chunk[16];
+    uint32_t index = 0;
+    size_t n;
+    while ((n = flightRecorder.read(index, chunk, 16)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            const FlightRecorder::Entry& e = chunk[i];
+            Serial.printf("%lu,%.5f,%.5f,%.1f,%.0f,%.0f,%u,%u,%u,%u,%.1f\n", (unsigned long)e.time, e.lat, e.lon,
+                          e.speedKmh, e.leanDeg, e.tempC, e.pulseMs, e.pauseMs, e.pulses, e.flags, e.tankMl);
+        }
+        index += n;
+    }
+}
+
 // --- State Machine ---
 enum SystemState {
     STATE_BOOT,
@@ -43,6 +143,7 @@ SystemState currentState = STATE_BOOT;
 unsigned long stateStartTime = 0;
 unsigned long cooldownEndTime = 0;
 unsigned long lastHeartbeat = 0;
+GeoDistance homeDistance; // Reference latitude = home, so cos(lat) is computed once
 bool homeArrivalSent = false;
 bool sessionStatsSent = false;
 
@@ -62,6 +163,7 @@ void setup() {
     Serial.begin(115200);
     delay(2000); // Safety delay
     Serial.println("HelLo Juicer - Booting...");
+    cycleCounterBegin();
 
     // Check Reset Reason (Wake from System OFF?)
     uint32_t resetReason = NRF_POWER->RESETREAS;
@@ -78,6 +180,10 @@ void setup() {
     pinMode(BATTERY_PIN, INPUT);
 
     // 2. Init Components
+    if (persistence.mount()) {
+        migrateLegacyStore();
+    }
+
     persistence.begin("hello", false);
     homeLat = persistence.getDouble("home_lat", 0.0);
     homeLon = persistence.getDouble("home_lon", 0.0);
@@ -96,6 +202,13 @@ void setup() {
     lora.join(); // Blocking join for now
 
     // Oiler
+    configStore.setFlash(&configFlash); // Before the first configStore.load()
+    if (progressJournal.begin()) {
+        oiler.setProgressJournal(&progressJournal);
+    }
+    if (flightRecorder.begin()) {
+        oiler.setFlightRecorder(&flightRecorder);
+    }
     oiler.begin(IMU_SDA, IMU_SCL);
 
     // GPS
@@ -138,6 +251,8 @@ void loop() {
             // 1. Check Ignition
             if (!isIgnitionOn()) {
                 Serial.println("Ignition OFF -> Entering Cooldown Mode");
+                oiler.flushPendingSaves(true); // Nothing left in RAM when power goes
+                reportFlashWear(true);
                 currentState = STATE_COOLDOWN;
                 stateStartTime = now;
                 lastHeartbeat = 0; // Force immediate heartbeat
@@ -152,19 +267,25 @@ void loop() {
             
             // 3. Oiler Logic
             if (gps.location.isUpdated() || gps.speed.isUpdated()) {
+                uint32_t c0 = cycleCount();
                 oiler.update(gps.speed.kmph(), gps.location.lat(), gps.location.lng(), true);
+                updateCycles.add(cycleCount() - c0);
+                if (gps.time.isUpdated() && gps.date.isValid() && gps.time.isValid() && gps.date.year() >= 2020) {
+                    flightRecorder.setTime(FlightRecorder::unixTime(gps.date.year(), gps.date.month(), gps.date.day(),
+                                                                    gps.time.hour(), gps.time.minute(), gps.time.second()));
+                }
                 
                 // Garage Opener & AI Stats Logic
                 if (gps.location.isValid() && homeLat != 0.0 && homeLon != 0.0) {
-                    double distToHome = TinyGPSPlus::distanceBetween(
-                        gps.location.lat(), gps.location.lng(),
-                        homeLat, homeLon
+                    float distToHome = homeDistance.metres(
+                        homeLat, homeLon,
+                        gps.location.lat(), gps.location.lng()
                     );
                     
                     // 1. Pre-Arrival: Send AI Stats (e.g. 500m before)
                     if (distToHome < HOME_PRE_ARRIVAL_RADIUS_M && !sessionStatsSent) {
                         Serial.println("Approaching Home! Sending Session Stats for AI...");
-                        lora.sendSessionStats(oiler.getSessionStats(), NUM_RANGES);
+                        lora.sendSessionStats(oiler.getSessionStats());
                         sessionStatsSent = true;
                     }
 
@@ -182,13 +303,37 @@ void loop() {
                     }
                 }
             }
-            oiler.loop();
+            {
+                uint32_t c0 = cycleCount(); // Own scope: no initialization across case labels
+                oiler.loop();
+                loopCycles.add(cycleCount() - c0);
+            }
+
+            // Serial console: 'w' prints the flash wear report, 'p' the CPU profile, 'r' the flight recorder
+            if (Serial.available()) {
+                int cmd = Serial.read();
+                if (cmd == 'w') reportFlashWear(false);
+                else if (cmd == 'p') reportProfile();
+                else if (cmd == 'r') dumpFlightRecorder();
+            }
 
             // 4. Periodic Status Update (e.g. every 5 mins)
             if (now - lastHeartbeat > (5 * 60 * 1000)) {
                 lora.sendStatus(readBatteryVoltage(), oiler.currentTankLevelMl, oiler.getTotalDistance());
                 lastHeartbeat = now;
             }
+
+            // 5. Sleep until the next Oiler deadline (at most INPUT_POLL_MS). delay() blocks
+            //    this task; FreeRTOS tickless idle then waits in WFE. Serial1 RX is
+            //    interrupt-driven and keeps buffering GPS data meanwhile.
+            if (!Serial1.available()) {
+                uint32_t idleMs = oiler.msUntilNextDue();
+                if (idleMs > 0) {
+                    uint32_t s0 = millis();
+                    delay(idleMs);
+                    driveSleep.add(millis() - s0);
+                }
+            }
             break;
 
         // ---------------------------------------------------------